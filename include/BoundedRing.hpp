@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace rtt::robothub {
+
+/*  A bounded lock-free queue that any amount of threads can push to at once, and that a single thread pops from.
+    Every slot has a sequence number that tells whether it is free for the producer of a position, or filled for the
+    consumer, so producers only contend on claiming a position. A push to a full ring fails instead of waiting, so
+    producers on latency critical threads never block on a consumer that fell behind. Entries are filled and read in
+    place, so they are copied only once each way. */
+template <typename Entry>
+class BoundedRing {
+   public:
+    // The capacity is rounded up to a power of two
+    explicit BoundedRing(std::size_t capacity) {
+        std::size_t slotCapacity = std::bit_ceil(std::max<std::size_t>(2, capacity));
+        this->slots = std::make_unique<Slot[]>(slotCapacity);
+        this->slotMask = slotCapacity - 1;
+        for (std::size_t i = 0; i < slotCapacity; ++i) {
+            this->slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        this->enqueuePosition = 0;
+        this->dequeuePosition = 0;
+    }
+
+    // Claims a free slot and calls fill with its entry. Returns false without calling fill if the ring is full
+    template <typename Fill>
+    bool tryPush(Fill&& fill) {
+        // A slot is free when its sequence equals the position that claims it
+        Slot* slot;
+        uint64_t position = this->enqueuePosition.load(std::memory_order_relaxed);
+        while (true) {
+            slot = &this->slots[position & this->slotMask];
+            uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<int64_t>(sequence - position);
+
+            if (difference == 0) {
+                if (this->enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            } else if (difference < 0) {
+                // The consumer did not free this slot yet, so the ring is full
+                return false;
+            } else {
+                position = this->enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        fill(slot->entry);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Calls consume with the oldest filled entry, and frees its slot afterwards. Returns false if no entry is filled.
+    // Only one thread may pop at a time
+    template <typename Consume>
+    bool tryPop(Consume&& consume) {
+        Slot& slot = this->slots[this->dequeuePosition & this->slotMask];
+        if (slot.sequence.load(std::memory_order_acquire) != this->dequeuePosition + 1) return false;  // Not filled yet
+
+        consume(static_cast<const Entry&>(slot.entry));
+
+        // Give the slot back to the producers, for when they wrapped around the ring
+        slot.sequence.store(this->dequeuePosition + this->slotMask + 1, std::memory_order_release);
+        this->dequeuePosition++;
+        return true;
+    }
+
+    [[nodiscard]] std::size_t getCapacity() const { return this->slotMask + 1; }
+
+   private:
+    typedef struct alignas(64) Slot {
+        std::atomic<uint64_t> sequence;
+        Entry entry;
+    } Slot;
+
+    std::unique_ptr<Slot[]> slots;
+    uint64_t slotMask;
+    alignas(64) std::atomic<uint64_t> enqueuePosition;
+    alignas(64) uint64_t dequeuePosition;  // Only used by the consumer
+};
+
+}  // namespace rtt::robothub
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <ThreadTuning.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+namespace rtt::robothub {
+
+/*  A reactor that runs handlers on its own thread when file descriptors become ready or timers expire. It waits
+    with epoll, and its timers are timerfds, so the thread only wakes up when there is work, instead of polling.
+    Handlers run one at a time, so they should return quickly, as a slow handler delays all others.
+    Sources can be added and removed from any thread, also from within a handler. A loop with a role tunes its thread
+    for that role, and reports how late its timers fire as the scheduler jitter of the role. */
+class EventLoop {
+   public:
+    // The name is given to the thread, so it can be recognized in tools like top. Throws a FailedToCreateEventLoopException
+    explicit EventLoop(const std::string& name, std::optional<ThreadRole> role = std::nullopt);
+    // Returns after the last handler has finished
+    ~EventLoop();
+
+    // Runs the handler whenever the file descriptor is ready for one of the given epoll events. Returns an id to remove it
+    int addFileDescriptor(int fileDescriptor, uint32_t events, const std::function<void()>& handler);
+    // Runs the handler every interval. Returns an id to remove it
+    int addTimer(std::chrono::nanoseconds interval, const std::function<void()>& handler);
+    // Runs the handler once, after the delay. Returns an id to remove it before it ran
+    int addTimeout(std::chrono::nanoseconds delay, const std::function<void()>& handler);
+    // After this returns, the handler is not running anymore. Unknown ids, like those of timeouts that ran, are ignored
+    void remove(int sourceId);
+    // Like remove, but returns right away, so the handler may still be finishing its last run on the loop thread. For
+    // callers that may hold a lock that a handler waits for, like the libusb notifiers, which would deadlock with remove
+    void removeWithoutWaiting(int sourceId);
+
+    [[nodiscard]] int getAmountOfSources() const;
+    [[nodiscard]] bool isInLoopThread() const;
+
+   private:
+    typedef struct Source {
+        int fileDescriptor;
+        bool isTimer;    // Timers own their timerfd, which is closed once the source is destroyed, and must read it to clear it
+        bool isTimeout;  // Timeouts are removed once they ran
+        std::function<void()> handler;
+        std::chrono::nanoseconds interval;                       // Of timers, to know when they expire next
+        std::chrono::steady_clock::time_point nextExpiration;  // Of timers, to measure how late they fire
+    } Source;
+
+    int epollDescriptor;
+    int wakeDescriptor;  // An eventfd that wakes the loop, so it notices it should stop
+    std::optional<ThreadRole> role;
+    std::atomic<bool> shouldRun;
+    std::thread thread;
+
+    mutable std::mutex sourcesMutex;  // Guards the sources and the nextSourceId
+    std::map<int, std::shared_ptr<Source>> sources;
+    int nextSourceId;
+    std::mutex dispatchMutex;  // Held while handlers run, so remove can wait for them
+
+    int addSource(int fileDescriptor, uint32_t events, const Source& source);
+    // Forgets the source, so it is not dispatched anymore. A dispatch that already started keeps it alive until it is done
+    void unregister(int sourceId);
+    int addTimerSource(std::chrono::nanoseconds interval, bool isTimeout, const std::function<void()>& handler);
+    void run(const std::string& name);
+    void dispatch(int sourceId);
+};
+
+class FailedToCreateEventLoopException : public std::exception {
+   public:
+    explicit FailedToCreateEventLoopException(const std::string& message);
+    [[nodiscard]] const char* what() const noexcept override;
+
+   private:
+    const std::string message;
+};
+
+}  // namespace rtt::robothub
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <SettingsNetworker.hpp>
+#include <SimulationConfigurationNetworker.hpp>
+#include <ThreadTuning.hpp>
+#include <roboteam_utils/RobotCommands.hpp>
+#include <roboteam_utils/Teams.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <span>
+#include <string>
+
+namespace rtt::robothub {
+
+/*  Layout of a capture file, all numbers little endian:
+    Header:  8 bytes magic "RTTHUBCP", uint16 format version, uint16 header size, uint32 reserved,
+             uint64 microseconds since the unix epoch at which the capture was started
+    Inputs:  uint64 microseconds since the start of the capture, uint8 input type, uint8 team,
+             uint32 payload size, followed by the payload. Settings and simulation configurations are
+             serialized protobuf messages, basestation packets are raw REM packets, and robot commands
+             are serialized by serializeRobotCommands */
+constexpr char CAPTURE_MAGIC[8] = {'R', 'T', 'T', 'H', 'U', 'B', 'C', 'P'};
+constexpr uint16_t CAPTURE_FORMAT_VERSION = 1;
+constexpr uint16_t CAPTURE_HEADER_SIZE = 24;
+constexpr std::size_t CAPTURE_INPUT_HEADER_SIZE = 14;
+
+enum class CaptureInputType : uint8_t { ROBOT_COMMANDS = 1, SETTINGS = 2, SIMULATION_CONFIGURATION = 3, BASESTATION_PACKET = 4 };
+
+typedef struct CapturedInput {
+    std::chrono::microseconds sinceStart;
+    CaptureInputType type;
+    rtt::Team team;  // Only meaningful for robot commands and basestation packets
+    std::string payload;
+} CapturedInput;
+
+/*  Captures every input of RobotHub, so a session can be replayed later. Inputs arrive on the callback
+    threads of the networkers and the basestations, so writing is guarded by a mutex. At the rates
+    RobotHub receives inputs, this costs far less than the inputs themselves. The mutex inherits priority,
+    as real-time transmit threads share it with the normal threads of the other inputs. */
+class HubCaptureWriter {
+   public:
+    explicit HubCaptureWriter(const std::string& path);
+
+    void captureRobotCommands(std::span<const rtt::RobotCommand> commands, rtt::Team color);
+    void captureSettings(const proto::Setting& settings);
+    void captureSimulationConfiguration(const proto::SimulationConfiguration& configuration);
+    void captureBasestationPacket(const uint8_t* packet, std::size_t size, rtt::Team color);
+
+   private:
+    PriorityInheritanceMutex fileMutex;
+    std::ofstream file;
+    std::chrono::time_point<std::chrono::steady_clock> start;
+
+    void writeInput(CaptureInputType type, rtt::Team team, const std::string& payload);
+};
+
+// Reads the inputs of a capture in the order they were captured
+class HubCaptureReader {
+   public:
+    explicit HubCaptureReader(const std::string& path);
+
+    // Returns false once all inputs are read
+    bool readNext(CapturedInput& input);
+
+   private:
+    std::ifstream file;
+};
+
+std::string serializeRobotCommands(std::span<const rtt::RobotCommand> commands);
+rtt::RobotCommands deserializeRobotCommands(const std::string& bytes);
+
+class FailedToOpenCaptureException : public std::exception {
+   public:
+    explicit FailedToOpenCaptureException(const std::string& message);
+    [[nodiscard]] const char* what() const noexcept override;
+
+   private:
+    const std::string message;
+};
+
+}  // namespace rtt::robothub
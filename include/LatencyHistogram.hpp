@@ -0,0 +1,51 @@
+#pragma once
+
+#include <ShardedCounters.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace rtt::robothub {
+
+// Every power of two is split into this many buckets, so a bucket is at most 1/16th of its value wide
+constexpr int LATENCY_SUB_BUCKET_BITS = 4;
+constexpr int LATENCY_SUB_BUCKETS = 1 << LATENCY_SUB_BUCKET_BITS;
+constexpr int LATENCY_MAX_MAGNITUDE = 32;  // Latencies from 2^33 ns (about 8.6 s) on end up in the last bucket
+constexpr int LATENCY_BUCKETS = (LATENCY_MAX_MAGNITUDE - LATENCY_SUB_BUCKET_BITS) * LATENCY_SUB_BUCKETS + 2 * LATENCY_SUB_BUCKETS;
+
+// Distribution of the latencies recorded in an interval, in microseconds
+typedef struct LatencySummary {
+    uint64_t samples = 0;
+    double p50Us = 0;
+    double p99Us = 0;
+    double p999Us = 0;
+    double maxUs = 0;
+} LatencySummary;
+
+/*  A log-linear histogram of latencies with a fixed amount of memory. Latencies below 16 ns have their
+    own bucket, and every power of two above that is split in 16 buckets, so a reported latency is at most
+    6.25% above the real one. The buckets are sharded counters, so every thread records into its own
+    histogram without contention, and the histograms of all threads are merged when summarizing. The maximum is
+    tracked exactly, and is only written when it grows, so it hardly adds contention. */
+class LatencyHistogram {
+   public:
+    void record(std::chrono::nanoseconds latency);
+    void record(std::chrono::time_point<std::chrono::steady_clock> start, std::chrono::time_point<std::chrono::steady_clock> end);
+
+    // Returns the distribution of the latencies since the previous call, and starts a new interval
+    LatencySummary takeSummary();
+
+    static int toBucket(uint64_t nanoseconds);
+    // The highest latency that ends up in the bucket, in nanoseconds
+    static uint64_t getBucketUpperBound(int bucket);
+
+   private:
+    ShardedCounters<LATENCY_BUCKETS> buckets;
+    std::atomic<uint64_t> maxNanoseconds = 0;  // Of this interval. The buckets only know the upper bound of the highest one
+
+    std::mutex summaryMutex;  // Guards the previous totals
+    ShardedCounters<LATENCY_BUCKETS>::Values previousTotals{};
+};
+
+}  // namespace rtt::robothub
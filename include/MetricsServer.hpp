@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace rtt::robothub {
+
+constexpr int DEFAULT_METRICS_PORT = 9464;
+
+/*  Serves the latest metrics over HTTP on localhost, in the Prometheus text exposition format, so
+    dashboards and scripts can scrape them. The metrics are formatted once per interval by whoever
+    calls setMetrics, so a scrape only copies a string. Every request gets the metrics, whatever path
+    it asks for. Requests are handled one at a time by a single thread. */
+class MetricsServer {
+   public:
+    explicit MetricsServer(int port);
+    ~MetricsServer();
+
+    void setMetrics(const std::string& metricsText);
+
+   private:
+    int listenSocket;
+
+    std::mutex metricsMutex;  // Guards the metrics text
+    std::string metrics;
+
+    std::atomic<bool> shouldServe;
+    std::thread serveThread;
+    void serve();
+    void answerRequest(int connection);
+};
+
+class FailedToStartMetricsServerException : public std::exception {
+   public:
+    explicit FailedToStartMetricsServerException(const std::string& message);
+    [[nodiscard]] const char* what() const noexcept override;
+
+   private:
+    const std::string message;
+};
+
+}  // namespace rtt::robothub
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace rtt::robothub {
+
+/*  Layout of a .rembin file, all numbers little endian:
+    Header:  8 bytes magic "RTTREMLG", uint16 format version, uint16 header size, uint32 REM version,
+             uint64 microseconds since the unix epoch at which the file was started
+    Blocks:  uint32 compressed size, uint32 uncompressed size, uint32 amount of records, uint32 crc32 of
+             the compressed bytes, followed by the zlib compressed records. Every block can be
+             decompressed on its own
+    Records: uint64 microseconds since the unix epoch, uint8 team, uint16 packet size, followed by the
+             REM packet itself
+    Index:   one entry per block, see RembinBlockSummary
+    Trailer: uint64 offset of the index, uint64 amount of index entries, 8 bytes magic "RTTREMIX"
+    The index and trailer are written when the file is closed. A file without them, for example after a
+    crash, can still be read by walking the block headers. */
+constexpr char REMBIN_MAGIC[8] = {'R', 'T', 'T', 'R', 'E', 'M', 'L', 'G'};
+constexpr char REMBIN_INDEX_MAGIC[8] = {'R', 'T', 'T', 'R', 'E', 'M', 'I', 'X'};
+constexpr uint16_t REMBIN_FORMAT_VERSION = 2;
+constexpr uint16_t REMBIN_HEADER_SIZE = 24;
+constexpr std::size_t REMBIN_BLOCK_HEADER_SIZE = 16;
+constexpr std::size_t REMBIN_RECORD_HEADER_SIZE = 11;
+constexpr std::size_t REMBIN_INDEX_ENTRY_SIZE = 48;
+constexpr std::size_t REMBIN_TRAILER_SIZE = 24;
+
+constexpr uint8_t REMBIN_TEAM_YELLOW = 0;
+constexpr uint8_t REMBIN_TEAM_BLUE = 1;
+
+/*  What a single block contains, so a reader can skip blocks without decompressing them.
+    An index entry is: uint64 offset, uint64 first timestamp, uint64 last timestamp, uint64 packet types,
+    uint32 robots, uint32 records, uint8 teams, followed by 7 reserved bytes */
+typedef struct RembinBlockSummary {
+    uint64_t offset = 0;  // Of the block header, from the start of the file
+    uint64_t firstTimestampUs = UINT64_MAX;
+    uint64_t lastTimestampUs = 0;
+    uint64_t packetTypes = 0;  // Bit per REM packet type
+    uint32_t robots = 0;       // Bit per robot id the packets were sent to or came from
+    uint32_t records = 0;
+    uint8_t teams = 0;  // Bit per REMBIN_TEAM_ value
+
+    void addRecord(uint64_t timestampUs, uint8_t team, const uint8_t* packet, std::size_t size);
+    void clear();
+} RembinBlockSummary;
+
+// Returns the type of the REM packet, if the packet is big enough to have one
+std::optional<uint8_t> getREMPacketType(const uint8_t* packet, std::size_t size);
+// Returns the robot a REM packet was sent to or came from. Packets for the basestation itself have no robot
+std::optional<int> getREMRobotId(const uint8_t* packet, std::size_t size);
+
+void appendIndexEntry(std::vector<uint8_t>& buffer, const RembinBlockSummary& summary);
+RembinBlockSummary readIndexEntry(const uint8_t* entry);
+
+// Appends the lowest bytes of the value to the buffer, least significant byte first
+inline void appendLittleEndian(std::vector<uint8_t>& buffer, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+inline uint64_t readLittleEndian(const uint8_t* data, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(data[i]) << (8 * i);
+    }
+    return value;
+}
+
+}  // namespace rtt::robothub
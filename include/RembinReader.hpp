@@ -0,0 +1,87 @@
+#pragma once
+
+#include <Rembin.hpp>
+#include <roboteam_utils/Teams.hpp>
+
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace rtt::robothub {
+
+typedef struct RembinRecord {
+    uint64_t timestampUs;
+    rtt::Team team;
+    const uint8_t* packet;  // Only valid until the next block is read
+    std::size_t size;
+} RembinRecord;
+
+// Selects records from a file. Every unset field matches everything
+typedef struct RembinQuery {
+    uint64_t fromTimestampUs = 0;
+    uint64_t toTimestampUs = UINT64_MAX;
+    std::optional<rtt::Team> team;
+    std::optional<int> robotId;
+    std::optional<uint8_t> packetType;
+} RembinQuery;
+
+/*  Reads a .rembin file with random access. The file is memory mapped, and only the blocks whose
+    summary in the index can match a query are decompressed. When a file has no index, because the
+    logger did not close it, the index is rebuilt by walking and decompressing all blocks once.
+    A reader is not thread safe, but any amount of readers can read the same file. */
+class RembinReader {
+   public:
+    explicit RembinReader(const std::string& path);
+    ~RembinReader();
+    RembinReader(const RembinReader&) = delete;
+    RembinReader& operator=(const RembinReader&) = delete;
+
+    [[nodiscard]] uint32_t getREMVersion() const;
+    [[nodiscard]] uint64_t getStartTimestampUs() const;
+    // False if the index was rebuilt from the blocks
+    [[nodiscard]] bool hasIndex() const;
+    [[nodiscard]] const std::vector<RembinBlockSummary>& getBlocks() const;
+
+    // Returns the indices of the blocks that can contain records matching the query
+    [[nodiscard]] std::vector<std::size_t> findBlocks(const RembinQuery& query) const;
+    // Returns all records in the block, which stay valid until the next block is read
+    const std::vector<RembinRecord>& readBlock(std::size_t blockIndex);
+    // Calls the callback with every matching record, in the order they are in the file
+    void forEachRecord(const RembinQuery& query, const std::function<void(const RembinRecord&)>& callback);
+
+   private:
+    std::string path;
+    const uint8_t* data;
+    std::size_t size;
+
+    uint32_t remVersion;
+    uint64_t startTimestampUs;
+    bool indexIsPresent;
+    std::vector<RembinBlockSummary> blocks;
+
+    std::vector<uint8_t> decompressedBlock;
+    std::vector<RembinRecord> records;
+
+    // Returns false if there is no valid index at the end of the file
+    bool readIndex();
+    void rebuildIndex();
+    // Returns false if the block is truncated or corrupt
+    bool decompressBlock(uint64_t offset);
+};
+
+// Returns whether the record matches the query
+bool matchesQuery(const RembinRecord& record, const RembinQuery& query);
+
+class FailedToReadRembinException : public std::exception {
+   public:
+    explicit FailedToReadRembinException(const std::string& message);
+    [[nodiscard]] const char* what() const noexcept override;
+
+   private:
+    const std::string message;
+};
+
+}  // namespace rtt::robothub
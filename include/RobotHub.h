@@ -2,14 +2,20 @@
 
 #include <libusb-1.0/libusb.h>
 
-// #include <RobotHubLogger.hpp>
+#include <HubCapture.hpp>
+#include <RobotHubLogger.hpp>
 #include <RobotCommandsNetworker.hpp>
 #include <RobotFeedbackNetworker.hpp>
 #include <RobotHubStatistics.hpp>
 #include <SettingsNetworker.hpp>
+#include <SharedCommandRing.hpp>
+#include <SharedFeedbackRing.hpp>
 #include <SimulationConfigurationNetworker.hpp>
+#include <ThreadTuning.hpp>
 #include <WorldNetworker.hpp>
 #include <basestation/BasestationManager.hpp>
+#include <basestation/RobotCommandBatch.hpp>
+#include <atomic>
 #include <exception>
 #include <functional>
 #include <memory>
@@ -17,28 +23,121 @@
 #include <roboteam_utils/RobotCommands.hpp>
 #include <roboteam_utils/RobotFeedback.hpp>
 #include <roboteam_utils/Teams.hpp>
+#include <simulation/ConfigurationCache.hpp>
+#include <simulation/SimulationErrorAggregator.hpp>
 #include <simulation/SimulatorManager.hpp>
+#include <simulation/WheelKinematics.hpp>
 #include <roboteam_utils/FileLogger.hpp>
+#include <span>
+#include <string>
+#include <vector>
 
 namespace rtt::robothub {
 
+// GrSim does not allow a bidirectional udp connection, so it uses different ports for the feedback
+constexpr int DEFAULT_GRSIM_FEEDBACK_PORT_BLUE_CONTROL = 30011;
+constexpr int DEFAULT_GRSIM_FEEDBACK_PORT_YELLOW_CONTROL = 30012;
+constexpr int DEFAULT_GRSIM_FEEDBACK_PORT_CONFIGURATION = 30013;
+
+// A simulator session is one simulated match, with its own simulator ports
+typedef struct SimulatorSessionConfiguration {
+    simulation::SimulatorNetworkConfiguration networkConfiguration;
+} SimulatorSessionConfiguration;
+
+typedef struct RobotHubConfiguration {
+    bool shouldLog = false;
+    RobotHubLoggerConfiguration loggerConfiguration;  // Used when shouldLog is set
+
+    // The first session is the default session, which is connected to the networkers. The others are only used by programs
+    // that embed RobotHub. All sessions share the statistics and the reporting of simulation errors
+    std::vector<SimulatorSessionConfiguration> simulatorSessions;
+    // Called with the feedback of every session from the simulator threads, so it is set before any of them start
+    std::function<void(int sessionId, const rtt::RobotsFeedback &)> simulatorSessionFeedbackCallback;
+    // Called with all feedback that is published, from the threads of the basestations and the default session, for
+    // programs that embed RobotHub. Part of the configuration for the same reason as the one above
+    std::function<void(const rtt::RobotsFeedback &)> feedbackCallback;
+    int simulatorIOThreads = 1;  // Threads shared by all simulator sessions to listen for feedback
+    // Configuration messages that arrive within this window of each other are sent as one command
+    std::chrono::milliseconds simulationConfigurationCoalesceWindow = std::chrono::milliseconds(20);
+    // A distinct simulation error is logged at most once per interval
+    std::chrono::milliseconds simulationErrorReportInterval = std::chrono::seconds(5);
+    // Drive simulated robots by their wheel velocities, like our real robots, instead of by their global velocity
+    bool sendWheelVelocitiesToSimulator = false;
+
+    std::string captureFile;  // When set, all inputs are captured to this file, so they can be replayed
+    bool useStandInBasestations = false;
+    // Select the basestations of both teams from startup, so the first commands after a pause are not dropped
+    bool keepBasestationsWarm = false;
+    std::string basestationChannelMapFile;  // Remembers the channels of basestations across restarts. Empty to not remember
+    // Feedback is also published in this shared memory segment, for consumers on the same machine. Empty to not do so
+    std::string sharedFeedbackName;
+    // Also take commands from shared memory rings, for an AI on the same machine. Empty to not do so
+    std::string sharedYellowCommandsName;
+    std::string sharedBlueCommandsName;
+    // Without the subscribers, inputs only come in through the submit functions, for example when replaying
+    bool listenToNetworkers = true;
+    // Without the publisher, feedback only goes to the feedback callback and the shared memory
+    bool publishFeedback = true;
+} RobotHubConfiguration;
+
 class RobotHub {
    public:
-    explicit RobotHub(bool shouldLog, bool logInMarpleFormat = false);
+    explicit RobotHub(const RobotHubConfiguration &configuration);
+    ~RobotHub();
 
     const RobotHubStatistics &getStatistics();
     void resetStatistics();
 
+    // Sessions other than the default session are not connected to the networkers, so they are used through these
+    [[nodiscard]] int getAmountOfSimulatorSessions() const;
+    void submitSimulatorCommands(int sessionId, const rtt::RobotCommands &commands, rtt::Team color);
+    void submitSimulatorConfiguration(int sessionId, const proto::SimulationConfiguration &configuration);
+
+    // For programs that embed RobotHub, such as the AI or a test harness on the robot PC, instead of messaging it.
+    // Commands are handled on the calling thread. Feedback goes to the feedbackCallback of the configuration
+    void submitCommands(rtt::Team team, std::span<const rtt::RobotCommand> commands);
+
+    // Inputs that normally come from the networkers and the basestations, used to replay captures
+    void submitRobotCommands(const rtt::RobotCommands &commands, rtt::Team color);
+    void submitSettings(const proto::Setting &settings);
+    void submitSimulationConfiguration(const proto::SimulationConfiguration &configuration);
+    void submitBasestationPacket(const uint8_t *packet, std::size_t size, rtt::Team color);
+
    private:
-    // std::optional<RobotHubLogger> logger;
+    typedef std::chrono::time_point<std::chrono::steady_clock> TimePoint;
+
+    std::unique_ptr<RobotHubLogger> logger;  // Only exists when logging
+    std::unique_ptr<HubCaptureWriter> capture;  // Only exists when capturing
+    std::unique_ptr<SharedFeedbackWriter> sharedFeedback;  // Only exists when sharing feedback
+    std::unique_ptr<SharedCommandIngress> sharedCommands;  // Only exists when taking commands from shared memory
+
+    typedef struct SimulatorSession {
+        std::unique_ptr<simulation::SimulatorManager> simulatorManager;
+        std::unique_ptr<simulation::ConfigurationCache> configurationCache;
+        int configurationFlushTask;  // Id of the task in the simulatorIOPool that sends coalesced configurations
+        std::unique_ptr<simulation::WheelKinematics> wheelKinematics;
+    } SimulatorSession;
+
+    static constexpr int DEFAULT_SIMULATOR_SESSION = 0;
+    std::shared_ptr<simulation::SimulatorIOPool> simulatorIOPool;  // Shared by the managers of all sessions
+    std::vector<SimulatorSession> simulatorSessions;
+    const std::function<void(int, const rtt::RobotsFeedback &)> simulatorSessionFeedbackCallback;
+    const std::function<void(const rtt::RobotsFeedback &)> feedbackCallback;
+    bool sendWheelVelocitiesToSimulator = false;
 
-    std::unique_ptr<simulation::SimulatorManager> simulatorManager;
     std::unique_ptr<basestation::BasestationManager> basestationManager;
 
     proto::Setting settings;
-    utils::RobotHubMode mode = utils::RobotHubMode::NEITHER;
+    std::atomic<utils::RobotHubMode> mode = utils::RobotHubMode::NEITHER;  // Set by the settings callback, read by the command callbacks
 
     RobotHubStatistics statistics;
+    RobotHubCounters counters;  // Incremented from all threads, and filled into the statistics
+    // One histogram per stage. These are big, so they live on the heap
+    std::unique_ptr<std::array<LatencyHistogram, AMOUNT_OF_LATENCY_STAGES>> latencyHistograms;
+    void recordCommandLatencies(TimePoint receivedAt, TimePoint lockedAt, TimePoint convertedAt, TimePoint writtenAt);
+
+    std::unique_ptr<simulation::SimulationErrorAggregator> simulationErrorAggregator;
+    int simulationErrorEvictionTask = -1;  // Id of the task in the simulatorIOPool that forgets errors that stopped occurring
 
     std::unique_ptr<rtt::net::RobotCommandsBlueSubscriber> robotCommandsBlueSubscriber;
     std::unique_ptr<rtt::net::RobotCommandsYellowSubscriber> robotCommandsYellowSubscriber;
@@ -46,27 +145,40 @@ class RobotHub {
     std::unique_ptr<rtt::net::RobotFeedbackPublisher> robotFeedbackPublisher;
     std::unique_ptr<rtt::net::SimulationConfigurationSubscriber> simulationConfigurationSubscriber;
 
-    bool initializeNetworkers();
+    // The publisher exists before any feedback can arrive, the subscribers are only created once everything they send to exists
+    bool initializeFeedbackPublisher();
+    bool initializeSubscribers();
+    // Creates everything that runs on its own threads, with the subscribers last
+    void startThreads(const RobotHubConfiguration &configuration);
+    // Stops and joins every thread that calls into the hub, so the members they use can be destroyed
+    void stopThreads();
 
-    void sendCommandsToSimulator(const rtt::RobotCommands &commands, rtt::Team color);
-    void sendCommandsToBasestation(const rtt::RobotCommands &commands, rtt::Team color);
+    void sendCommandsToSimulator(std::span<const rtt::RobotCommand> commands, rtt::Team color, int sessionId, TimePoint receivedAt);
+    // Copies the packets that were sent into sentPackets, if given, so they can be logged after releasing the onRobotCommandsMutex
+    void sendCommandsToBasestation(std::span<const rtt::RobotCommand> commands, rtt::Team color, TimePoint receivedAt,
+                                   std::vector<REM_RobotCommandPayload> *sentPackets);
+    basestation::RobotCommandBatch basestationCommandBatch;  // Reused for every conversion, guarded by the onRobotCommandsMutex
 
-    std::mutex onRobotCommandsMutex;  // Guards the onRobotCommands function, as this can be called from two callback threads
-    void onRobotCommands(const rtt::RobotCommands &commands, rtt::Team color);
+    // Guards the onRobotCommands function, as this can be called from several threads, tuned or not
+    PriorityInheritanceMutex onRobotCommandsMutex;
+    void onRobotCommands(std::span<const rtt::RobotCommand> commands, rtt::Team color);
 
     void onSettings(const proto::Setting &setting);
 
     void onSimulationConfiguration(const proto::SimulationConfiguration &configuration);
+    void stageSimulationConfiguration(const proto::SimulationConfiguration &configuration, int sessionId);
+    // Sends the staged configuration changes of the session if they are due. Returns whether it sent anything
+    bool flushSimulationConfiguration(int sessionId);
 
-    void handleRobotFeedbackFromSimulator(const simulation::RobotControlFeedback &feedback);
+    void handleRobotFeedbackFromSimulator(const simulation::RobotControlFeedback &feedback, int sessionId);
     void handleRobotFeedbackFromBasestation(const REM_RobotFeedback &feedback, rtt::Team team);
     bool sendRobotFeedback(const rtt::RobotsFeedback &feedback);
 
-    void handleSimulationConfigurationFeedback(const simulation::ConfigurationFeedback&);
-
-    void handleRobotStateInfo(const REM_RobotStateInfo& robotStateInfo, rtt::Team team);
+    void handleSimulationConfigurationFeedback(const simulation::ConfigurationFeedback&, simulation::ConfigurationCache& configurationCache);
 
     void handleBasestationLog(const std::string& basestationLogMessage, rtt::Team team);
+    // Called with every packet from the basestations, before it is decoded
+    void handleIncomingBasestationPacket(const uint8_t *packet, std::size_t size, rtt::Team team);
 
     void handleSimulationErrors(const std::vector<simulation::SimulationError>&);
 };
@@ -1,29 +1,99 @@
 #pragma once
 
-#include <fstream>
-#include <mutex>
+#include <BoundedRing.hpp>
+#include <Rembin.hpp>
+#include <roboteam_utils/Teams.hpp>
 
-#include <REM_BaseTypes.h>
-#include <REM_Packet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
-namespace rtt {
+namespace rtt::robothub {
 
-// This class is meant to contain all the thread-safe logging functionality of RobotHub
+constexpr std::size_t MAX_LOGGED_PACKET_SIZE = 256;  // Bigger packets, like very long basestation logs, are dropped
+
+typedef struct RobotHubLoggerConfiguration {
+    std::string directory = ".";
+    std::string filePrefix = "robothub_log";
+    // A new file is started once the current one is this big or this old
+    std::size_t maxFileBytes = 256 * 1024 * 1024;
+    std::chrono::seconds maxFileDuration = std::chrono::minutes(30);
+    std::size_t ringCapacity = 8192;  // Records that can wait for the writer. Rounded up to a power of two
+} RobotHubLoggerConfiguration;
+
+/*  Logs REM packets to .rembin files without slowing down the threads that log them. A logging thread
+    only copies its packet into a slot of a BoundedRing, which any amount of threads can do at once.
+    A single writer thread drains the ring into a block, and compresses and writes the block once it is
+    full or old enough. Every block is summarized in the index at the end of the file, see Rembin.hpp.
+    When the writer falls behind so far that the ring is full, new packets are dropped and counted,
+    instead of blocking the logging thread. */
 class RobotHubLogger {
-public:
-    // Marple format is csv format. False for "human-readable" text file
-    // Only moving is allowed
-    RobotHubLogger(std::string filename);
-    
-    void writeREM(REM_PacketPayload* packet);
-    void writeREM(REM_PacketPayload* packet, uint64_t timestamp);
-
-
-private:
-    std::string filename;
-    std::ofstream filestream;
-    
-    void write(uint8_t* byte_buffer, uint32_t size, uint64_t timestamp);
+   public:
+    explicit RobotHubLogger(const RobotHubLoggerConfiguration& configuration);
+    // Writes all packets that were logged before destruction
+    ~RobotHubLogger();
+
+    // Returns false if the packet was dropped
+    bool logREM(const uint8_t* packet, std::size_t size, rtt::Team team);
+    bool logREM(const uint8_t* packet, std::size_t size, rtt::Team team, uint64_t timestampUs);
+
+    [[nodiscard]] uint64_t getLoggedPackets() const;
+    [[nodiscard]] uint64_t getDroppedPackets() const;
+
+   private:
+    typedef struct LoggedPacket {
+        uint64_t timestampUs;
+        uint16_t size;
+        uint8_t team;
+        uint8_t packet[MAX_LOGGED_PACKET_SIZE];
+    } LoggedPacket;
+
+    const RobotHubLoggerConfiguration configuration;
+
+    BoundedRing<LoggedPacket> ring;
+
+    std::atomic<uint64_t> loggedPackets;
+    std::atomic<uint64_t> droppedPackets;
+
+    // Only used by the writer thread
+    int file;
+    int fileIndex;
+    std::size_t fileBytes;
+    std::chrono::time_point<std::chrono::steady_clock> fileStart;
+    std::vector<uint8_t> block;
+    RembinBlockSummary blockSummary;
+    std::vector<uint8_t> compressedBlock;
+    std::vector<uint8_t> index;  // Entries of the blocks in the current file
+
+    std::atomic<bool> shouldWrite;
+    std::thread writerThread;
+    void write();
+
+    // Moves all filled slots into the block. Returns whether any slot was filled
+    bool drainRing();
+    // Compresses the block and writes it to the file
+    void writeBlock();
+    void writeToFile(const uint8_t* data, std::size_t size);
+    void openNextFile();
+    // Writes the index and trailer, and closes the file
+    void closeFile();
+};
+
+// Returns microseconds since the unix epoch, which is what the records are timestamped with
+uint64_t getLogTimestampUs();
+
+class FailedToOpenLogFileException : public std::exception {
+   public:
+    explicit FailedToOpenLogFileException(const std::string& message);
+    [[nodiscard]] const char* what() const noexcept override;
+
+   private:
+    const std::string message;
 };
 
-} // namespace rtt
\ No newline at end of file
+}  // namespace rtt::robothub
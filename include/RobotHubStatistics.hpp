@@ -2,15 +2,49 @@
 
 #include <utilities.h>
 
+#include <LatencyHistogram.hpp>
+#include <ShardedCounters.hpp>
+#include <ThreadTuning.hpp>
 #include <array>
 #include <basestation/BasestationManager.hpp>
+#include <simulation/RoundTripTimer.hpp>
 #include <chrono>
+#include <mutex>
 #include <string>
 
 namespace rtt::robothub {
 
 constexpr int MAX_ROBOT_STATISTICS = 16;
 
+// The stages of which RobotHub measures how long they take
+enum class LatencyStage : int {
+    COMMAND_ENQUEUE,     // From receiving commands until they may be sent, which includes waiting for the commands of the other team
+    COMMAND_CONVERSION,  // From then until they are converted for the simulator or basestation
+    COMMAND_WRITE,       // From conversion until the commands are written to the socket or USB
+    COMMAND_TOTAL,       // From receiving commands until they are written
+    FEEDBACK_PUBLISH     // From receiving feedback until it is published
+};
+constexpr int AMOUNT_OF_LATENCY_STAGES = 5;
+
+// Counts of one team since start
+typedef struct TeamTotals {
+    uint64_t bytesSent = 0;
+    uint64_t packetsDropped = 0;
+    std::array<uint64_t, MAX_ROBOT_STATISTICS> commandsReceived{};
+    std::array<uint64_t, MAX_ROBOT_STATISTICS> feedbackReceived{};
+} TeamTotals;
+
+// Counts since start, which only grow, so monitoring systems can compute rates over any window themselves
+typedef struct RobotHubTotals {
+    TeamTotals yellow;
+    TeamTotals blue;
+    uint64_t feedbackBytesSent = 0;
+    uint64_t feedbackPacketsDropped = 0;
+    uint64_t simulationErrorsReceived = 0;
+} RobotHubTotals;
+
+/*  A snapshot of the statistics of RobotHub, that can be printed. The counting fields are filled
+    by RobotHubCounters, so they are exact for the interval that the snapshot covers. */
 class RobotHubStatistics {
    public:
     RobotHubStatistics();
@@ -27,13 +61,26 @@ class RobotHubStatistics {
     int yellowTeamPacketsDropped;
     int blueTeamPacketsDropped;
     int feedbackPacketsDropped;
-
-    void incrementCommandsReceivedCounter(int id, rtt::Team color);
-    void incrementFeedbackReceivedCounter(int id, rtt::Team color);
+    int simulationErrorsReceived;
+    std::size_t distinctSimulationErrors;  // That are still occurring, so this is not reset
+    simulation::RoundTripStatistics yellowSimulatorRoundTrip;
+    simulation::RoundTripStatistics blueSimulatorRoundTrip;
+    std::array<LatencySummary, AMOUNT_OF_LATENCY_STAGES> stageLatencies{};
+    std::array<LatencySummary, AMOUNT_OF_THREAD_ROLES> schedulerJitter{};  // How late the timers of each thread role fired
+    RobotHubTotals totals;  // Since start, so these are not reset
 
     void print() const;
+    // The statistics in the Prometheus text exposition format. Counts are exported as totals since start, and
+    // latencies as the quantiles of the interval of this snapshot
+    [[nodiscard]] std::string toPrometheusText() const;
+
+    [[nodiscard]] int getTotalCommandsReceived(rtt::Team color) const;
+    [[nodiscard]] int getTotalFeedbackReceived(rtt::Team color) const;
+    [[nodiscard]] double getSecondsSinceStart() const;
 
    private:
+    friend class RobotHubCounters;
+
     std::chrono::time_point<std::chrono::steady_clock> startTime;
 
     std::array<int, MAX_ROBOT_STATISTICS> yellowCommandsSent{};
@@ -48,10 +95,61 @@ class RobotHubStatistics {
     [[nodiscard]] std::string getAmountOfBasestations() const;
     [[nodiscard]] std::string getWantedBasestations() const;
     [[nodiscard]] std::string getSelectedBasestations() const;
+    [[nodiscard]] std::string getSimulationErrors() const;
+    [[nodiscard]] std::string getBasestationColdPathDrops() const;
+    [[nodiscard]] static std::string getSimulatorRoundTrip(const simulation::RoundTripStatistics& roundTrip, rtt::Team team);
+    [[nodiscard]] std::string getStageLatency(LatencyStage stage) const;
+    [[nodiscard]] std::string getSchedulerJitter(ThreadRole role) const;
 
     [[nodiscard]] std::string numberToSideBox(int n) const;
 
     static std::string wantedBasestationsToString(basestation::WantedBasestations wantedBasestations);
 };
 
+/*  The counters of RobotHub, which are incremented by the networker callbacks, the USB threads and the
+    simulator threads at the same time. These are sharded per thread, so incrementing them is cheap and
+    never races. An interval starts at a reset, and the counts of the interval can be filled into the
+    statistics as often as wanted. A reset starts the next interval at the moment of the previous fill,
+    so an increment that happens between a fill and a reset is counted in the next interval. */
+class RobotHubCounters {
+   public:
+    void addBytesSent(rtt::Team color, std::size_t bytes);
+    void incrementPacketsDropped(rtt::Team color);
+    void addFeedbackBytesSent(std::size_t bytes);
+    void incrementFeedbackPacketsDropped();
+    void incrementSimulationErrorsReceived();
+    void incrementCommandsReceivedCounter(int id, rtt::Team color);
+    void incrementFeedbackReceivedCounter(int id, rtt::Team color);
+
+    // Fills the counting fields of the statistics with the counts since the previous reset, and the totals since start
+    void fillStatistics(RobotHubStatistics& statistics);
+    void reset();
+
+   private:
+    enum Counter : std::size_t {
+        YELLOW_TEAM_BYTES_SENT,
+        BLUE_TEAM_BYTES_SENT,
+        FEEDBACK_BYTES_SENT,
+        YELLOW_TEAM_PACKETS_DROPPED,
+        BLUE_TEAM_PACKETS_DROPPED,
+        FEEDBACK_PACKETS_DROPPED,
+        SIMULATION_ERRORS_RECEIVED,
+        // Followed by a counter per robot for each of these
+        YELLOW_COMMANDS_SENT,
+        YELLOW_FEEDBACK_RECEIVED = YELLOW_COMMANDS_SENT + MAX_ROBOT_STATISTICS,
+        BLUE_COMMANDS_SENT = YELLOW_FEEDBACK_RECEIVED + MAX_ROBOT_STATISTICS,
+        BLUE_FEEDBACK_RECEIVED = BLUE_COMMANDS_SENT + MAX_ROBOT_STATISTICS,
+        AMOUNT_OF_COUNTERS = BLUE_FEEDBACK_RECEIVED + MAX_ROBOT_STATISTICS
+    };
+
+    ShardedCounters<AMOUNT_OF_COUNTERS> counters;
+
+    std::mutex intervalMutex;  // Guards the totals below
+    ShardedCounters<AMOUNT_OF_COUNTERS>::Values intervalStart{};
+    ShardedCounters<AMOUNT_OF_COUNTERS>::Values lastFill{};
+    bool hasFilledSinceReset = false;
+
+    void incrementRobotCounter(Counter firstRobotCounter, int id);
+};
+
 }  // namespace rtt::robothub
\ No newline at end of file
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace rtt::robothub {
+
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+constexpr int MAX_COUNTER_SHARDS = 32;  // Threads beyond this share one overflow shard
+static_assert(MAX_COUNTER_SHARDS == 32, "The claimed shards are one bit each in a 32 bit mask");
+
+/*  A shard index that a thread claims the first time it increments any counter, and gives back when it exits.
+    Threads come and go, for example the readers of basestations that are replugged, so indices are reused.
+    Otherwise they would run out, and all later threads would contend on the overflow shard. A shard keeps its
+    values when it changes hands, and releasing happens before claiming, so the next owner continues from them. */
+class CounterShardClaim {
+   public:
+    CounterShardClaim() : index(MAX_COUNTER_SHARDS) {
+        auto& claimedShards = getClaimedShards();
+        uint32_t claimed = claimedShards.load(std::memory_order_relaxed);
+        while (claimed != UINT32_MAX) {
+            int freeIndex = std::countr_one(claimed);
+            if (claimedShards.compare_exchange_weak(claimed, claimed | (1u << freeIndex), std::memory_order_acquire, std::memory_order_relaxed)) {
+                this->index = freeIndex;
+                break;
+            }
+        }
+    }
+
+    ~CounterShardClaim() {
+        if (this->index < MAX_COUNTER_SHARDS) getClaimedShards().fetch_and(~(1u << this->index), std::memory_order_release);
+    }
+
+    CounterShardClaim(const CounterShardClaim&) = delete;
+    CounterShardClaim& operator=(const CounterShardClaim&) = delete;
+
+    int index;  // MAX_COUNTER_SHARDS when all shards were claimed
+
+    // One bit per shard, set while a thread owns it
+    static std::atomic<uint32_t>& getClaimedShards() {
+        static std::atomic<uint32_t> claimedShards = 0;
+        return claimedShards;
+    }
+};
+
+inline int getCounterShardIndex() {
+    thread_local CounterShardClaim claim;
+    return claim.index;
+}
+
+/*  A set of counters that many threads can increment without contending with each other.
+    Every thread increments its own shard, and the shards are cache line aligned, so threads
+    never write to the same cache line. As a shard only has one writer, an increment is a
+    plain load and store instead of an atomic read-modify-write. Reading sums all shards.
+    The counters only ever grow, so the count over an interval is the difference between two
+    reads. This way every increment is counted in exactly one interval, without the reader
+    ever writing to a shard. */
+template <std::size_t AMOUNT_OF_COUNTERS>
+class ShardedCounters {
+   public:
+    typedef std::array<uint64_t, AMOUNT_OF_COUNTERS> Values;
+
+    void add(std::size_t counter, uint64_t amount) {
+        int shardIndex = getCounterShardIndex();
+        if (shardIndex < MAX_COUNTER_SHARDS) {
+            auto& value = this->shards[shardIndex].counters[counter];
+            value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        } else {
+            this->overflowShard.counters[counter].fetch_add(amount, std::memory_order_relaxed);
+        }
+    }
+
+    void increment(std::size_t counter) { this->add(counter, 1); }
+
+    // Returns the totals since construction
+    [[nodiscard]] Values read() const {
+        Values totals{};
+        for (const auto& shard : this->shards) {
+            for (std::size_t i = 0; i < AMOUNT_OF_COUNTERS; ++i) totals[i] += shard.counters[i].load(std::memory_order_relaxed);
+        }
+        for (std::size_t i = 0; i < AMOUNT_OF_COUNTERS; ++i) totals[i] += this->overflowShard.counters[i].load(std::memory_order_relaxed);
+        return totals;
+    }
+
+   private:
+    typedef struct alignas(CACHE_LINE_SIZE) Shard {
+        std::array<std::atomic<uint64_t>, AMOUNT_OF_COUNTERS> counters{};
+    } Shard;
+
+    std::array<Shard, MAX_COUNTER_SHARDS> shards;
+    Shard overflowShard;
+};
+
+}  // namespace rtt::robothub
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <SharedMemorySegment.hpp>
+#include <roboteam_utils/RobotCommands.hpp>
+#include <roboteam_utils/Teams.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+namespace rtt::robothub {
+
+constexpr const char* DEFAULT_SHARED_YELLOW_COMMANDS_NAME = "/robothub_commands_yellow";
+constexpr const char* DEFAULT_SHARED_BLUE_COMMANDS_NAME = "/robothub_commands_blue";
+constexpr uint32_t SHARED_COMMANDS_VERSION = 2;
+constexpr uint32_t DEFAULT_SHARED_COMMANDS_CAPACITY = 64;  // Batches, rounded up to a power of two
+// Batches that waited longer than this in the ring are dropped, as newer commands for the same robots will follow
+constexpr std::chrono::milliseconds DEFAULT_MAX_SHARED_COMMANDS_AGE(100);
+constexpr int MAX_SHARED_ROBOT_COMMANDS = 16;             // Per batch, more are not sent
+
+// The command of one robot, with a layout that is the same in every process
+typedef struct SharedRobotCommand {
+    int32_t id;
+    uint8_t useAngularVelocity;
+    uint8_t cameraAngleOfRobotIsSet;
+    uint8_t waitForBall;
+    uint8_t kickType;
+    uint8_t kickAtAngle;
+    uint8_t ignorePacket;
+    uint8_t reserved[2];
+    double velocityX;
+    double velocityY;
+    double targetAngle;
+    double targetAngularVelocity;
+    double cameraAngleOfRobot;
+    double kickSpeed;
+    double dribblerSpeed;
+} SharedRobotCommand;
+
+// The commands the AI sends at once for a team, like one message of the RobotCommandsPublisher
+typedef struct alignas(64) SharedRobotCommands {
+    uint64_t timestampNs;  // Of the steady clock, when the AI wrote the batch
+    uint32_t amountOfCommands;
+    uint32_t reserved;
+    SharedRobotCommand commands[MAX_SHARED_ROBOT_COMMANDS];
+} SharedRobotCommands;
+static_assert(std::is_trivially_copyable_v<SharedRobotCommands>);
+
+// Returns false if there were more commands than fit in a batch, in which case only the first ones are in it
+bool toSharedRobotCommands(const rtt::RobotCommands& commands, SharedRobotCommands& sharedCommands);
+// Fills the given commands, so its memory can be reused for every batch
+void fromSharedRobotCommands(const SharedRobotCommands& sharedCommands, rtt::RobotCommands& commands);
+
+// The layout of the shared memory segment: this header, followed by the batches
+typedef struct SharedCommandRingHeader {
+    char magic[8];  // Written last, so a writer never sees a half initialized ring
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t slotSize;
+    uint32_t reserved;
+    uint64_t generation;                           // Differs for every segment RobotHub creates, so writers can tell that it restarted
+    alignas(64) std::atomic<uint64_t> writeIndex;  // Only changed by the writer
+    alignas(64) std::atomic<uint64_t> readIndex;   // Only changed by the reader
+    alignas(64) std::atomic<uint32_t> wakeCounter;  // The futex word, incremented after every write
+    std::atomic<uint32_t> readerIsWaiting;          // Writers only wake the reader if it waits
+    std::atomic<uint64_t> droppedBatches;           // Batches that did not fit in the ring, or were too old when RobotHub read them
+    std::atomic<uint32_t> readerIsGone;             // Set when RobotHub stops reading, so writers look for a new ring right away
+} SharedCommandRingHeader;
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "The ring needs lock-free atomics to work across processes");
+
+/*  The side of RobotHub of a shared memory ring through which an AI on the same machine sends the commands of one team,
+    skipping the serialization and sockets of the RobotCommandsSubscriber. The ring has a single writer and a single
+    reader, so it needs no locks. A waiting reader sleeps on a futex in the segment, which the writer only wakes when
+    the reader actually waits, so a busy ring costs no system calls. When the ring is full, the writer drops its
+    batch instead of waiting for RobotHub, and RobotHub drops batches that are too old by the time it reads them, so
+    it never sends the robots commands that were overtaken long ago. Only one AI should write to a ring at a time. */
+class SharedCommandRingReader {
+   public:
+    // Replaces a segment with the same name. Throws a FailedToOpenSharedMemoryException if it cannot be created
+    explicit SharedCommandRingReader(const std::string& name, uint32_t capacity = DEFAULT_SHARED_COMMANDS_CAPACITY,
+                                     std::chrono::milliseconds maxAge = DEFAULT_MAX_SHARED_COMMANDS_AGE);
+    // Tells the writer to look for a new ring
+    ~SharedCommandRingReader();
+    SharedCommandRingReader(const SharedCommandRingReader&) = delete;
+    SharedCommandRingReader& operator=(const SharedCommandRingReader&) = delete;
+
+    // Copies the oldest unread batch that is not too old into the given batch. Returns false if there is none
+    bool readNext(SharedRobotCommands& commands);
+    // Sleeps until a batch is available or the timeout passed. Returns whether a batch is available
+    bool waitForCommands(std::chrono::milliseconds timeout);
+
+    [[nodiscard]] uint64_t getDroppedBatches() const;
+
+   private:
+    SharedMemorySegment segment;
+    SharedCommandRingHeader* header;
+    SharedRobotCommands* slots;
+    uint64_t slotMask;
+    const std::chrono::nanoseconds maxAge;
+};
+
+// The side of the AI of a ring, see SharedCommandRingReader
+class SharedCommandRingWriter {
+   public:
+    // Throws a FailedToOpenSharedMemoryException if RobotHub does not offer a ring with this name
+    explicit SharedCommandRingWriter(const std::string& name);
+
+    // Returns false if the ring is full and the commands were dropped. When RobotHub stopped reading the ring, or the
+    // ring is full, the writer first checks whether RobotHub created a new ring with the same name, and moves over to it
+    bool write(const rtt::RobotCommands& commands);
+    bool write(const SharedRobotCommands& commands);
+
+   private:
+    const std::string name;
+    SharedMemorySegment segment;
+    SharedCommandRingHeader* header;
+    SharedRobotCommands* slots;
+    uint64_t slotMask;
+    uint64_t generation;
+
+    // Returns whether the writer moved to a new ring
+    bool reopenIfReplaced();
+};
+
+// Consumes the rings of both teams, each on its own thread, and hands every batch to the callback
+class SharedCommandIngress {
+   public:
+    SharedCommandIngress(const std::string& yellowName, const std::string& blueName, const std::function<void(const rtt::RobotCommands&, rtt::Team)>& callback);
+    // Returns after the callback is called for the last time
+    ~SharedCommandIngress();
+
+    [[nodiscard]] uint64_t getDroppedBatches(rtt::Team team) const;
+
+   private:
+    SharedCommandRingReader yellowRing;
+    SharedCommandRingReader blueRing;
+    const std::function<void(const rtt::RobotCommands&, rtt::Team)> callback;
+
+    std::atomic<bool> shouldConsume;
+    std::thread yellowConsumer;
+    std::thread blueConsumer;
+    void consume(SharedCommandRingReader& ring, rtt::Team team);
+};
+
+}  // namespace rtt::robothub
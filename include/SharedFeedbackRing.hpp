@@ -0,0 +1,116 @@
+#pragma once
+
+#include <SharedMemorySegment.hpp>
+#include <roboteam_utils/RobotFeedback.hpp>
+#include <roboteam_utils/Teams.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <type_traits>
+
+namespace rtt::robothub {
+
+constexpr const char* DEFAULT_SHARED_FEEDBACK_NAME = "/robothub_feedback";
+constexpr uint32_t SHARED_FEEDBACK_VERSION = 2;
+constexpr uint32_t DEFAULT_SHARED_FEEDBACK_CAPACITY = 4096;  // Records, rounded up to a power of two
+
+// The feedback of one robot, with a layout that is the same in every process
+typedef struct SharedRobotFeedback {
+    uint64_t timestampNs;  // Of the steady clock, which is shared by all processes on the machine
+    int32_t id;
+    uint8_t team;    // 0 for yellow, 1 for blue
+    uint8_t source;  // 0 for the simulator, 1 for the basestation
+    uint8_t ballSensorSeesBall;
+    uint8_t ballSensorIsWorking;
+    uint8_t dribblerSeesBall;
+    uint8_t xSensIsCalibrated;
+    uint8_t capacitorIsCharged;
+    uint8_t reserved;
+    float ballPosition;
+    float velocityX;
+    float velocityY;
+    float angle;
+    float batteryLevel;
+    int32_t wheelLocked;
+    int32_t wheelBraking;
+    int32_t signalStrength;
+} SharedRobotFeedback;
+static_assert(std::is_trivially_copyable_v<SharedRobotFeedback>);
+
+SharedRobotFeedback toSharedRobotFeedback(const rtt::RobotFeedback& feedback, rtt::Team team, rtt::RobotFeedbackSource source, uint64_t timestampNs);
+rtt::RobotsFeedback fromSharedRobotFeedback(const SharedRobotFeedback& feedback);
+
+// The layout of the shared memory segment: this header, followed by the slots
+typedef struct SharedFeedbackRingHeader {
+    char magic[8];  // Written last, so a reader never sees a half initialized ring
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t slotSize;
+    uint32_t reserved;
+    uint64_t generation;                           // Differs for every segment the hub creates, so readers can tell that it restarted
+    alignas(64) std::atomic<uint64_t> writeIndex;  // Amount of records ever written
+} SharedFeedbackRingHeader;
+
+typedef struct alignas(64) SharedFeedbackSlot {
+    // Odd while the record is being written. Once record i is written, its slot holds 2 * i + 2
+    std::atomic<uint64_t> sequence;
+    SharedRobotFeedback record;
+} SharedFeedbackSlot;
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "The ring needs lock-free atomics to work across processes");
+
+/*  Publishes robot feedback into a named shared memory segment, for consumers on the same machine that should not
+    pay for serialization and the network stack. The segment is a broadcast ring of fixed size records. Readers never
+    write to it, so any amount of readers can follow it, and a slow reader can never block the hub. Instead, a reader
+    that falls behind more than the capacity misses the overwritten records, and notices that it did.
+    Every slot is guarded by a sequence number, like a seqlock, so a reader detects a record that was overwritten
+    while it was copying it. The hub publishes feedback from several threads, which take turns using a mutex. */
+class SharedFeedbackWriter {
+   public:
+    // Replaces a segment with the same name. Throws a FailedToOpenSharedMemoryException if it cannot be created.
+    // On destruction, the segment is removed. Readers keep their mapping, but no more feedback will arrive on it
+    explicit SharedFeedbackWriter(const std::string& name = DEFAULT_SHARED_FEEDBACK_NAME, uint32_t capacity = DEFAULT_SHARED_FEEDBACK_CAPACITY);
+
+    void publish(const rtt::RobotsFeedback& feedback);
+    void publish(const SharedRobotFeedback& feedback);
+
+   private:
+    SharedMemorySegment segment;
+    SharedFeedbackRingHeader* header;
+    SharedFeedbackSlot* slots;
+    uint64_t slotMask;
+
+    std::mutex writeMutex;  // Guards the nextIndex and the writing of slots
+    uint64_t nextIndex;
+};
+
+// Follows the ring of a SharedFeedbackWriter, starting at the feedback that is published after construction
+class SharedFeedbackReader {
+   public:
+    // Throws a FailedToOpenSharedMemoryException if there is no valid ring with this name
+    explicit SharedFeedbackReader(const std::string& name = DEFAULT_SHARED_FEEDBACK_NAME);
+
+    // Copies the next record into the given feedback. Returns false if there is no new feedback
+    bool readNext(SharedRobotFeedback& feedback);
+
+    // Records that were overwritten before this reader got to them
+    [[nodiscard]] uint64_t getMissedRecords() const;
+
+    // Whether the hub created a new ring with this name since this reader opened it, for example because it restarted.
+    // No feedback arrives on the old ring anymore, so open a new reader. Opens the segment, so do not call it for every read
+    [[nodiscard]] bool isReplaced() const;
+
+   private:
+    const std::string name;
+    SharedMemorySegment segment;
+    const SharedFeedbackRingHeader* header;
+    const SharedFeedbackSlot* slots;
+    uint64_t slotMask;
+
+    uint64_t generation;
+    uint64_t readIndex;
+    uint64_t missedRecords;
+};
+
+}  // namespace rtt::robothub
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <string>
+
+namespace rtt::robothub {
+
+/*  A named POSIX shared memory segment mapped into this process. The process that creates a segment owns it,
+    and removes its name on destruction. Other processes open it by name, and keep their mapping until they
+    destroy it, even if the owner is gone by then. */
+class SharedMemorySegment {
+   public:
+    // Creates a zeroed segment, replacing any segment with the same name. Only processes of the same user can open it. Throws a FailedToOpenSharedMemoryException on failure
+    static SharedMemorySegment create(const std::string& name, std::size_t size);
+    // Maps an existing segment, with its size. Throws a FailedToOpenSharedMemoryException on failure
+    static SharedMemorySegment open(const std::string& name, bool writable);
+
+    SharedMemorySegment(SharedMemorySegment&& other) noexcept;
+    SharedMemorySegment& operator=(SharedMemorySegment&& other) noexcept;
+    SharedMemorySegment(const SharedMemorySegment&) = delete;
+    SharedMemorySegment& operator=(const SharedMemorySegment&) = delete;
+    ~SharedMemorySegment();
+
+    [[nodiscard]] void* getData() const;
+    [[nodiscard]] std::size_t getSize() const;
+
+   private:
+    SharedMemorySegment(std::string name, void* data, std::size_t size, bool isOwner);
+
+    std::string name;
+    void* data;
+    std::size_t size;
+    bool isOwner;  // The owner removes the name of the segment
+
+    // Unmaps the segment, and removes its name if this is the owner
+    void release();
+};
+
+// A number that differs for every segment that is created, so a process can tell a segment that was created again from the one it mapped
+[[nodiscard]] uint64_t makeSharedMemoryGeneration();
+
+class FailedToOpenSharedMemoryException : public std::exception {
+   public:
+    explicit FailedToOpenSharedMemoryException(const std::string& message);
+    [[nodiscard]] const char* what() const noexcept override;
+
+   private:
+    const std::string message;
+};
+
+}  // namespace rtt::robothub
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <RobotHubStatistics.hpp>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace rtt::robothub {
+
+// The numbers of one statistics interval that are kept in the history
+typedef struct StatisticsSample {
+    double secondsSinceStart = 0;
+    double yellowTeamBytesSent = 0;
+    double blueTeamBytesSent = 0;
+    double feedbackBytesSent = 0;
+    double yellowTeamPacketsDropped = 0;
+    double blueTeamPacketsDropped = 0;
+    double feedbackPacketsDropped = 0;
+    double yellowCommandsReceived = 0;
+    double blueCommandsReceived = 0;
+    double yellowFeedbackReceived = 0;
+    double blueFeedbackReceived = 0;
+    double simulationErrorsReceived = 0;
+    double yellowSimulatorRoundTripP99Us = 0;
+    double blueSimulatorRoundTripP99Us = 0;
+    double commandLatencyP99Us = 0;
+    double commandLatencyMaxUs = 0;
+    double feedbackLatencyP99Us = 0;
+} StatisticsSample;
+
+// Points to one of the numbers of a sample, for example &StatisticsSample::yellowTeamPacketsDropped
+typedef double StatisticsSample::*StatisticsField;
+
+// Distribution of one number over the samples in a window
+typedef struct StatisticsFieldSummary {
+    int samples = 0;
+    double min = 0;
+    double max = 0;
+    double mean = 0;
+    double p50 = 0;
+    double p99 = 0;
+} StatisticsFieldSummary;
+
+/*  Keeps the statistics of the last intervals in a ring of a fixed size, so a short burst of drops can
+    still be found after the terminal view moved on. All memory is allocated at construction, and the
+    oldest sample is overwritten once the ring is full. This class is thread safe. */
+class StatisticsHistory {
+   public:
+    explicit StatisticsHistory(std::size_t capacity);
+
+    void add(const RobotHubStatistics& statistics);
+
+    // Summarizes the given number over the newest samples that span at most the window
+    [[nodiscard]] StatisticsFieldSummary summarize(StatisticsField field, std::chrono::seconds window) const;
+    [[nodiscard]] std::size_t size() const;
+
+    // Writes all samples as CSV, from old to new
+    void dump(std::ostream& output) const;
+    // Returns whether the file could be written
+    bool dumpToFile(const std::string& path) const;
+
+   private:
+    mutable std::mutex historyMutex;  // Guards all members below
+    std::vector<StatisticsSample> samples;
+    std::size_t amountOfSamples;
+    std::size_t nextIndex;  // Where the next sample is written
+
+    mutable std::vector<double> queryBuffer;  // Preallocated, so queries do not allocate either
+
+    [[nodiscard]] const StatisticsSample& getSample(std::size_t age) const;  // Age 0 is the newest sample
+};
+
+}  // namespace rtt::robothub
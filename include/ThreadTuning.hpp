@@ -0,0 +1,79 @@
+#pragma once
+
+#include <LatencyHistogram.hpp>
+#include <pthread.h>
+
+#include <array>
+#include <chrono>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace rtt::robothub {
+
+// The threads of RobotHub that are tuned together, as they do the same kind of latency critical work
+enum class ThreadRole : int {
+    USB,        // The event loop that reads the basestations
+    SIMULATOR,  // The event loops that listen to the simulators
+    TRANSMIT    // The threads that receive commands and write them to the basestations or simulators
+};
+constexpr int AMOUNT_OF_THREAD_ROLES = 3;
+
+typedef struct ThreadRoleTuning {
+    int realtimePriority = 0;  // The SCHED_FIFO priority, from 1 to 99. 0 keeps the normal scheduler
+    std::vector<int> cpus;     // The cpus the threads may run on. Empty to run on all
+} ThreadRoleTuning;
+
+typedef struct ThreadTuningConfiguration {
+    std::array<ThreadRoleTuning, AMOUNT_OF_THREAD_ROLES> roles{};
+    bool lockMemory = false;  // Keeps all memory of the process in RAM, so tuned threads never wait for a page fault
+    // Event loops of tuned roles also wake up this often, so their jitter is measured even when their own timers are slow. 0 to not do so
+    std::chrono::milliseconds jitterProbeInterval = std::chrono::milliseconds(0);
+} ThreadTuningConfiguration;
+
+/*  Reads a tuning file. Every line configures one role, and empty lines and lines starting with # are ignored:
+        usb priority=80 cpus=2,3
+        transmit priority=70 cpus=2,3
+        simulator cpus=1
+        lock-memory
+        jitter-probe-ms=1
+    Returns nothing if the file cannot be read or contains a line that is not understood. */
+std::optional<ThreadTuningConfiguration> loadThreadTuningConfiguration(const std::string& path);
+
+/*  Real-time priorities and cpu pinning for the threads of RobotHub, so other processes on the robot PC, like the AI,
+    cannot preempt them while they are handling a packet. The configuration is process wide, and applies to the threads
+    that tune themselves after it is set. Without the privileges for it (CAP_SYS_NICE, or an rtprio and memlock limit),
+    a warning is logged once and the threads keep running as before. */
+void configureThreadTuning(const ThreadTuningConfiguration& configuration);
+// Applies the tuning of the role to the calling thread. Cheap after the first call on a thread, so it can be called for every packet.
+// A thread whose role is no longer tuned gets the scheduler and cpus back that it had before it was tuned
+void tuneCurrentThread(ThreadRole role);
+[[nodiscard]] std::chrono::milliseconds getJitterProbeInterval(ThreadRole role);
+
+// How late the threads of a role woke up after their timers expired, which shows how much the scheduler delays them.
+// Only the event loop roles have timers, so nothing is recorded for the transmit threads
+void recordSchedulerJitter(ThreadRole role, std::chrono::nanoseconds lateness);
+// Returns the jitter since the previous call
+LatencySummary takeSchedulerJitter(ThreadRole role);
+
+[[nodiscard]] std::string threadRoleToString(ThreadRole role);
+
+/*  A mutex that lends the priority of a waiting thread to the thread that holds it. A real-time thread that waits for
+    a normal thread would otherwise wait for as long as other threads preempt that normal thread. Use it for locks that
+    tuned threads share with untuned ones. It can be used with std::scoped_lock like a std::mutex. */
+class PriorityInheritanceMutex {
+   public:
+    PriorityInheritanceMutex();
+    ~PriorityInheritanceMutex();
+    PriorityInheritanceMutex(const PriorityInheritanceMutex&) = delete;
+    PriorityInheritanceMutex& operator=(const PriorityInheritanceMutex&) = delete;
+
+    void lock();
+    void unlock();
+    bool try_lock();
+
+   private:
+    pthread_mutex_t mutex;
+};
+
+}  // namespace rtt::robothub
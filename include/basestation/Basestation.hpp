@@ -2,11 +2,12 @@
 
 #include <libusb-1.0/libusb.h>
 
+#include <EventLoop.hpp>
 #include <exception>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
-#include <thread>
 
 namespace rtt::robothub::basestation {
 
@@ -25,9 +26,13 @@ typedef struct BasestationIdentifier {
     [[nodiscard]] std::string toString() const;
 } BasestationIdentifier;
 
+/*  A connection with one basestation. Messages from the basestation are read by a usb transfer that is always
+    pending, instead of by a thread that blocks on reads. The transfer completes on whichever thread handles the
+    usb events of the context, normally the event loop of the BasestationManager, and then calls the callback. */
 class Basestation {
    public:
-    explicit Basestation(libusb_device* const device);
+    // Failed reads are retried after a pause on the given event loop
+    Basestation(libusb_context* const usbContext, EventLoop& eventLoop, libusb_device* const device);
     ~Basestation();
 
     // Compares the underlying device of this basestation with the given device
@@ -40,25 +45,38 @@ class Basestation {
     void setIncomingMessageCallback(const std::function<void(const BasestationMessage&, const BasestationIdentifier&)>& callback);
 
     [[nodiscard]] const BasestationIdentifier& getIdentifier() const;
+    // The serial number string of the usb device, which stays the same across replugs and restarts. Empty if unreadable
+    [[nodiscard]] const std::string& getSerialNumber() const;
 
     static bool isDeviceABasestation(libusb_device* const device);
 
    private:
+    libusb_context* const usbContext;
+    EventLoop& eventLoop;
     libusb_device* const device;             // Corresponds to the basestation itself
     libusb_device_handle* deviceHandle;      // Handle on which IO can be performed
     const BasestationIdentifier identifier;  // An identifier object that uniquely represents this basestation
+    std::string serialNumber;
 
-    bool shouldListenForIncomingMessages;
-    std::thread incomingMessageListenerThread;
-    void listenForIncomingMessages();
     std::function<void(const BasestationMessage&, const BasestationIdentifier&)> incomingMessageCallback;
 
-    // Reads a message directly from the basestation and stores it in the given message. Returns success
-    bool readBasestationMessage(BasestationMessage& message) const;
+    libusb_transfer* incomingTransfer;  // Reads into the incomingMessage
+    BasestationMessage incomingMessage;
+    std::mutex incomingTransferMutex;  // Guards the members below, so the transfer is never submitted after closing
+    bool isClosing;
+    int incomingTransferIsDone;  // Set when the transfer is not pending and will not be submitted again
+    int retryTimeout;            // Id of the pending retry in the event loop, or -1
+    // Must be called with the incomingTransferMutex held
+    void submitIncomingTransfer();
+    static void LIBUSB_CALL onIncomingTransfer(libusb_transfer* transfer);
+    void handleIncomingTransfer();
+    // Cancels the transfer, and handles usb events until it is done
+    void stopReading();
     // Writes the given message directly to the basestation. Returns bytes sent
     int writeBasestationMessage(BasestationMessage& message) const;
 
     static BasestationIdentifier getIdentifierOfDevice(libusb_device* const device);
+    static std::string readSerialNumber(libusb_device* const device, libusb_device_handle* const deviceHandle);
 };
 
 class FailedToOpenDeviceException : public std::exception {
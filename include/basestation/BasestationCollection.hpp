@@ -4,11 +4,17 @@
 
 #include <roboteam_utils/Teams.hpp>
 
+#include <ThreadTuning.hpp>
 #include <basestation/Basestation.hpp>
+#include <atomic>
+#include <condition_variable>
 #include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <span>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -25,14 +31,26 @@ typedef struct BasestationCollectionStatus {
     bool hasYellowBasestation;
     bool hasBlueBasestation;
     int amountOfBasestations;
+    // Messages dropped since startup because the basestation of the team was not selected (yet)
+    int yellowColdPathDrops;
+    int blueColdPathDrops;
 } BasestationCollectionStatus;
 
+typedef struct BasestationCollectionConfiguration {
+    // Keeps the basestations of both teams selected from startup, instead of only while commands for them arrive
+    bool keepBasestationsWarm = false;
+    // File in which the channel of every basestation is remembered by its usb serial number, so that after a restart it
+    // can be selected before it confirms its channel. It is unselected if it replies with another channel. Empty to not remember channels
+    std::string channelMapFile;
+} BasestationCollectionConfiguration;
+
 /* This class will take any collection of basestations, and will pick two basestations that
    can send messages to the blue and the yellow robots. It does this by asking the basestations
    what channel they currently use, and if necessary, request them to change it. */
 class BasestationCollection {
    public:
-    BasestationCollection();
+    // Basestations read their messages through the usb events of the context, and retry failed reads on the event loop
+    BasestationCollection(libusb_context* usbContext, EventLoop& eventLoop, const BasestationCollectionConfiguration& configuration = BasestationCollectionConfiguration());
     ~BasestationCollection();
 
     // This function makes sure the collection is up-to-date. Call this function frequently
@@ -43,17 +61,23 @@ class BasestationCollection {
 
     // Set a callback function to receive all messages from the two basestations of the teams
     void setIncomingMessageCallback(std::function<void(const BasestationMessage&, rtt::Team)> callback);
+    // Set a callback function to receive the text of the logs of all basestations. The team is only set for selected basestations
+    void setIncomingLogCallback(std::function<void(const BasestationIdentifier&, std::optional<rtt::Team>, std::span<const uint8_t>)> callback);
 
     // Returns the current status of the collection
     BasestationCollectionStatus getStatus() const;
 
    private:
+    libusb_context* const usbContext;
+    EventLoop& eventLoop;
+
     // Collection and selection of basestations
     mutable std::mutex basestationsMutex;                    // Guards the basestations vector
     std::vector<std::shared_ptr<Basestation>> basestations;  // All basestations
     std::vector<std::shared_ptr<Basestation>> getAllBasestations() const;
 
-    mutable std::mutex basestationSelectionMutex;    // Guards both selected basestations
+    // Guards both selected basestations. Shared by the transmit threads and the selection thread, so it inherits priority
+    mutable PriorityInheritanceMutex basestationSelectionMutex;
     std::shared_ptr<Basestation> yellowBasestation;  // Basestation selected for yellow team
     std::shared_ptr<Basestation> blueBasestation;    // Basestation selected for blue team
 
@@ -68,9 +92,18 @@ class BasestationCollection {
     void setChannelOfBasestation(const BasestationIdentifier& basestationId, WirelessChannel newChannel);
     void removeBasestationIdToChannelEntry(const BasestationIdentifier& basestationId);
 
-    // Keeps track of which basestations are actually used
-    std::chrono::time_point<std::chrono::steady_clock> lastRequestForYellowBasestation;
-    std::chrono::time_point<std::chrono::steady_clock> lastRequestForBlueBasestation;
+    // Channels of basestations by their serial number, as remembered in the channel map file
+    const std::string channelMapFile;
+    std::map<std::string, WirelessChannel> serialNumberToChannel;
+    std::mutex serialNumberToChannelMutex;  // Guards the serialNumberToChannel map and the channel map file
+    void loadChannelMap();
+    void rememberChannelOfBasestation(const BasestationIdentifier& basestationId, WirelessChannel channel);
+    WirelessChannel getRememberedChannel(const std::string& serialNumber);
+
+    // Keeps track of which basestations are actually used. Written by the command threads, read by the selection thread
+    std::atomic<std::chrono::time_point<std::chrono::steady_clock>> lastRequestForYellowBasestation;
+    std::atomic<std::chrono::time_point<std::chrono::steady_clock>> lastRequestForBlueBasestation;
+    const bool keepBasestationsWarm;  // If set, both basestations are always wanted
     // This will update the lastRequestFor variables to the current time
     void updateWantedBasestations(rtt::Team lastRequestedBasestation);
     // Will return which basestations are being used, or requested if not selected yet
@@ -79,11 +112,17 @@ class BasestationCollection {
     // Updating the basestation selection
     bool shouldUpdateBasestationSelection;
     std::thread basestationSelectionUpdaterThread;
+    // Wakes the selection thread before its next periodic update, for when a selection could be made right away
+    std::mutex selectionUpdateMutex;
+    std::condition_variable selectionUpdateRequested;
+    bool isSelectionUpdateRequested;
+    void requestBasestationSelectionUpdate();
     void updateBasestationSelection();
     void removeOldBasestations(const std::vector<libusb_device*>& pluggedBasestationDevices);
     void addNewBasestations(const std::vector<libusb_device*>& pluggedBasestationDevices);
 
     void askChannelOfBasestationsWithUnknownChannel() const;
+    static void askChannelOfBasestation(const std::shared_ptr<Basestation>& basestation);
     // Gets list of basestations that could be selected as the blue or yellow basestation
     std::vector<std::shared_ptr<Basestation>> getSelectableBasestations() const;
     // Sends a channel change request to the given basestation to change to the given channel
@@ -94,9 +133,15 @@ class BasestationCollection {
     int selectWantedBasestations();                                                    // Select basestations that we need
     int selectBasestations(bool selectYellowBasestation, bool selectBlueBasestation);  // Will try to select the given basestations
 
+    // Messages that could not be sent because the basestation of the team was not selected
+    std::atomic<int> yellowColdPathDrops;
+    std::atomic<int> blueColdPathDrops;
+
     std::mutex messageCallbackMutex;  // Guards the messageFromBasestationCallback
     void onMessageFromBasestation(const BasestationMessage& message, const BasestationIdentifier& basestationId);
     std::function<void(const BasestationMessage&, rtt::Team color)> messageFromBasestationCallback;
+    std::function<void(const BasestationIdentifier&, std::optional<rtt::Team>, std::span<const uint8_t>)> logFromBasestationCallback;
+    std::optional<rtt::Team> getTeamOfSelectedBasestation(const BasestationIdentifier& basestationId) const;
 
     static WirelessChannel getWirelessChannelCorrespondingTeamColor(rtt::Team color);
     static rtt::Team getTeamColorCorrespondingWirelessChannel(WirelessChannel channel);
@@ -108,6 +153,7 @@ class BasestationCollection {
     // Converts a wireless channel value from REM to a WirelessChannel
     static WirelessChannel remChannelToWirelessChannel(bool remChannel);
     static std::string wirelessChannelToString(WirelessChannel channel);
+    static std::optional<WirelessChannel> stringToWirelessChannel(const std::string& channel);
 };
 
 }  // namespace rtt::robothub::basestation
\ No newline at end of file
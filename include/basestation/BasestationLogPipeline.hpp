@@ -0,0 +1,76 @@
+#pragma once
+
+#include <roboteam_utils/Teams.hpp>
+
+#include <BoundedRing.hpp>
+#include <array>
+#include <atomic>
+#include <basestation/Basestation.hpp>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+
+namespace rtt::robothub::basestation {
+
+constexpr std::size_t MAX_BASESTATION_LOG_LENGTH = 512;       // Longer logs are cut off
+constexpr std::size_t DEFAULT_BASESTATION_LOG_CAPACITY = 256;  // Logs that can wait for the writer. Rounded up to a power of two
+constexpr int DEFAULT_MAX_BASESTATION_LOGS_PER_SECOND = 50;    // Per basestation, more are counted and dropped
+constexpr int MAX_RATE_LIMITED_BASESTATIONS = 8;               // Basestations beyond this share the last rate limit. Kept by serial identifier, so replugs do not use up more
+
+/*  Moves the formatting and writing of basestation logs off the usb thread. The usb thread only copies the text of a
+    log into a slot of a BoundedRing, after checking the rate limit of its basestation, so a firmware that logs a lot
+    cannot delay the feedback that arrives on the same thread. A writer thread turns the logs into strings and hands
+    them to the handler, and reports how many logs of each basestation were dropped. */
+class BasestationLogPipeline {
+   public:
+    // The handler is called on the writer thread. The team is not set for basestations that are not selected
+    explicit BasestationLogPipeline(const std::function<void(const std::string& log, const BasestationIdentifier& basestation, std::optional<rtt::Team> team)>& handler,
+                                    int maxLogsPerSecond = DEFAULT_MAX_BASESTATION_LOGS_PER_SECOND, std::size_t capacity = DEFAULT_BASESTATION_LOG_CAPACITY);
+    // Hands all logs that were pushed before destruction to the handler
+    ~BasestationLogPipeline();
+
+    // Returns false if the log was dropped, because of the rate limit or because the writer fell behind
+    bool push(const BasestationIdentifier& basestation, std::optional<rtt::Team> team, std::span<const uint8_t> text);
+
+    [[nodiscard]] uint64_t getDroppedLogs() const;
+
+   private:
+    typedef struct BasestationLog {
+        BasestationIdentifier basestation;
+        int8_t team;  // -1 when not selected
+        uint16_t length;
+        char text[MAX_BASESTATION_LOG_LENGTH];
+    } BasestationLog;
+
+    // A fixed window limit, which can be checked by any thread without locking
+    typedef struct alignas(64) RateLimit {
+        std::atomic<uint32_t> key;  // 1 + the serial identifier of the basestation, 0 while unused
+        std::atomic<int64_t> windowStartNs;
+        std::atomic<int> logsInWindow;
+        std::atomic<uint64_t> droppedLogs;  // Since the writer last reported them
+    } RateLimit;
+
+    const std::function<void(const std::string&, const BasestationIdentifier&, std::optional<rtt::Team>)> handler;
+    const int maxLogsPerSecond;
+
+    BoundedRing<BasestationLog> ring;
+
+    std::array<RateLimit, MAX_RATE_LIMITED_BASESTATIONS> rateLimits{};
+    std::atomic<uint64_t> droppedLogs;
+    // Returns false if the basestation logged too much in the current window
+    bool isWithinRateLimit(const BasestationIdentifier& basestation);
+
+    std::atomic<bool> shouldWrite;
+    std::thread writerThread;
+    void write();
+    // Hands all filled slots to the handler. Returns whether any slot was filled
+    bool drainRing();
+    void reportDroppedLogs();
+};
+
+}  // namespace rtt::robothub::basestation
@@ -9,10 +9,13 @@
 
 #include <roboteam_utils/Teams.hpp>
 
+#include <EventLoop.hpp>
 #include <basestation/BasestationCollection.hpp>
+#include <basestation/BasestationLogPipeline.hpp>
 #include <functional>
+#include <map>
 #include <memory>
-#include <thread>
+#include <mutex>
 
 namespace rtt::robothub::basestation {
 
@@ -21,28 +24,53 @@ typedef struct BasestationManagerStatus {
     BasestationCollectionStatus basestationCollection;
 } BasestationManagerStatus;
 
+typedef struct BasestationManagerConfiguration {
+    // Stand-in basestations do not use usb. They accept every message without sending it, and only
+    // receive the packets that are injected, for example when replaying a capture
+    bool useStandInBasestations = false;
+    BasestationCollectionConfiguration collection;  // Unused by stand-in basestations
+} BasestationManagerConfiguration;
+
 class BasestationManager {
    public:
     BasestationManager();
+    explicit BasestationManager(const BasestationManagerConfiguration &configuration);
     ~BasestationManager();
 
     int sendRobotCommand(const REM_RobotCommand &command, rtt::Team color) const;
+    // Sends a robot command that is already encoded, for example by a RobotCommandBatch
+    int sendRobotCommandPayload(const REM_RobotCommandPayload &payload, rtt::Team color) const;
     int sendRobotBuzzerCommand(const REM_RobotBuzzer &command, rtt::Team color) const;
 
     void setFeedbackCallback(const std::function<void(const REM_RobotFeedback &, rtt::Team color)> &callback);
     void setRobotStateInfoCallback(const std::function<void(const REM_RobotStateInfo &, rtt::Team color)> &callback);
     void setBasestationLogCallback(const std::function<void(const std::string&, rtt::Team color)> &callback);
+    // Receives every packet from the basestations as it arrived, before it is decoded
+    void setIncomingPacketCallback(const std::function<void(const uint8_t *packet, std::size_t size, rtt::Team color)> &callback);
+
+    // Handles the packet as if a basestation of the given color sent it
+    void injectIncomingPacket(const uint8_t *packet, std::size_t size, rtt::Team color) const;
 
     [[nodiscard]] BasestationManagerStatus getStatus() const;
 
    private:
-    libusb_context *usbContext;
-
-    bool shouldListenForBasestationPlugs;
-    std::thread basestationPlugsListener;
-    void listenForBasestationPlugs();
+    libusb_context *usbContext = nullptr;  // Stays null for stand-in basestations
+
+    // Handles the usb events when the file descriptors of libusb are ready, and periodically checks for plugged basestations
+    std::unique_ptr<EventLoop> usbEventLoop;
+    std::mutex usbFileDescriptorsMutex;                  // Guards the usbFileDescriptorSources
+    std::map<int, int> usbFileDescriptorSources;         // The source id in the usbEventLoop of every file descriptor of libusb
+    int usbTimeoutTimer = -1;                             // Only used when libusb can not handle its timeouts through its file descriptors
+    int basestationPlugsTimer = -1;
+    static void LIBUSB_CALL onUsbFileDescriptorAdded(int fileDescriptor, short events, void *manager);
+    static void LIBUSB_CALL onUsbFileDescriptorRemoved(int fileDescriptor, void *manager);
+    void watchUsbFileDescriptor(int fileDescriptor, short events);
+    void unwatchUsbFileDescriptor(int fileDescriptor);
+    void handleUsbEvents();
+    void checkForBasestationPlugs();
 
     std::unique_ptr<BasestationCollection> basestationCollection;
+    int sendMessage(BasestationMessage &message, rtt::Team color) const;
 
     void handleIncomingMessage(const BasestationMessage &message, rtt::Team basestationColor) const;
 
@@ -51,8 +79,13 @@ class BasestationManager {
     std::function<void(const REM_RobotStateInfo &, rtt::Team)> robotStateInfoCallbackFunction;
     void callRobotStateInfoCallback(const REM_RobotStateInfo& stateInfo, rtt::Team color) const;
     std::function<void(const std::string&, rtt::Team)> basestationLogCallback;
+    std::function<void(const uint8_t *, std::size_t, rtt::Team)> incomingPacketCallback;
     void callBasestationLogCallback(const std::string& basestationLog, rtt::Team color) const;
 
+    // Formats and writes the logs of the basestations on its own thread. Declared last, as its thread uses the callbacks
+    std::unique_ptr<BasestationLogPipeline> logPipeline;
+    void handleBasestationLog(const std::string& log, const BasestationIdentifier& basestation, std::optional<rtt::Team> color) const;
+
     static std::vector<libusb_device *> filterBasestationDevices(libusb_device *const *const devices, int device_count);
 };
 
@@ -19,6 +19,7 @@ std::string usbutils_bEndpointAddress_EndpointNumberToString(uint8_t bEndpointAd
 std::string usbutils_descriptorTypeToString(int bDescriptorType);
 std::string usbutils_classToString(int bDeviceClass);
 std::string usbutils_errorToString(int error);
+std::string usbutils_transferStatusToString(int status);
 std::string usbutils_speedToString(int speed);
 
 void usbutils_enumerate();
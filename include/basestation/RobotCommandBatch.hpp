@@ -0,0 +1,47 @@
+#pragma once
+
+#include <REM_RobotCommand.h>
+
+#include <roboteam_utils/RobotCommands.hpp>
+#include <roboteam_utils/Teams.hpp>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace rtt::robothub::basestation {
+
+// Converts a single command into a REM packet for the basestation of the given team
+REM_RobotCommand toREM_RobotCommand(const rtt::RobotCommand& command, rtt::Team color);
+
+/*  Converts all commands for a team into encoded REM packets at once. The fields are first gathered into
+    a struct of arrays, and all packets are then encoded into one contiguous buffer, with the fields that are
+    the same for the whole team set only once. The packets are byte for byte the same as those of
+    toREM_RobotCommand. The buffers are reused, so converting does not allocate once the batch has seen its
+    largest team. */
+class RobotCommandBatch {
+   public:
+    void convert(std::span<const rtt::RobotCommand> commands, rtt::Team color);
+
+    [[nodiscard]] int size() const;
+    [[nodiscard]] int getRobotId(int index) const;
+    [[nodiscard]] const REM_RobotCommandPayload& getPayload(int index) const;
+
+   private:
+    int amount = 0;
+    rtt::Team color = rtt::Team::YELLOW;
+
+    std::vector<int> robotId;
+    std::vector<float> rho, theta;
+    std::vector<float> kickChipPower, dribbler;
+    std::vector<float> angle, angularVelocity, cameraAngle;
+    std::vector<uint8_t> kickAtAngle, doKick, doChip, doForce, useAbsoluteAngle, useCameraAngle, feedback;
+
+    std::vector<REM_RobotCommandPayload> payloads;
+
+    void resize(int newAmount);
+    void gather(std::span<const rtt::RobotCommand> commands);
+    void encode();
+};
+
+}  // namespace rtt::robothub::basestation
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <roboteam_utils/Teams.hpp>
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <simulation/ConfigurationCommand.hpp>
+#include <simulation/RobotProperties.hpp>
+#include <utility>
+
+namespace rtt::robothub::simulation {
+
+typedef struct BallLocation {
+    float x, y, z;
+    float xVelocity, yVelocity, zVelocity;
+    bool velocityInRolling, teleportSafely, byForce;
+} BallLocation;
+
+typedef struct RobotLocation {
+    float x, y;
+    float xVelocity, yVelocity, angularVelocity;
+    float orientation;
+    bool shouldBePresentOnField, byForce;
+} RobotLocation;
+
+/*  Collects the configuration for the simulator, so a burst of configuration messages ends up in a single command.
+    Changes are staged first, and all staged changes are later taken at once as one ConfigurationCommand, once the
+    coalesce window has passed since the previous take. A later teleport of the same ball or robot replaces the staged
+    one. Robot properties are remembered once they were sent, so properties the simulator already has are not sent again.
+    When they did change, all properties of that robot are sent, as the simulator resets the ones that are left out.
+    This class is thread safe. */
+class ConfigurationCache {
+   public:
+    explicit ConfigurationCache(std::chrono::milliseconds coalesceWindow);
+
+    void stageBallLocation(const BallLocation& location);
+    void stageRobotLocation(int id, rtt::Team color, const RobotLocation& location);
+    void stageRobotProperties(int id, rtt::Team color, const RobotProperties& properties);
+
+    // Puts all staged changes in the command if the coalesce window has passed. Returns whether it did
+    bool takeDueChanges(ConfigurationCommand& command);
+    // Call after sending the taken changes. Only sent properties are remembered, the others are staged again
+    void confirmTakenChanges(bool isSent);
+    // Stages all remembered properties again, for when the simulator may have lost them
+    void forgetAppliedRobotProperties();
+
+   private:
+    typedef std::pair<rtt::Team, int> RobotKey;
+
+    mutable std::mutex cacheMutex;  // Guards all members below
+    const std::chrono::milliseconds coalesceWindow;
+    std::chrono::time_point<std::chrono::steady_clock> lastTake;
+
+    // The properties the simulator currently has applied
+    std::map<RobotKey, RobotProperties> appliedRobotProperties;
+    // The properties that were taken, but not yet confirmed to be sent
+    std::map<RobotKey, RobotProperties> takenRobotProperties;
+
+    // What still has to be sent to the simulator
+    std::optional<BallLocation> stagedBallLocation;
+    std::map<RobotKey, RobotLocation> stagedRobotLocations;
+    std::map<RobotKey, RobotProperties> stagedRobotProperties;
+
+    [[nodiscard]] bool hasStagedChanges() const;
+};
+
+}  // namespace rtt::robothub::simulation
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <ssl_simulation_control.pb.h>
+#include <ssl_simulation_robot_control.pb.h>
+#include <ssl_simulation_robot_feedback.pb.h>
+
+#include <QtNetwork>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <simulation/ImpairedLink.hpp>
+#include <simulation/SimulatorIOPool.hpp>
+#include <simulation/SimulatorManager.hpp>
+#include <vector>
+
+namespace rtt::robothub::simulation {
+
+typedef struct FakeSimulatorConfiguration {
+    // Ports the fake simulator listens to. Responses go to wherever the request came from
+    int blueControlPort = DEFAULT_BLUE_CONTROL_PORT;
+    int yellowControlPort = DEFAULT_YELLOW_CONTROL_PORT;
+    int configurationPort = DEFAULT_CONFIGURATION_PORT;
+
+    double ballContactProbability = 0.0;         // Chance that a robot reports dribbler contact with the ball [0, 1]
+    double errorProbability = 0.0;               // Chance that a response carries a simulator error [0, 1]
+    std::chrono::microseconds responseDelay{0};  // Time between receiving a request and sending its response
+    uint64_t seed = 0;                           // The same seed with the same requests on each port gives the same responses
+} FakeSimulatorConfiguration;
+
+typedef struct FakeSimulatorStatistics {
+    uint64_t robotControlPackets = 0;
+    uint64_t configurationPackets = 0;
+    uint64_t errorsSent = 0;
+} FakeSimulatorStatistics;
+
+/*  A stand-in for grSim or the ER-Force simulator, for testing the simulator path on a box without a simulator.
+    It answers every RobotControl with a RobotControlResponse that has feedback for every commanded robot, and every
+    SimulatorCommand with a SimulatorResponse. It does not simulate anything, so it answers as fast as the network
+    allows, which makes it a suitable target for throughput and latency benchmarks of the SimulatorManager.
+    Fake simulators listen using the tasks of a SimulatorIOPool, so many instances can share a few threads. */
+class FakeSimulator {
+   public:
+    // Throws a FailedToBindPortException if any of the ports is taken
+    explicit FakeSimulator(const FakeSimulatorConfiguration& config, std::shared_ptr<SimulatorIOPool> pool = nullptr);
+    ~FakeSimulator();
+
+    [[nodiscard]] FakeSimulatorStatistics getStatistics() const;
+
+   private:
+    const FakeSimulatorConfiguration configuration;
+    std::shared_ptr<SimulatorIOPool> ioPool;
+    std::vector<int> listenTasks;
+
+    QUdpSocket blueControlSocket;
+    QUdpSocket yellowControlSocket;
+    QUdpSocket configurationSocket;
+
+    // Delay the responses of each socket, on the loop that reads that socket. Only exist if there is a delay
+    std::unique_ptr<ImpairedLink> blueResponseLink;
+    std::unique_ptr<ImpairedLink> yellowResponseLink;
+    std::unique_ptr<ImpairedLink> configurationResponseLink;
+
+    // Every socket has its own generator, only used by the loop that reads that socket, so the responses of one port do not depend
+    // on how the requests of the other ports interleave with them
+    std::mt19937_64 blueRandomGenerator;
+    std::mt19937_64 yellowRandomGenerator;
+    std::mt19937_64 configurationRandomGenerator;
+
+    std::atomic<uint64_t> robotControlPackets;
+    std::atomic<uint64_t> configurationPackets;
+    std::atomic<uint64_t> errorsSent;
+
+    // Listens to the socket on the given loop, and delays its responses on that loop too if there is a delay
+    void listenToSocket(QUdpSocket& socket, std::unique_ptr<ImpairedLink>& responseLink, uint64_t seed, const std::function<void()>& listener);
+    bool answerRobotControls(QUdpSocket& socket, ImpairedLink* responseLink, std::mt19937_64& randomGenerator);
+    bool answerConfigurations();
+    void addRandomError(google::protobuf::RepeatedPtrField<proto::simulation::SimulatorError>& errors, std::mt19937_64& randomGenerator);
+    static bool isRandomlyTrue(double probability, std::mt19937_64& randomGenerator);
+    void sendResponse(QUdpSocket& socket, ImpairedLink* responseLink, const QNetworkDatagram& request, const google::protobuf::Message& response);
+};
+
+}  // namespace rtt::robothub::simulation
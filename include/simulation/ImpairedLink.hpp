@@ -0,0 +1,65 @@
+#pragma once
+
+#include <EventLoop.hpp>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <random>
+#include <vector>
+
+namespace rtt::robothub::simulation {
+
+// Describes how badly a link should behave. The defaults describe a perfect link
+typedef struct LinkImpairmentSettings {
+    double lossProbability = 0.0;                // Chance that a packet is dropped [0, 1]
+    std::chrono::microseconds latency{0};        // Delay added to every packet
+    std::chrono::microseconds jitter{0};         // Random delay between -jitter and +jitter added on top of the latency
+    double reorderProbability = 0.0;             // Chance that a packet skips the latency, overtaking earlier packets [0, 1]
+    std::size_t bandwidthBytesPerSecond = 0;     // Packets queue up when the link is busy. 0 is unlimited
+} LinkImpairmentSettings;
+
+/*  Emulates an imperfect link, like our radio link, between us and the simulator. Every packet that is
+    submitted is either dropped, or delivered later by calling its delivery function on the given event loop.
+    Give it the loop that reads the socket the packets are written to, so delivering does not add another
+    thread that uses the socket. All randomness comes from the given seed, so the same traffic is impaired the same way. */
+class ImpairedLink {
+   public:
+    // Throws a FailedToCreateEventLoopException if the delivery timer cannot be created
+    ImpairedLink(const LinkImpairmentSettings& settings, uint64_t seed, EventLoop& loop);
+    // Packets that were not delivered yet are dropped
+    ~ImpairedLink();
+
+    // Returns false if the packet was dropped, in which case the delivery function is never called
+    bool submit(std::size_t packetSize, std::function<void()> delivery);
+
+   private:
+    typedef std::chrono::time_point<std::chrono::steady_clock> TimePoint;
+    typedef struct ScheduledPacket {
+        TimePoint deliveryTime;
+        uint64_t sequenceNumber;  // Keeps packets with equal delivery times in order
+        std::function<void()> delivery;
+
+        bool operator>(const ScheduledPacket& other) const;
+    } ScheduledPacket;
+
+    const LinkImpairmentSettings settings;
+    EventLoop& loop;
+    int timerDescriptor;   // Expires when the first scheduled packet is due
+    int deliverySourceId;  // Of the timer in the loop
+
+    std::mutex packetsMutex;  // Guards all members below
+    std::priority_queue<ScheduledPacket, std::vector<ScheduledPacket>, std::greater<>> scheduledPackets;
+    std::mt19937_64 randomGenerator;
+    TimePoint linkBusyUntil;  // When the bandwidth limited link has sent all queued packets
+    uint64_t nextSequenceNumber;
+    std::optional<TimePoint> timerExpiration;  // Not set while the timer is disarmed
+
+    // Makes the timer expire at the time, unless it already expires earlier
+    void armTimer(TimePoint expiration);
+    void deliverDuePackets();
+};
+
+}  // namespace rtt::robothub::simulation
@@ -22,5 +22,15 @@ typedef struct RobotProperties {
     float backRightWheelAngle = 210.0f;
     float backLeftWheelAngle = 150.0f;
     float frontLeftWheelAngle = 60.0f;
+
+    bool operator==(const RobotProperties& other) const {
+        return radius == other.radius && height == other.height && mass == other.mass && maxKickSpeed == other.maxKickSpeed && maxChipSpeed == other.maxChipSpeed &&
+               centerToDribblerDistance == other.centerToDribblerDistance && maxAcceleration == other.maxAcceleration &&
+               maxAngularAcceleration == other.maxAngularAcceleration && maxDeceleration == other.maxDeceleration &&
+               maxAngularDeceleration == other.maxAngularDeceleration && maxVelocity == other.maxVelocity && maxAngularVelocity == other.maxAngularVelocity &&
+               frontRightWheelAngle == other.frontRightWheelAngle && backRightWheelAngle == other.backRightWheelAngle &&
+               backLeftWheelAngle == other.backLeftWheelAngle && frontLeftWheelAngle == other.frontLeftWheelAngle;
+    }
+    bool operator!=(const RobotProperties& other) const { return !(*this == other); }
 } RobotProperties;
 }  // namespace rtt::robothub::simulation
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <roboteam_utils/Teams.hpp>
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace rtt::robothub::simulation {
+
+// Distribution of the round trip times measured in an interval, in microseconds
+typedef struct RoundTripStatistics {
+    int samples = 0;
+    int lost = 0;  // Control packets that never got a response
+    double minUs = 0;
+    double p50Us = 0;
+    double p99Us = 0;
+    double maxUs = 0;
+} RoundTripStatistics;
+
+/*  Measures the time between sending a RobotControl packet and receiving the matching RobotControlResponse.
+    The SSL protocol has no sequence numbers, but a simulator answers every control packet in order, so
+    responses are matched to the oldest outstanding packet of the same team. Packets that are not answered
+    within the timeout are considered lost, so a lost packet only disturbs the matching for a short while.
+    This class is thread safe. */
+class RoundTripTimer {
+   public:
+    RoundTripTimer();
+
+    // Call this right before sending, as the response could otherwise arrive before the packet is known
+    void onPacketSent(rtt::Team color);
+    // Forgets the newest outstanding packet, for when sending it failed
+    void onPacketSendFailed(rtt::Team color);
+    // Counts the newest outstanding packet as lost, for when we know it never reached the simulator
+    void onPacketLost(rtt::Team color);
+    void onResponseReceived(rtt::Team color);
+    // Forgets the oldest outstanding packet, for when we know its response will never arrive
+    void onResponseLost(rtt::Team color);
+
+    // Returns the distribution of the round trip times since the previous call, and starts a new interval
+    RoundTripStatistics takeStatistics(rtt::Team color);
+
+   private:
+    typedef struct TeamTimes {
+        std::deque<std::chrono::time_point<std::chrono::steady_clock>> outstandingPackets;
+        std::vector<double> roundTripTimesUs;  // Of this interval
+        int lostPackets = 0;                   // Of this interval
+    } TeamTimes;
+
+    std::mutex timesMutex;  // Guards both team times
+    TeamTimes yellowTimes;
+    TeamTimes blueTimes;
+
+    TeamTimes& getTeamTimes(rtt::Team color);
+    void forgetTimedOutPackets(TeamTimes& times, std::chrono::time_point<std::chrono::steady_clock> now);
+};
+
+}  // namespace rtt::robothub::simulation
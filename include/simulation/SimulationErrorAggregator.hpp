@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <simulation/Feedback.hpp>
+#include <string>
+#include <utility>
+
+namespace rtt::robothub::simulation {
+
+/*  Simulators tend to report the same error on every packet, for example when a feature is not supported.
+    This class counts errors by their code and message, and decides when an error should be reported again.
+    A distinct error is reported at most once per report interval, together with how often it occurred since
+    it was last reported. Errors that did not occur for a whole report interval are forgotten, after reporting
+    the occurrences that were not reported yet, so errors with changing messages do not pile up. This class is
+    thread safe. */
+class SimulationErrorAggregator {
+   public:
+    SimulationErrorAggregator(std::chrono::milliseconds reportInterval, const std::function<void(const std::string&)>& report);
+    // Reports the occurrences that were not reported yet
+    ~SimulationErrorAggregator();
+
+    // Counts the error, and reports it if it is due
+    void addError(const SimulationError& error);
+    // Forgets the errors that stopped occurring. Call this periodically, so their last occurrences are reported
+    void evictQuietErrors();
+
+    [[nodiscard]] std::size_t getDistinctErrors() const;  // Distinct errors that are still occurring
+
+   private:
+    typedef std::pair<std::optional<std::string>, std::optional<std::string>> ErrorKey;  // Code and message
+    typedef struct ErrorCounter {
+        std::string description;
+        std::size_t occurrencesSinceReport = 0;  // Since the error was last reported
+        std::chrono::time_point<std::chrono::steady_clock> lastReport;
+        std::chrono::time_point<std::chrono::steady_clock> lastOccurrence;
+    } ErrorCounter;
+
+    mutable std::mutex countersMutex;  // Guards the counters
+    const std::chrono::milliseconds reportInterval;
+    const std::function<void(const std::string&)> report;
+    std::map<ErrorKey, ErrorCounter> counters;
+
+    // Reports the occurrences of the counter since its last report, if there are any
+    void reportPendingOccurrences(ErrorCounter& counter, std::chrono::time_point<std::chrono::steady_clock> now);
+    static std::string errorToString(const SimulationError& error);
+};
+
+}  // namespace rtt::robothub::simulation
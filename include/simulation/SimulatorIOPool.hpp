@@ -0,0 +1,49 @@
+#pragma once
+
+#include <EventLoop.hpp>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace rtt::robothub::simulation {
+
+/*  A small pool of event loops that services the feedback sockets of any amount of SimulatorManagers.
+    Every manager registers its listeners as tasks, which run when their socket has data to read. A task
+    is always run by the same loop, so a socket is never read by two threads at once. Periodic work, like
+    flushing configurations, runs on timers of the same loops. This way, many simulator sessions can share
+    a few threads that only wake up when there is work, instead of each session spawning its own threads. */
+class SimulatorIOPool {
+   public:
+    explicit SimulatorIOPool(int amountOfThreads);
+
+    // Adds a task to the loop with the least tasks, which runs it whenever the socket is readable. Returns an id that can be used to remove it
+    int addSocketTask(int socketDescriptor, const std::function<void()>& task);
+    // Adds the task to the given loop of this pool, so it runs on the same thread as the other work on that loop
+    int addSocketTask(EventLoop& loop, int socketDescriptor, const std::function<void()>& task);
+    // Adds a task that runs every interval. Returns an id that can be used to remove it
+    int addTimerTask(std::chrono::nanoseconds interval, const std::function<void()>& task);
+    // Removes the task. After this returns, the task is guaranteed to not be running anymore
+    void removeTask(int taskId);
+
+    [[nodiscard]] int getAmountOfThreads() const;
+    // Work that has to stay on one thread, like a socket and the impaired links that write to it, is put on the same loop
+    EventLoop& getLeastBusyLoop();
+
+   private:
+    std::vector<std::unique_ptr<EventLoop>> loops;
+
+    typedef struct TaskLocation {
+        EventLoop* loop;
+        int sourceId;
+    } TaskLocation;
+    std::mutex tasksMutex;  // Guards the nextTaskId and the assignment of tasks to loops
+    int nextTaskId;
+    std::map<int, TaskLocation> tasks;
+
+    int rememberTask(EventLoop& loop, int sourceId);
+};
+
+}  // namespace rtt::robothub::simulation
@@ -10,10 +10,17 @@
 #include <roboteam_utils/Teams.hpp>
 
 #include <QtNetwork>
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <simulation/ConfigurationCommand.hpp>
 #include <simulation/Feedback.hpp>
+#include <simulation/ImpairedLink.hpp>
 #include <simulation/RobotControlCommand.hpp>
+#include <simulation/RoundTripTimer.hpp>
+#include <simulation/SimulatorIOPool.hpp>
+#include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <thread>
@@ -24,6 +31,13 @@ constexpr int DEFAULT_CONFIGURATION_PORT = 10300;
 constexpr int DEFAULT_BLUE_CONTROL_PORT = 10301;
 constexpr int DEFAULT_YELLOW_CONTROL_PORT = 10302;
 
+// Makes the link with the simulator behave like our radio link. Applies to both commands and feedback of a team
+typedef struct SimulatorLinkImpairment {
+    LinkImpairmentSettings blue;
+    LinkImpairmentSettings yellow;
+    uint64_t seed = 0;  // The same seed with the same traffic gives the same impairment
+} SimulatorLinkImpairment;
+
 typedef struct SimulatorNetworkConfiguration {
     QHostAddress simIpAddress = QHostAddress::LocalHost;
 
@@ -36,19 +50,24 @@ typedef struct SimulatorNetworkConfiguration {
     int blueFeedbackPort = DEFAULT_BLUE_CONTROL_PORT;
     int yellowFeedbackPort = DEFAULT_YELLOW_CONTROL_PORT;
     int configurationFeedbackPort = DEFAULT_CONFIGURATION_PORT;
+
+    // When set, robot control packets and their feedback pass through emulated imperfect links
+    std::optional<SimulatorLinkImpairment> linkImpairment;
 } SimulatorNetworkConfiguration;
 
 /*  This class can manage a connection with any simulator that follows the official SSL protocol.
     It can send robot control messages that control the robots, and it can send configuration
     messages that can configure the simulator, for example the size of the robots or physical
     properties of the field.
-    To prevent waiting for a response, 3 listen threads are used to listen for feedback for
-    the blue team, the yellow team and feedback for configuring the simulator. These threads will
-    use a callback if it has been set. */
+    To prevent waiting for a response, 3 listen tasks are used to listen for feedback for
+    the blue team, the yellow team and feedback for configuring the simulator. These tasks run
+    on a SimulatorIOPool when their socket has data, which can be shared by multiple managers,
+    and will use a callback if it has been set. Without a given pool, the manager creates its
+    own pool of 1 thread. */
 class SimulatorManager {
    public:
     // Can throw FailedToBindPortException
-    SimulatorManager(SimulatorNetworkConfiguration configuration);
+    explicit SimulatorManager(SimulatorNetworkConfiguration configuration, std::shared_ptr<SimulatorIOPool> ioPool = nullptr);
     ~SimulatorManager();
 
     // Both of the send functions return amount of bytes sent, return 0 if error occurred
@@ -58,6 +77,15 @@ class SimulatorManager {
     // These will set the callback function, which will be called when feedback is received
     void setRobotControlFeedbackCallback(std::function<void(RobotControlFeedback&)> callback);
     void setConfigurationFeedbackCallback(std::function<void(ConfigurationFeedback&)> callback);
+    // Called when the simulator responds for the first time, or again after being silent. It may have restarted since
+    void setLinkEstablishedCallback(std::function<void()> callback);
+
+    // Returns the round trip times of robot control packets since the previous call
+    RoundTripStatistics takeRoundTripStatistics(rtt::Team color);
+
+    // Conversions between packets and bytes. These are public so they can be benchmarked
+    static QByteArray serializePacket(google::protobuf::Message& packet);
+    static RobotControlFeedback getControlFeedbackFromDatagram(QNetworkDatagram& datagram, rtt::Team color);
 
    private:
     SimulatorNetworkConfiguration networkConfiguration;
@@ -66,32 +94,49 @@ class SimulatorManager {
     QUdpSocket yellowControlSocket;
     QUdpSocket configurationSocket;
 
-    bool shouldStopListeningToFeedback;
-    std::thread blueFeedbackListenThread;
-    std::thread yellowFeedbackListenThread;
-    std::thread configurationFeedbackListenThread;
+    std::shared_ptr<SimulatorIOPool> ioPool;
+    std::vector<int> feedbackListenTasks;  // Ids of our listen tasks in the ioPool
 
     // Both blue and yellow feedback thread use same callback function, so mutex protects it
     std::mutex robotControlFeedbackMutex;
     std::function<void(RobotControlFeedback&)> robotControlFeedbackCallback;
     std::function<void(ConfigurationFeedback&)> configurationFeedbackCallback;
+    std::function<void()> linkEstablishedCallback;
+
+    // When anything was last received from the simulator, in steady clock ticks. 0 if never
+    std::atomic<std::chrono::steady_clock::rep> lastReceiveTicks = 0;
+
+    RoundTripTimer roundTripTimer;  // Matches robot control packets with their responses
+
+    // Only exist if the link should be impaired
+    std::unique_ptr<ImpairedLink> blueCommandLink;
+    std::unique_ptr<ImpairedLink> yellowCommandLink;
+    std::unique_ptr<ImpairedLink> blueFeedbackLink;
+    std::unique_ptr<ImpairedLink> yellowFeedbackLink;
+
+    // Sends the robot control packet, through the impaired link if there is one
+    std::size_t sendRobotControlPacket(google::protobuf::Message& packet, QUdpSocket& socket, int port, rtt::Team color);
+    // Handles a robot control response that arrived, or that was delivered by the impaired link
+    void handleRobotControlDatagram(QNetworkDatagram& datagram, rtt::Team color);
 
     // Returns the amount of bytes sent, returns 0 if error occurred
     std::size_t sendPacket(google::protobuf::Message& packet, QUdpSocket& socket, int port);
+    std::size_t sendDatagram(const QByteArray& datagram, QUdpSocket& socket, int port);
 
+    // Calls the link established callback if the simulator was silent before this datagram
+    void onDatagramReceived();
     // These will call the callback functions, if set, whenever feedback is received
     void callRobotControlFeedbackCallback(RobotControlFeedback& feedback);
     void callConfigurationFeedbackCallback(ConfigurationFeedback& feedback);
 
-    // These functions will keep listening for feedback until the Manager object gets destroyed
-    void listenForRobotControlFeedback(rtt::Team color);
-    void listenForConfigurationFeedback();
+    // These functions handle all feedback that is pending on the socket. Returns whether there was any
+    bool listenForRobotControlFeedback(rtt::Team color);
+    bool listenForConfigurationFeedback();
 
-    // Will prevent threads from continuing and waits for them to finish
-    void stopFeedbackListeningThreads();
+    // Will remove our listen tasks from the ioPool, after which they are guaranteed to not be running
+    void stopFeedbackListeningTasks();
 
-    // These functions will convert a datagram of bytes into accessible data
-    RobotControlFeedback getControlFeedbackFromDatagram(QNetworkDatagram& datagram, rtt::Team color);
+    // Converts a datagram of bytes into accessible data
     ConfigurationFeedback getConfigurationFeedbackFromDatagram(QNetworkDatagram& datagram);
 };
 
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <roboteam_utils/Teams.hpp>
+
+#include <array>
+#include <mutex>
+#include <simulation/RobotProperties.hpp>
+
+namespace rtt::robothub::simulation {
+
+constexpr int MAX_ROBOTS_PER_TEAM = 16;  // Robot ids range from 0 up to this
+
+/*  The velocities of a whole team, stored as a struct of arrays. Element i of every array belongs to
+    the same robot. This layout lets the compiler process several robots per instruction. Velocities
+    are in m/s and rad/s, relative to the field, and the orientation is in radians. */
+typedef struct TeamVelocities {
+    int amount = 0;
+    alignas(32) std::array<int, MAX_ROBOTS_PER_TEAM> robotId = {};
+    alignas(32) std::array<float, MAX_ROBOTS_PER_TEAM> xVelocity = {};
+    alignas(32) std::array<float, MAX_ROBOTS_PER_TEAM> yVelocity = {};
+    alignas(32) std::array<float, MAX_ROBOTS_PER_TEAM> angularVelocity = {};
+    alignas(32) std::array<float, MAX_ROBOTS_PER_TEAM> orientation = {};
+} TeamVelocities;
+
+// The resulting wheel velocities in m/s, in the same order as the TeamVelocities they were computed from
+typedef struct TeamWheelVelocities {
+    int amount = 0;
+    alignas(32) std::array<float, MAX_ROBOTS_PER_TEAM> frontRight = {};
+    alignas(32) std::array<float, MAX_ROBOTS_PER_TEAM> backRight = {};
+    alignas(32) std::array<float, MAX_ROBOTS_PER_TEAM> backLeft = {};
+    alignas(32) std::array<float, MAX_ROBOTS_PER_TEAM> frontLeft = {};
+} TeamWheelVelocities;
+
+/*  Computes the wheel velocities of a whole team at once, which is how our real robots are driven.
+    For every robot the global velocity is rotated into the robot frame, and projected onto the
+    driving direction of each wheel. The wheel angles are taken from the robot properties that were
+    last configured, and the sines and cosines of these are cached, so a batch only computes the
+    sine and cosine of each robot orientation. This class is thread safe. */
+class WheelKinematics {
+   public:
+    WheelKinematics();
+
+    // Updates the wheel geometry of a robot. Robots without configured properties use the default properties
+    void setRobotProperties(int id, rtt::Team color, const RobotProperties& properties);
+
+    // Robot ids in the batch must lie within [0, MAX_ROBOTS_PER_TEAM)
+    void computeWheelVelocities(rtt::Team color, const TeamVelocities& velocities, TeamWheelVelocities& wheelVelocities) const;
+
+   private:
+    // The driving direction of each wheel in the robot frame, and the distance of the wheels to the center
+    typedef struct TeamGeometry {
+        alignas(32) std::array<float, MAX_ROBOTS_PER_TEAM> frontRightSin, frontRightCos;
+        alignas(32) std::array<float, MAX_ROBOTS_PER_TEAM> backRightSin, backRightCos;
+        alignas(32) std::array<float, MAX_ROBOTS_PER_TEAM> backLeftSin, backLeftCos;
+        alignas(32) std::array<float, MAX_ROBOTS_PER_TEAM> frontLeftSin, frontLeftCos;
+        alignas(32) std::array<float, MAX_ROBOTS_PER_TEAM> wheelDistance;
+    } TeamGeometry;
+
+    mutable std::mutex geometryMutex;  // Guards the geometries
+    TeamGeometry blueGeometry;
+    TeamGeometry yellowGeometry;
+};
+
+}  // namespace rtt::robothub::simulation
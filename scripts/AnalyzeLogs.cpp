@@ -0,0 +1,392 @@
+#include <REM_BaseTypes.h>
+#include <REM_RobotFeedback.h>
+
+#include <LatencyHistogram.hpp>
+#include <RembinReader.hpp>
+#include <roboteam_utils/Teams.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace rtt::robothub;
+
+constexpr int MAX_ROBOT_ID = 32;  // Robots with higher ids are ignored
+constexpr int AMOUNT_OF_ROBOT_SLOTS = 2 * MAX_ROBOT_ID;
+constexpr uint64_t MICROSECONDS_PER_MINUTE = 60 * 1000000ULL;
+constexpr double MICROSECONDS_PER_SECOND = 1000000.0;
+constexpr double MICROSECONDS_PER_MILLISECOND = 1000.0;
+
+// Distribution of durations in microseconds, in the same buckets as the LatencyHistogram of RobotHub
+class DurationHistogram {
+   public:
+    void record(uint64_t microseconds) {
+        this->counts[LatencyHistogram::toBucket(microseconds * 1000)]++;
+        this->samples++;
+        this->maxUs = std::max(this->maxUs, microseconds);
+    }
+
+    void merge(const DurationHistogram& other) {
+        for (int i = 0; i < LATENCY_BUCKETS; ++i) this->counts[i] += other.counts[i];
+        this->samples += other.samples;
+        this->maxUs = std::max(this->maxUs, other.maxUs);
+    }
+
+    [[nodiscard]] uint64_t getSamples() const { return this->samples; }
+    [[nodiscard]] double getMaxMs() const { return static_cast<double>(this->maxUs) / MICROSECONDS_PER_MILLISECOND; }
+
+    // The smallest duration that at least the given fraction of the samples is below, in milliseconds
+    [[nodiscard]] double getPercentileMs(double fraction) const {
+        if (this->samples == 0) return 0;
+        auto wanted = static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(this->samples)));
+        uint64_t seen = 0;
+        for (int i = 0; i < LATENCY_BUCKETS; ++i) {
+            seen += this->counts[i];
+            // A bucket is wider than the durations in it, but no duration is above the maximum
+            if (seen >= wanted && this->counts[i] > 0) return std::min(static_cast<double>(LatencyHistogram::getBucketUpperBound(i)) / 1e6, this->getMaxMs());
+        }
+        return this->getMaxMs();
+    }
+
+   private:
+    std::array<uint64_t, LATENCY_BUCKETS> counts{};
+    uint64_t samples = 0;
+    uint64_t maxUs = 0;
+};
+
+typedef struct MinuteTrend {
+    uint64_t feedbackPackets = 0;
+    double rssiSum = 0;
+    double batterySum = 0;
+} MinuteTrend;
+
+typedef struct RobotAnalysis {
+    uint64_t feedbackPackets = 0;
+    double feedbackSeconds = 0;  // Time between the first and last feedback, summed over all files
+    double rssiSum = 0;
+    uint32_t rssiMin = UINT32_MAX;
+    uint32_t rssiMax = 0;
+    uint64_t firstBatteryUs = UINT64_MAX;
+    uint32_t firstBattery = 0;
+    uint64_t lastBatteryUs = 0;
+    uint32_t lastBattery = 0;
+    uint32_t batteryMin = UINT32_MAX;
+    uint64_t stateInfoPackets = 0;
+    uint64_t commandPackets = 0;
+    DurationHistogram commandGaps;
+    DurationHistogram commandToFeedback;  // From a command to the first feedback after it
+    std::map<uint64_t, MinuteTrend> trend;
+
+    // Only used while analyzing a single file
+    uint64_t fileFirstFeedbackUs = UINT64_MAX;
+    uint64_t fileLastFeedbackUs = 0;
+    uint64_t lastCommandUs = 0;
+    bool lastCommandIsAnswered = true;
+
+    void merge(const RobotAnalysis& other) {
+        this->feedbackPackets += other.feedbackPackets;
+        this->feedbackSeconds += other.feedbackSeconds;
+        this->rssiSum += other.rssiSum;
+        this->rssiMin = std::min(this->rssiMin, other.rssiMin);
+        this->rssiMax = std::max(this->rssiMax, other.rssiMax);
+        if (other.firstBatteryUs < this->firstBatteryUs) {
+            this->firstBatteryUs = other.firstBatteryUs;
+            this->firstBattery = other.firstBattery;
+        }
+        if (other.lastBatteryUs > this->lastBatteryUs) {
+            this->lastBatteryUs = other.lastBatteryUs;
+            this->lastBattery = other.lastBattery;
+        }
+        this->batteryMin = std::min(this->batteryMin, other.batteryMin);
+        this->stateInfoPackets += other.stateInfoPackets;
+        this->commandPackets += other.commandPackets;
+        this->commandGaps.merge(other.commandGaps);
+        this->commandToFeedback.merge(other.commandToFeedback);
+        for (const auto& [minute, trend] : other.trend) {
+            auto& ownTrend = this->trend[minute];
+            ownTrend.feedbackPackets += trend.feedbackPackets;
+            ownTrend.rssiSum += trend.rssiSum;
+            ownTrend.batterySum += trend.batterySum;
+        }
+    }
+} RobotAnalysis;
+
+typedef struct LogAnalysis {
+    std::array<RobotAnalysis, AMOUNT_OF_ROBOT_SLOTS> robots;
+    uint64_t files = 0;
+    uint64_t unreadableFiles = 0;
+    uint64_t bytes = 0;
+    uint64_t records = 0;
+
+    void merge(const LogAnalysis& other) {
+        for (int i = 0; i < AMOUNT_OF_ROBOT_SLOTS; ++i) this->robots[i].merge(other.robots[i]);
+        this->files += other.files;
+        this->unreadableFiles += other.unreadableFiles;
+        this->bytes += other.bytes;
+        this->records += other.records;
+    }
+} LogAnalysis;
+
+int getRobotSlot(rtt::Team team, int robotId) { return (team == rtt::Team::BLUE ? MAX_ROBOT_ID : 0) + robotId; }
+
+void analyzeFeedback(RobotAnalysis& robot, uint64_t timestampUs, const REM_RobotFeedback& feedback) {
+    robot.feedbackPackets++;
+    robot.fileFirstFeedbackUs = std::min(robot.fileFirstFeedbackUs, timestampUs);
+    robot.fileLastFeedbackUs = std::max(robot.fileLastFeedbackUs, timestampUs);
+
+    robot.rssiSum += feedback.rssi;
+    robot.rssiMin = std::min(robot.rssiMin, static_cast<uint32_t>(feedback.rssi));
+    robot.rssiMax = std::max(robot.rssiMax, static_cast<uint32_t>(feedback.rssi));
+
+    if (timestampUs < robot.firstBatteryUs) {
+        robot.firstBatteryUs = timestampUs;
+        robot.firstBattery = feedback.batteryLevel;
+    }
+    if (timestampUs >= robot.lastBatteryUs) {
+        robot.lastBatteryUs = timestampUs;
+        robot.lastBattery = feedback.batteryLevel;
+    }
+    robot.batteryMin = std::min(robot.batteryMin, static_cast<uint32_t>(feedback.batteryLevel));
+
+    auto& minute = robot.trend[timestampUs / MICROSECONDS_PER_MINUTE];
+    minute.feedbackPackets++;
+    minute.rssiSum += feedback.rssi;
+    minute.batterySum += feedback.batteryLevel;
+
+    if (!robot.lastCommandIsAnswered && timestampUs >= robot.lastCommandUs) {
+        robot.commandToFeedback.record(timestampUs - robot.lastCommandUs);
+        robot.lastCommandIsAnswered = true;
+    }
+}
+
+void analyzeCommand(RobotAnalysis& robot, uint64_t timestampUs) {
+    robot.commandPackets++;
+    if (robot.lastCommandUs != 0 && timestampUs >= robot.lastCommandUs) robot.commandGaps.record(timestampUs - robot.lastCommandUs);
+    robot.lastCommandUs = timestampUs;
+    robot.lastCommandIsAnswered = false;
+}
+
+void analyzeFile(const std::string& path, const RembinQuery& query, LogAnalysis& analysis) {
+    // Gaps and latencies are only measured within a file, as files can be hours apart
+    for (auto& robot : analysis.robots) {
+        robot.fileFirstFeedbackUs = UINT64_MAX;
+        robot.fileLastFeedbackUs = 0;
+        robot.lastCommandUs = 0;
+        robot.lastCommandIsAnswered = true;
+    }
+
+    try {
+        RembinReader reader(path);
+        reader.forEachRecord(query, [&](const RembinRecord& record) {
+            analysis.records++;
+
+            auto packetType = getREMPacketType(record.packet, record.size);
+            auto robotId = getREMRobotId(record.packet, record.size);
+            if (!packetType.has_value() || !robotId.has_value() || robotId.value() < 0 || robotId.value() >= MAX_ROBOT_ID) return;
+            auto& robot = analysis.robots[getRobotSlot(record.team, robotId.value())];
+
+            switch (packetType.value()) {
+                case REM_PACKET_TYPE_REM_ROBOT_FEEDBACK: {
+                    if (record.size < REM_PACKET_SIZE_REM_ROBOT_FEEDBACK) return;
+                    REM_RobotFeedback feedback = {};
+                    decodeREM_RobotFeedback(&feedback, (REM_RobotFeedbackPayload*)record.packet);
+                    analyzeFeedback(robot, record.timestampUs, feedback);
+                    break;
+                }
+                case REM_PACKET_TYPE_REM_ROBOT_COMMAND:
+                    analyzeCommand(robot, record.timestampUs);
+                    break;
+                case REM_PACKET_TYPE_REM_ROBOT_STATE_INFO:
+                    robot.stateInfoPackets++;
+                    break;
+                default:
+                    break;
+            }
+        });
+        analysis.files++;
+        std::error_code error;
+        auto size = std::filesystem::file_size(path, error);
+        if (!error) analysis.bytes += size;
+    } catch (const FailedToReadRembinException& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        analysis.unreadableFiles++;
+    }
+
+    for (auto& robot : analysis.robots) {
+        if (robot.fileLastFeedbackUs > robot.fileFirstFeedbackUs) {
+            robot.feedbackSeconds += static_cast<double>(robot.fileLastFeedbackUs - robot.fileFirstFeedbackUs) / MICROSECONDS_PER_SECOND;
+        }
+    }
+}
+
+// Analyzes the files on all threads, every thread taking the next file that is not analyzed yet
+std::unique_ptr<LogAnalysis> analyzeFiles(const std::vector<std::string>& paths, const RembinQuery& query, int amountOfThreads) {
+    // An analysis is big, so it lives on the heap instead of the stack
+    auto total = std::make_unique<LogAnalysis>();
+    std::mutex totalMutex;
+    std::atomic<std::size_t> nextFile = 0;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < amountOfThreads; ++i) {
+        threads.emplace_back([&] {
+            auto analysis = std::make_unique<LogAnalysis>();
+            for (std::size_t file = nextFile++; file < paths.size(); file = nextFile++) {
+                analyzeFile(paths[file], query, *analysis);
+            }
+
+            std::scoped_lock<std::mutex> lock(totalMutex);
+            total->merge(*analysis);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    return total;
+}
+
+void printAnalysis(const LogAnalysis& analysis) {
+    std::printf("%-6s %5s %9s %7s %17s %19s %9s %26s %20s\n", "Team", "Robot", "Feedback", "Rate", "RSSI avg/min/max", "Battery first/last", "Commands", "Command gap p50/p99/max", "To feedback p50/p99");
+    for (int slot = 0; slot < AMOUNT_OF_ROBOT_SLOTS; ++slot) {
+        const auto& robot = analysis.robots[slot];
+        if (robot.feedbackPackets == 0 && robot.commandPackets == 0 && robot.stateInfoPackets == 0) continue;
+
+        std::string team = rtt::teamToString(slot < MAX_ROBOT_ID ? rtt::Team::YELLOW : rtt::Team::BLUE);
+        double rate = robot.feedbackSeconds > 0 ? static_cast<double>(robot.feedbackPackets) / robot.feedbackSeconds : 0;
+        double rssiMean = robot.feedbackPackets > 0 ? robot.rssiSum / static_cast<double>(robot.feedbackPackets) : 0;
+        uint32_t rssiMin = robot.feedbackPackets > 0 ? robot.rssiMin : 0;
+
+        std::printf("%-6s %5d %9lu %5.1fHz %7.1f/%4u/%4u %12u/%6u %9lu %9.1f/%6.1f/%7.1f ms %10.1f/%6.1f ms\n", team.c_str(), slot % MAX_ROBOT_ID, robot.feedbackPackets, rate, rssiMean,
+                    rssiMin, robot.rssiMax, robot.firstBattery, robot.lastBattery, robot.commandPackets, robot.commandGaps.getPercentileMs(0.5), robot.commandGaps.getPercentileMs(0.99),
+                    robot.commandGaps.getMaxMs(), robot.commandToFeedback.getPercentileMs(0.5), robot.commandToFeedback.getPercentileMs(0.99));
+    }
+}
+
+void writeRobotsCsv(const LogAnalysis& analysis, const std::string& path) {
+    std::ofstream csv(path);
+    csv << "team,robot,feedback_packets,feedback_rate_hz,rssi_mean,rssi_min,rssi_max,battery_first,battery_last,battery_min,state_info_packets,command_packets,"
+           "command_gap_p50_ms,command_gap_p99_ms,command_gap_max_ms,command_to_feedback_samples,command_to_feedback_p50_ms,command_to_feedback_p99_ms\n";
+
+    for (int slot = 0; slot < AMOUNT_OF_ROBOT_SLOTS; ++slot) {
+        const auto& robot = analysis.robots[slot];
+        if (robot.feedbackPackets == 0 && robot.commandPackets == 0 && robot.stateInfoPackets == 0) continue;
+
+        bool hasFeedback = robot.feedbackPackets > 0;
+        csv << rtt::teamToString(slot < MAX_ROBOT_ID ? rtt::Team::YELLOW : rtt::Team::BLUE) << "," << slot % MAX_ROBOT_ID << "," << robot.feedbackPackets << ","
+            << (robot.feedbackSeconds > 0 ? static_cast<double>(robot.feedbackPackets) / robot.feedbackSeconds : 0) << ","
+            << (hasFeedback ? robot.rssiSum / static_cast<double>(robot.feedbackPackets) : 0) << "," << (hasFeedback ? robot.rssiMin : 0) << "," << robot.rssiMax << ","
+            << robot.firstBattery << "," << robot.lastBattery << "," << (hasFeedback ? robot.batteryMin : 0) << "," << robot.stateInfoPackets << "," << robot.commandPackets << ","
+            << robot.commandGaps.getPercentileMs(0.5) << "," << robot.commandGaps.getPercentileMs(0.99) << "," << robot.commandGaps.getMaxMs() << ","
+            << robot.commandToFeedback.getSamples() << "," << robot.commandToFeedback.getPercentileMs(0.5) << "," << robot.commandToFeedback.getPercentileMs(0.99) << "\n";
+    }
+}
+
+// One row per robot per minute, to follow RSSI and battery over a match
+void writeTrendCsv(const LogAnalysis& analysis, const std::string& path) {
+    std::ofstream csv(path);
+    csv << "team,robot,minute_unix_s,feedback_packets,rssi_mean,battery_mean\n";
+
+    for (int slot = 0; slot < AMOUNT_OF_ROBOT_SLOTS; ++slot) {
+        std::string team = rtt::teamToString(slot < MAX_ROBOT_ID ? rtt::Team::YELLOW : rtt::Team::BLUE);
+        for (const auto& [minute, trend] : analysis.robots[slot].trend) {
+            auto packets = static_cast<double>(trend.feedbackPackets);
+            csv << team << "," << slot % MAX_ROBOT_ID << "," << minute * 60 << "," << trend.feedbackPackets << "," << trend.rssiSum / packets << "," << trend.batterySum / packets << "\n";
+        }
+    }
+}
+
+// Directories are searched for .rembin files. Files that cannot be accessed are skipped
+std::vector<std::string> collectLogFiles(const std::vector<std::string>& paths) {
+    std::vector<std::pair<std::uintmax_t, std::string>> sizedFiles;
+    auto addFile = [&](const std::filesystem::path& file) {
+        std::error_code error;
+        auto size = std::filesystem::file_size(file, error);
+        if (error) {
+            std::cerr << "Skipping " << file.string() << ": " << error.message() << std::endl;
+            return;
+        }
+        sizedFiles.emplace_back(size, file.string());
+    };
+
+    for (const auto& path : paths) {
+        std::error_code error;
+        if (!std::filesystem::is_directory(path, error)) {
+            addFile(path);
+            continue;
+        }
+        for (std::filesystem::recursive_directory_iterator it(path, error), end; !error && it != end; it.increment(error)) {
+            if (it->is_regular_file(error) && it->path().extension() == ".rembin") addFile(it->path());
+        }
+        if (error) std::cerr << "Stopped searching " << path << ": " << error.message() << std::endl;
+    }
+
+    // Biggest files first, so no thread ends up analyzing one big file after all others are done
+    std::sort(sizedFiles.begin(), sizedFiles.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    std::vector<std::string> files;
+    files.reserve(sizedFiles.size());
+    for (auto& [size, file] : sizedFiles) files.push_back(std::move(file));
+    return files;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> paths;
+    std::map<std::string, std::string> options;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument.starts_with("-") && i + 1 < argc) {
+            options[argument] = argv[++i];
+        } else {
+            paths.emplace_back(argument);
+        }
+    }
+
+    if (paths.empty()) {
+        std::cout << "Usage: " << argv[0] << " [-threads n] [-csv file] [-trend-csv file] [-team yellow|blue] [-robot id] [-from unix_s] [-to unix_s] <.rembin files or directories>"
+                  << std::endl;
+        return 1;
+    }
+
+    // Only blocks that can match the filters are decompressed
+    RembinQuery query;
+    if (options.contains("-team")) {
+        if (options["-team"] == "blue") {
+            query.team = rtt::Team::BLUE;
+        } else if (options["-team"] == "yellow") {
+            query.team = rtt::Team::YELLOW;
+        } else {
+            std::cerr << "Error: -team must be yellow or blue, not " << options["-team"] << std::endl;
+            return 1;
+        }
+    }
+    if (options.contains("-robot")) query.robotId = std::stoi(options["-robot"]);
+    if (options.contains("-from")) query.fromTimestampUs = std::stoull(options["-from"]) * 1000000;
+    if (options.contains("-to")) query.toTimestampUs = std::stoull(options["-to"]) * 1000000;
+
+    auto files = collectLogFiles(paths);
+    int amountOfThreads = options.contains("-threads") ? std::stoi(options["-threads"]) : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    amountOfThreads = std::clamp(amountOfThreads, 1, static_cast<int>(std::max<std::size_t>(1, files.size())));
+
+    auto start = std::chrono::steady_clock::now();
+    auto analysis = analyzeFiles(files, query, amountOfThreads);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printAnalysis(*analysis);
+    std::printf("\nAnalyzed %lu records in %lu files (%.1f MB) on %d threads in %.2f s", analysis->records, analysis->files, static_cast<double>(analysis->bytes) / 1e6, amountOfThreads,
+                seconds);
+    if (analysis->unreadableFiles > 0) std::printf(", %lu files could not be read", analysis->unreadableFiles);
+    std::printf("\n");
+
+    if (options.contains("-csv")) writeRobotsCsv(*analysis, options["-csv"]);
+    if (options.contains("-trend-csv")) writeTrendCsv(*analysis, options["-trend-csv"]);
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <benchmark/benchmark.h>
+#include <REM_BaseTypes.h>
+#include <REM_Log.h>
+#include <REM_RobotFeedback.h>
+#include <REM_RobotStateInfo.h>
+
+#include <basestation/BasestationManager.hpp>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "BenchmarkAllocations.hpp"
+
+using namespace rtt::robothub::basestation;
+
+// Stand-in basestations decode injected packets exactly like packets from usb
+static std::unique_ptr<BasestationManager> createDecodingManager() {
+    auto manager = std::make_unique<BasestationManager>(BasestationManagerConfiguration{.useStandInBasestations = true});
+    manager->setFeedbackCallback([](const REM_RobotFeedback& feedback, rtt::Team) { benchmark::DoNotOptimize(&feedback); });
+    manager->setRobotStateInfoCallback([](const REM_RobotStateInfo& stateInfo, rtt::Team) { benchmark::DoNotOptimize(&stateInfo); });
+    manager->setBasestationLogCallback([](const std::string& log, rtt::Team) { benchmark::DoNotOptimize(log.data()); });
+    return manager;
+}
+
+static std::vector<uint8_t> createFeedbackPacket() {
+    REM_RobotFeedback feedback = {};
+    feedback.header = REM_PACKET_TYPE_REM_ROBOT_FEEDBACK;
+    feedback.remVersion = REM_LOCAL_VERSION;
+    feedback.payloadSize = REM_PACKET_SIZE_REM_ROBOT_FEEDBACK;
+    feedback.fromRobotId = 5;
+    feedback.theta = 1.2f;
+    feedback.rho = 0.8f;
+    feedback.angle = -0.4f;
+    feedback.batteryLevel = 23;
+    feedback.rssi = 40;
+
+    REM_RobotFeedbackPayload payload;
+    encodeREM_RobotFeedback(&payload, &feedback);
+    return {payload.payload, payload.payload + REM_PACKET_SIZE_REM_ROBOT_FEEDBACK};
+}
+
+static std::vector<uint8_t> createStateInfoPacket() {
+    REM_RobotStateInfo stateInfo = {};
+    stateInfo.header = REM_PACKET_TYPE_REM_ROBOT_STATE_INFO;
+    stateInfo.remVersion = REM_LOCAL_VERSION;
+    stateInfo.payloadSize = REM_PACKET_SIZE_REM_ROBOT_STATE_INFO;
+    stateInfo.fromRobotId = 5;
+
+    REM_RobotStateInfoPayload payload;
+    encodeREM_RobotStateInfo(&payload, &stateInfo);
+    return {payload.payload, payload.payload + REM_PACKET_SIZE_REM_ROBOT_STATE_INFO};
+}
+
+static std::vector<uint8_t> createLogPacket(const std::string& message) {
+    REM_Log log = {};
+    log.header = REM_PACKET_TYPE_REM_LOG;
+    log.remVersion = REM_LOCAL_VERSION;
+    log.payloadSize = REM_PACKET_SIZE_REM_LOG + message.size();
+
+    REM_LogPayload payload;
+    encodeREM_Log(&payload, &log);
+    std::vector<uint8_t> packet(payload.payload, payload.payload + REM_PACKET_SIZE_REM_LOG);
+    packet.insert(packet.end(), message.begin(), message.end());
+    return packet;
+}
+
+static void decodePacket(benchmark::State& state, const std::vector<uint8_t>& packet) {
+    auto manager = createDecodingManager();
+
+    auto allocationsBefore = getAmountOfAllocations();
+    for (auto _ : state) {
+        manager->injectIncomingPacket(packet.data(), packet.size(), rtt::Team::BLUE);
+    }
+    reportAllocations(state, allocationsBefore);
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void decodeRobotFeedback(benchmark::State& state) { decodePacket(state, createFeedbackPacket()); }
+BENCHMARK(decodeRobotFeedback);
+
+static void decodeRobotStateInfo(benchmark::State& state) { decodePacket(state, createStateInfoPacket()); }
+BENCHMARK(decodeRobotStateInfo);
+
+static void decodeBasestationLog(benchmark::State& state) { decodePacket(state, createLogPacket("Robot 5 booted with firmware of 2024-03-01\n")); }
+BENCHMARK(decodeBasestationLog);
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+// Amount of heap allocations the whole process did so far. Counted by the operator new of BenchmarkMain.cpp
+uint64_t getAmountOfAllocations();
+
+// Reports the allocations since the given amount as allocations per iteration
+inline void reportAllocations(benchmark::State& state, uint64_t allocationsBefore) {
+    state.counters["allocs/op"] = benchmark::Counter(static_cast<double>(getAmountOfAllocations() - allocationsBefore), benchmark::Counter::kAvgIterations);
+}
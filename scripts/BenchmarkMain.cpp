@@ -0,0 +1,42 @@
+#include "BenchmarkAllocations.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Every allocation of the process goes through these operators, so the benchmarks can report allocations per operation
+static std::atomic<uint64_t> amountOfAllocations = 0;
+
+uint64_t getAmountOfAllocations() { return amountOfAllocations.load(std::memory_order_relaxed); }
+
+static void* allocate(std::size_t size) {
+    amountOfAllocations.fetch_add(1, std::memory_order_relaxed);
+    void* memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr) throw std::bad_alloc();
+    return memory;
+}
+
+static void* allocateAligned(std::size_t size, std::align_val_t alignment) {
+    amountOfAllocations.fetch_add(1, std::memory_order_relaxed);
+    auto alignmentBytes = static_cast<std::size_t>(alignment);
+    // aligned_alloc needs the size to be a multiple of the alignment
+    void* memory = std::aligned_alloc(alignmentBytes, (size + alignmentBytes - 1) / alignmentBytes * alignmentBytes);
+    if (memory == nullptr) throw std::bad_alloc();
+    return memory;
+}
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+
+BENCHMARK_MAIN();
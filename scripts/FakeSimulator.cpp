@@ -0,0 +1,81 @@
+#include <simulation/FakeSimulator.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace rtt::robothub::simulation;
+
+constexpr int DEFAULT_AMOUNT_OF_INSTANCES = 1;
+constexpr int DEFAULT_AMOUNT_OF_THREADS = 1;
+constexpr int PORTS_PER_INSTANCE = 10;  // Instance i listens on base + 10 * i, and the two ports after that
+
+std::atomic<bool> shouldStop = false;
+
+int getArgument(int argc, char* argv[], const std::string& name, int defaultValue) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (argv[i] == name) return std::stoi(argv[i + 1]);
+    }
+    return defaultValue;
+}
+
+int main(int argc, char* argv[]) {
+    int amountOfInstances = std::max(1, getArgument(argc, argv, "-instances", DEFAULT_AMOUNT_OF_INSTANCES));
+    int amountOfThreads = std::max(1, getArgument(argc, argv, "-threads", DEFAULT_AMOUNT_OF_THREADS));
+    int basePort = getArgument(argc, argv, "-port", DEFAULT_CONFIGURATION_PORT);
+    int durationS = getArgument(argc, argv, "-seconds", 0);  // 0 runs until interrupted
+
+    // Probabilities are given in percent
+    FakeSimulatorConfiguration config;
+    config.ballContactProbability = getArgument(argc, argv, "-ball-contact", 0) / 100.0;
+    config.errorProbability = getArgument(argc, argv, "-errors", 0) / 100.0;
+    config.responseDelay = std::chrono::microseconds(getArgument(argc, argv, "-delay-us", 0));
+    config.seed = static_cast<uint64_t>(getArgument(argc, argv, "-seed", 0));
+
+    auto pool = std::make_shared<SimulatorIOPool>(amountOfThreads);
+    std::vector<std::unique_ptr<FakeSimulator>> simulators;
+    try {
+        for (int i = 0; i < amountOfInstances; ++i) {
+            config.configurationPort = basePort + PORTS_PER_INSTANCE * i;
+            config.blueControlPort = config.configurationPort + 1;
+            config.yellowControlPort = config.configurationPort + 2;
+            config.seed++;
+            simulators.push_back(std::make_unique<FakeSimulator>(config, pool));
+            std::cout << "Fake simulator " << i << " listens on " << config.configurationPort << " (configuration), " << config.blueControlPort << " (blue) and "
+                      << config.yellowControlPort << " (yellow)" << std::endl;
+        }
+    } catch (const FailedToBindPortException& e) {
+        std::cout << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+
+    std::signal(SIGINT, [](int) { shouldStop = true; });
+    std::signal(SIGTERM, [](int) { shouldStop = true; });
+
+    std::vector<FakeSimulatorStatistics> previous(simulators.size());
+    for (int second = 0; !shouldStop && (durationS <= 0 || second < durationS); ++second) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+
+        uint64_t robotControls = 0;
+        uint64_t configurations = 0;
+        uint64_t errors = 0;
+        for (std::size_t i = 0; i < simulators.size(); ++i) {
+            auto statistics = simulators[i]->getStatistics();
+            robotControls += statistics.robotControlPackets - previous[i].robotControlPackets;
+            configurations += statistics.configurationPackets - previous[i].configurationPackets;
+            errors += statistics.errorsSent - previous[i].errorsSent;
+            previous[i] = statistics;
+        }
+        std::printf("%8lu robot controls/s %6lu configurations/s %6lu errors/s over %zu instances\n", robotControls, configurations, errors, simulators.size());
+        std::fflush(stdout);
+    }
+
+    return 0;
+}
@@ -0,0 +1,295 @@
+#include <RobotCommandsNetworker.hpp>
+#include <RobotFeedbackNetworker.hpp>
+#include <SettingsNetworker.hpp>
+#include <SharedCommandRing.hpp>
+#include <roboteam_utils/Teams.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace rtt;
+
+constexpr int MAX_AMOUNT_OF_ROBOTS = 16;
+constexpr int MAX_RATE_HZ = 1000;
+constexpr int DEFAULT_RATE_HZ = 60;
+constexpr int DEFAULT_AMOUNT_OF_ROBOTS = 11;
+constexpr int DEFAULT_DURATION_S = 10;
+constexpr int SETTINGS_TRANSMISSION_INTERVAL_MS = 1000;
+constexpr std::chrono::milliseconds FEEDBACK_TIMEOUT(250);  // After this time, we assume no feedback will come for a command
+constexpr std::size_t MAX_OUTSTANDING_COMMANDS = 1024;      // Per robot, bounds the memory if the hub does not respond at all
+
+/*  Correlates feedback with the commands that caused it. Neither commands nor feedback carry sequence numbers,
+    but feedback of a robot arrives in the order its commands were sent, so feedback of a robot is matched to the
+    oldest outstanding command of that robot. Commands that got no feedback within the timeout are counted as dropped.
+    In simulator mode every command set is answered with feedback of all its robots, in basestation mode every robot
+    answers on its own, so matching per robot works for both. */
+class FeedbackCorrelator {
+   public:
+    typedef struct Statistics {
+        int commandsSent = 0;       // Robot commands, so a command set of 11 robots counts as 11
+        int feedbackReceived = 0;   // Robot feedback, including feedback that matched no command
+        int feedbackMatched = 0;
+        int dropped = 0;
+        std::vector<double> latenciesUs;
+    } Statistics;
+
+    void onCommandsSent(Team team, int amountOfRobots) {
+        auto now = std::chrono::steady_clock::now();
+        std::scoped_lock<std::mutex> lock(this->robotsMutex);
+        auto& statistics = this->getStatistics(team);
+
+        for (int id = 0; id < amountOfRobots; ++id) {
+            auto& outstanding = this->getOutstandingCommands(team, id);
+            this->forgetTimedOutCommands(outstanding, statistics, now);
+            if (outstanding.size() >= MAX_OUTSTANDING_COMMANDS) {
+                outstanding.pop_front();
+                statistics.dropped++;
+            }
+            outstanding.push_back(now);
+        }
+        statistics.commandsSent += amountOfRobots;
+    }
+
+    void onFeedbackReceived(const RobotsFeedback& feedback) {
+        auto now = std::chrono::steady_clock::now();
+        std::scoped_lock<std::mutex> lock(this->robotsMutex);
+        auto& statistics = this->getStatistics(feedback.team);
+
+        for (const auto& robotFeedback : feedback.feedback) {
+            statistics.feedbackReceived++;
+            if (robotFeedback.id < 0 || robotFeedback.id >= MAX_AMOUNT_OF_ROBOTS) continue;
+
+            auto& outstanding = this->getOutstandingCommands(feedback.team, robotFeedback.id);
+            this->forgetTimedOutCommands(outstanding, statistics, now);
+            if (outstanding.empty()) continue;
+
+            statistics.latenciesUs.push_back(std::chrono::duration<double, std::micro>(now - outstanding.front()).count());
+            statistics.feedbackMatched++;
+            outstanding.pop_front();
+        }
+    }
+
+    // Returns the statistics since the previous call, and starts a new interval
+    Statistics takeStatistics(Team team) {
+        auto now = std::chrono::steady_clock::now();
+        std::scoped_lock<std::mutex> lock(this->robotsMutex);
+        auto& statistics = this->getStatistics(team);
+
+        for (int id = 0; id < MAX_AMOUNT_OF_ROBOTS; ++id) this->forgetTimedOutCommands(this->getOutstandingCommands(team, id), statistics, now);
+
+        Statistics taken = std::move(statistics);
+        statistics = Statistics();
+        return taken;
+    }
+
+    // Counts every command that is still outstanding as dropped, for at the end of a run
+    void dropOutstandingCommands() {
+        std::scoped_lock<std::mutex> lock(this->robotsMutex);
+        for (auto team : {Team::YELLOW, Team::BLUE}) {
+            for (int id = 0; id < MAX_AMOUNT_OF_ROBOTS; ++id) {
+                auto& outstanding = this->getOutstandingCommands(team, id);
+                this->getStatistics(team).dropped += static_cast<int>(outstanding.size());
+                outstanding.clear();
+            }
+        }
+    }
+
+   private:
+    typedef std::deque<std::chrono::steady_clock::time_point> OutstandingCommands;
+
+    std::mutex robotsMutex;  // Guards everything below
+    std::array<OutstandingCommands, MAX_AMOUNT_OF_ROBOTS> yellowOutstanding;
+    std::array<OutstandingCommands, MAX_AMOUNT_OF_ROBOTS> blueOutstanding;
+    Statistics yellowStatistics;
+    Statistics blueStatistics;
+
+    OutstandingCommands& getOutstandingCommands(Team team, int id) { return team == Team::YELLOW ? this->yellowOutstanding[id] : this->blueOutstanding[id]; }
+    Statistics& getStatistics(Team team) { return team == Team::YELLOW ? this->yellowStatistics : this->blueStatistics; }
+
+    static void forgetTimedOutCommands(OutstandingCommands& outstanding, Statistics& statistics, std::chrono::steady_clock::time_point now) {
+        while (!outstanding.empty() && now - outstanding.front() > FEEDBACK_TIMEOUT) {
+            outstanding.pop_front();
+            statistics.dropped++;
+        }
+    }
+};
+
+typedef struct RunTotals {
+    int commandsSent = 0;
+    int feedbackReceived = 0;
+    int feedbackMatched = 0;
+    int dropped = 0;
+    std::vector<double> latenciesUs;
+} RunTotals;
+
+FeedbackCorrelator correlator;
+std::atomic<bool> shouldSendCommands = true;
+
+double getPercentile(const std::vector<double>& sortedValues, double percentile) {
+    if (sortedValues.empty()) return 0;
+    auto index = static_cast<std::size_t>(percentile * static_cast<double>(sortedValues.size() - 1));
+    return sortedValues[index];
+}
+
+RobotCommands createCommands(int amountOfRobots, double timeS) {
+    RobotCommands commands;
+    for (int id = 0; id < amountOfRobots; ++id) {
+        RobotCommand command = {};
+        command.id = id;
+        command.velocity = Vector2(0.5 * std::sin(timeS + id), 0.5 * std::cos(timeS + id));
+        command.targetAngle = Angle(timeS);
+        commands.push_back(command);
+    }
+    return commands;
+}
+
+// Publishes command sets of one team at a fixed rate. Sleeping until an absolute time keeps the rate exact, even if publishing takes a while
+void runCommandSending(Team team, int rateHz, int amountOfRobots, bool useSharedCommands) {
+    std::unique_ptr<net::RobotCommandsYellowPublisher> yellowPublisher;
+    std::unique_ptr<net::RobotCommandsBluePublisher> bluePublisher;
+    std::unique_ptr<robothub::SharedCommandRingWriter> sharedCommandWriter;
+    if (useSharedCommands)
+        sharedCommandWriter = std::make_unique<robothub::SharedCommandRingWriter>(team == Team::YELLOW ? robothub::DEFAULT_SHARED_YELLOW_COMMANDS_NAME
+                                                                                                        : robothub::DEFAULT_SHARED_BLUE_COMMANDS_NAME);
+    else if (team == Team::YELLOW)
+        yellowPublisher = std::make_unique<net::RobotCommandsYellowPublisher>();
+    else
+        bluePublisher = std::make_unique<net::RobotCommandsBluePublisher>();
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto interval = std::chrono::nanoseconds(1000000000 / rateHz);
+    auto nextSend = start;
+
+    while (shouldSendCommands) {
+        auto commands = createCommands(amountOfRobots, std::chrono::duration<double>(nextSend - start).count());
+
+        // Registered before publishing, as the feedback could otherwise arrive before the commands are known
+        correlator.onCommandsSent(team, amountOfRobots);
+        if (sharedCommandWriter != nullptr)
+            sharedCommandWriter->write(commands);  // A full ring shows up as dropped feedback
+        else if (yellowPublisher != nullptr)
+            yellowPublisher->publish(commands);
+        else
+            bluePublisher->publish(commands);
+
+        nextSend += interval;
+        std::this_thread::sleep_until(nextSend);
+    }
+}
+
+void runSettingsSending(bool basestationMode) {
+    auto settingsPublisher = net::SettingsPublisher();
+
+    while (shouldSendCommands) {
+        proto::Setting settings;
+        settings.set_serialmode(basestationMode);
+        settingsPublisher.publish(settings);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(SETTINGS_TRANSMISSION_INTERVAL_MS));
+    }
+}
+
+void addToTotals(RunTotals& totals, FeedbackCorrelator::Statistics& statistics) {
+    totals.commandsSent += statistics.commandsSent;
+    totals.feedbackReceived += statistics.feedbackReceived;
+    totals.feedbackMatched += statistics.feedbackMatched;
+    totals.dropped += statistics.dropped;
+    totals.latenciesUs.insert(totals.latenciesUs.end(), statistics.latenciesUs.begin(), statistics.latenciesUs.end());
+}
+
+void printStatistics(const std::string& name, int commandsSent, int feedbackReceived, int feedbackMatched, int dropped, std::vector<double>& latenciesUs, double seconds) {
+    std::sort(latenciesUs.begin(), latenciesUs.end());
+    double dropPercentage = feedbackMatched + dropped > 0 ? 100.0 * dropped / (feedbackMatched + dropped) : 0;
+
+    std::printf("%-8s %9.0f cmd/s %9.0f fb/s  drop %6.2f%%   p50 %7.0f   p99 %7.0f   p99.9 %7.0f   max %7.0f us\n", name.c_str(), commandsSent / seconds,
+                feedbackReceived / seconds, dropPercentage, getPercentile(latenciesUs, 0.5), getPercentile(latenciesUs, 0.99), getPercentile(latenciesUs, 0.999),
+                latenciesUs.empty() ? 0 : latenciesUs.back());
+}
+
+bool hasFlag(int argc, char* argv[], const std::string& name) {
+    for (int i = 1; i < argc; ++i) {
+        if (argv[i] == name) return true;
+    }
+    return false;
+}
+
+std::string getArgument(int argc, char* argv[], const std::string& name, const std::string& defaultValue) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (argv[i] == name) return argv[i + 1];
+    }
+    return defaultValue;
+}
+
+int getArgument(int argc, char* argv[], const std::string& name, int defaultValue) { return std::stoi(getArgument(argc, argv, name, std::to_string(defaultValue))); }
+
+int main(int argc, char* argv[]) {
+    int rateHz = std::clamp(getArgument(argc, argv, "-rate", DEFAULT_RATE_HZ), 1, MAX_RATE_HZ);
+    int amountOfRobots = std::clamp(getArgument(argc, argv, "-robots", DEFAULT_AMOUNT_OF_ROBOTS), 1, MAX_AMOUNT_OF_ROBOTS);
+    int durationS = std::max(1, getArgument(argc, argv, "-seconds", DEFAULT_DURATION_S));
+    std::string teams = getArgument(argc, argv, "-team", std::string("both"));
+    bool basestationMode = hasFlag(argc, argv, "-basestation");
+    bool useSharedCommands = hasFlag(argc, argv, "-shared-commands");  // RobotHub must run with -shared-commands as well
+
+    std::vector<Team> drivenTeams;
+    if (teams == "yellow" || teams == "both") drivenTeams.push_back(Team::YELLOW);
+    if (teams == "blue" || teams == "both") drivenTeams.push_back(Team::BLUE);
+    if (drivenTeams.empty()) {
+        std::cout << "Usage: " << argv[0] << " [-rate hz] [-robots n] [-seconds s] [-team yellow|blue|both] [-basestation] [-shared-commands]" << std::endl;
+        return -1;
+    }
+
+    std::cout << "Sending " << amountOfRobots << " robots of " << teams << " at " << rateHz << " Hz for " << durationS << " seconds to the "
+              << (basestationMode ? "basestations" : "simulator") << (useSharedCommands ? " through shared memory" : "") << ". Make sure RobotHub is running" << std::endl;
+
+    auto feedbackSubscriber = net::RobotFeedbackSubscriber([](const RobotsFeedback& feedback) { correlator.onFeedbackReceived(feedback); });
+
+    std::thread settingsTransmitter(runSettingsSending, basestationMode);
+    std::vector<std::thread> commandTransmitters;
+    for (auto team : drivenTeams) commandTransmitters.emplace_back(runCommandSending, team, rateHz, amountOfRobots, useSharedCommands);
+
+    std::array<RunTotals, 2> totals;
+    auto nextReport = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    for (int second = 0; second < durationS; ++second) {
+        std::this_thread::sleep_until(nextReport);
+        nextReport += std::chrono::seconds(1);
+
+        for (std::size_t i = 0; i < drivenTeams.size(); ++i) {
+            auto statistics = correlator.takeStatistics(drivenTeams[i]);
+            addToTotals(totals[i], statistics);
+            printStatistics(teamToString(drivenTeams[i]), statistics.commandsSent, statistics.feedbackReceived, statistics.feedbackMatched, statistics.dropped,
+                            statistics.latenciesUs, 1.0);
+        }
+    }
+
+    shouldSendCommands = false;
+    for (auto& transmitter : commandTransmitters) transmitter.join();
+    settingsTransmitter.join();
+
+    // Give the feedback of the last commands the chance to arrive before counting what is left as dropped
+    std::this_thread::sleep_for(FEEDBACK_TIMEOUT);
+    for (std::size_t i = 0; i < drivenTeams.size(); ++i) {
+        auto statistics = correlator.takeStatistics(drivenTeams[i]);
+        addToTotals(totals[i], statistics);
+    }
+    correlator.dropOutstandingCommands();
+    for (std::size_t i = 0; i < drivenTeams.size(); ++i) totals[i].dropped += correlator.takeStatistics(drivenTeams[i]).dropped;
+
+    std::cout << "Total over " << durationS << " seconds:" << std::endl;
+    for (std::size_t i = 0; i < drivenTeams.size(); ++i) {
+        auto& total = totals[i];
+        printStatistics(teamToString(drivenTeams[i]), total.commandsSent, total.feedbackReceived, total.feedbackMatched, total.dropped, total.latenciesUs, durationS);
+    }
+
+    return 0;
+}
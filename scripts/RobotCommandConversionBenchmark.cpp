@@ -0,0 +1,66 @@
+#include <benchmark/benchmark.h>
+#include <basestation/RobotCommandBatch.hpp>
+
+#include "BenchmarkAllocations.hpp"
+
+#include <roboteam_utils/RobotCommands.hpp>
+#include <roboteam_utils/Teams.hpp>
+
+#include <vector>
+
+using namespace rtt::robothub::basestation;
+
+constexpr int AMOUNT_OF_ROBOTS = 16;
+
+rtt::RobotCommands createCommands(int amount) {
+    rtt::RobotCommands commands;
+    for (int id = 0; id < amount; ++id) {
+        rtt::RobotCommand command;
+        command.id = id;
+        command.velocity = rtt::Vector2(0.1 * id - 0.8, 1.5 - 0.2 * id);
+        command.targetAngularVelocity = 0.3 * id;
+        command.useAngularVelocity = id % 2 == 0;
+        command.cameraAngleOfRobot = 0.2 * id;
+        command.cameraAngleOfRobotIsSet = true;
+        command.kickSpeed = id % 3 == 0 ? 4.0 : 0.0;
+        command.kickType = id % 2 == 0 ? rtt::KickType::KICK : rtt::KickType::CHIP;
+        command.dribblerSpeed = 0.5;
+        commands.push_back(command);
+    }
+    return commands;
+}
+
+// The way RobotHub converted commands before, one command at a time
+static void scalarConversion(benchmark::State& state) {
+    auto commands = createCommands(static_cast<int>(state.range(0)));
+    std::vector<REM_RobotCommandPayload> payloads(commands.size());
+
+    auto allocationsBefore = getAmountOfAllocations();
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < commands.size(); ++i) {
+            REM_RobotCommand command = toREM_RobotCommand(commands[i], rtt::Team::BLUE);
+            encodeREM_RobotCommand(&payloads[i], &command);
+        }
+        benchmark::DoNotOptimize(payloads.data());
+        benchmark::ClobberMemory();
+    }
+    reportAllocations(state, allocationsBefore);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(scalarConversion)->Arg(AMOUNT_OF_ROBOTS);
+
+static void batchConversion(benchmark::State& state) {
+    auto commands = createCommands(static_cast<int>(state.range(0)));
+    RobotCommandBatch batch;
+    batch.convert(commands, rtt::Team::BLUE);  // The first conversion allocates the buffers of the batch
+
+    auto allocationsBefore = getAmountOfAllocations();
+    for (auto _ : state) {
+        batch.convert(commands, rtt::Team::BLUE);
+        benchmark::DoNotOptimize(&batch.getPayload(0));
+        benchmark::ClobberMemory();
+    }
+    reportAllocations(state, allocationsBefore);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(batchConversion)->Arg(AMOUNT_OF_ROBOTS);
@@ -1,9 +1,13 @@
 #include <RobotFeedbackNetworker.hpp>
+#include <SharedFeedbackRing.hpp>
 
 #include <array>
 #include <utility>
 #include <chrono>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <thread>
 
 using namespace rtt;
 
@@ -91,11 +95,41 @@ void onFeedback(const rtt::RobotsFeedback& feedbacks) {
     if (updateCounter > 0) updateHappenedSincePrint = true;
 }
 
-int main() {
-    auto feedbackSub = net::RobotFeedbackSubscriber(onFeedback);
+int main(int argc, char* argv[]) {
+    // With -shared-feedback, feedback is read from the shared memory of a RobotHub on this machine instead of the network
+    std::unique_ptr<robothub::SharedFeedbackReader> sharedFeedback;
+    std::unique_ptr<net::RobotFeedbackSubscriber> feedbackSub;
+    if (argc > 1 && std::string(argv[1]) == "-shared-feedback") {
+        try {
+            sharedFeedback = std::make_unique<robothub::SharedFeedbackReader>();
+        } catch (const robothub::FailedToOpenSharedMemoryException& e) {
+            std::cout << "Error: " << e.what() << std::endl;
+            return -1;
+        }
+    } else {
+        feedbackSub = std::make_unique<net::RobotFeedbackSubscriber>(onFeedback);
+    }
 
+    auto lastSharedFeedback = std::chrono::steady_clock::now();
     while (true) {
+        robothub::SharedRobotFeedback feedback;
+        while (sharedFeedback != nullptr && sharedFeedback->readNext(feedback)) {
+            onFeedback(robothub::fromSharedRobotFeedback(feedback));
+            lastSharedFeedback = std::chrono::steady_clock::now();
+        }
+
         auto now = std::chrono::steady_clock::now();
+        // When the feedback stops, RobotHub may have restarted with a new ring
+        if (sharedFeedback != nullptr && now - lastSharedFeedback > std::chrono::seconds(1)) {
+            lastSharedFeedback = now;
+            if (sharedFeedback->isReplaced()) {
+                try {
+                    sharedFeedback = std::make_unique<robothub::SharedFeedbackReader>();
+                } catch (const robothub::FailedToOpenSharedMemoryException& e) {
+                    std::cout << "Error: " << e.what() << std::endl;
+                }
+            }
+        }
         auto timeSinceLastPrint = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastTimePrintHappened).count();
 
         if (updateHappenedSincePrint || timeSinceLastPrint > 1000) {
@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+
+#include <simulation/RobotControlCommand.hpp>
+#include <simulation/SimulatorManager.hpp>
+
+#include "BenchmarkAllocations.hpp"
+
+using namespace rtt::robothub::simulation;
+
+constexpr int AMOUNT_OF_SIMULATED_ROBOTS = 16;
+
+// Ports nothing listens to, so sending does not disturb a simulator that happens to run
+constexpr int UNUSED_BLUE_CONTROL_PORT = 20401;
+constexpr int UNUSED_YELLOW_CONTROL_PORT = 20402;
+constexpr int UNUSED_CONFIGURATION_PORT = 20400;
+
+static RobotControlCommand createRobotControlCommand(int amountOfRobots) {
+    RobotControlCommand command;
+    for (int id = 0; id < amountOfRobots; ++id) {
+        command.addRobotControlWithLocalSpeeds(id, 0.0f, 0.0f, 0.5f, 1.0f + 0.1f * id, -0.5f, 0.3f * id);
+    }
+    return command;
+}
+
+static void buildRobotControlCommand(benchmark::State& state) {
+    auto allocationsBefore = getAmountOfAllocations();
+    for (auto _ : state) {
+        auto command = createRobotControlCommand(static_cast<int>(state.range(0)));
+        benchmark::DoNotOptimize(&command.getPacket());
+    }
+    reportAllocations(state, allocationsBefore);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(buildRobotControlCommand)->Arg(AMOUNT_OF_SIMULATED_ROBOTS);
+
+static void serializeRobotControlCommand(benchmark::State& state) {
+    auto command = createRobotControlCommand(static_cast<int>(state.range(0)));
+
+    auto allocationsBefore = getAmountOfAllocations();
+    for (auto _ : state) {
+        QByteArray datagram = SimulatorManager::serializePacket(command.getPacket());
+        benchmark::DoNotOptimize(datagram.data());
+    }
+    reportAllocations(state, allocationsBefore);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(serializeRobotControlCommand)->Arg(AMOUNT_OF_SIMULATED_ROBOTS);
+
+// Building, serializing and sending, which is what RobotHub does for every set of commands
+static void sendRobotControlCommand(benchmark::State& state) {
+    SimulatorNetworkConfiguration configuration = {.blueControlPort = UNUSED_BLUE_CONTROL_PORT,
+                                                   .yellowControlPort = UNUSED_YELLOW_CONTROL_PORT,
+                                                   .configurationPort = UNUSED_CONFIGURATION_PORT,
+                                                   .blueFeedbackPort = UNUSED_BLUE_CONTROL_PORT + 100,
+                                                   .yellowFeedbackPort = UNUSED_YELLOW_CONTROL_PORT + 100,
+                                                   .configurationFeedbackPort = UNUSED_CONFIGURATION_PORT + 100};
+    SimulatorManager manager(configuration);
+
+    auto allocationsBefore = getAmountOfAllocations();
+    for (auto _ : state) {
+        auto command = createRobotControlCommand(static_cast<int>(state.range(0)));
+        benchmark::DoNotOptimize(manager.sendRobotControlCommand(command, rtt::Team::BLUE));
+    }
+    reportAllocations(state, allocationsBefore);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(sendRobotControlCommand)->Arg(AMOUNT_OF_SIMULATED_ROBOTS);
+
+static void parseRobotControlResponse(benchmark::State& state) {
+    proto::simulation::RobotControlResponse response;
+    for (int id = 0; id < state.range(0); ++id) {
+        auto feedback = response.add_feedback();
+        feedback->set_id(id);
+        feedback->set_dribbler_ball_contact(id == 3);
+    }
+    QByteArray bytes;
+    bytes.resize(static_cast<int>(response.ByteSizeLong()));
+    response.SerializeToArray(bytes.data(), bytes.size());
+    QNetworkDatagram datagram(bytes);
+
+    auto allocationsBefore = getAmountOfAllocations();
+    for (auto _ : state) {
+        auto feedback = SimulatorManager::getControlFeedbackFromDatagram(datagram, rtt::Team::BLUE);
+        benchmark::DoNotOptimize(&feedback);
+    }
+    reportAllocations(state, allocationsBefore);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(parseRobotControlResponse)->Arg(AMOUNT_OF_SIMULATED_ROBOTS);
@@ -0,0 +1,108 @@
+#include <simulation/FakeSimulator.hpp>
+#include <simulation/SimulatorManager.hpp>
+
+#include <roboteam_utils/Teams.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace rtt::robothub::simulation;
+
+// Ports of the stand-in simulator, chosen to not collide with a real simulator on the default ports
+constexpr int STAND_IN_BLUE_CONTROL_PORT = 20301;
+constexpr int STAND_IN_YELLOW_CONTROL_PORT = 20302;
+constexpr int STAND_IN_CONFIGURATION_PORT = 20300;
+constexpr int DEFAULT_RATE_HZ = 100;
+constexpr int DEFAULT_AMOUNT_OF_ROBOTS = 11;
+constexpr int DEFAULT_DURATION_S = 10;
+
+void printRoundTrip(const RoundTripStatistics& roundTrip, const std::string& team) {
+    std::printf("%-6s %6d samples %4d lost   min %7.0f   p50 %7.0f   p99 %7.0f   max %7.0f us\n", team.c_str(), roundTrip.samples, roundTrip.lost, roundTrip.minUs, roundTrip.p50Us,
+                roundTrip.p99Us, roundTrip.maxUs);
+}
+
+int getArgument(int argc, char* argv[], const std::string& name, int defaultValue) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (argv[i] == name) return std::stoi(argv[i + 1]);
+    }
+    return defaultValue;
+}
+
+int main(int argc, char* argv[]) {
+    int rateHz = getArgument(argc, argv, "-rate", DEFAULT_RATE_HZ);
+    int amountOfRobots = getArgument(argc, argv, "-robots", DEFAULT_AMOUNT_OF_ROBOTS);
+    int durationS = getArgument(argc, argv, "-seconds", DEFAULT_DURATION_S);
+
+    // The manager sends from the sockets bound to its feedback ports, and the stand-in answers to the port a packet came from.
+    // So feedback arrives on the feedback ports below, which only have to differ from the ports the stand-in listens on
+    SimulatorNetworkConfiguration config = {.blueControlPort = STAND_IN_BLUE_CONTROL_PORT,
+                                            .yellowControlPort = STAND_IN_YELLOW_CONTROL_PORT,
+                                            .configurationPort = STAND_IN_CONFIGURATION_PORT,
+                                            .blueFeedbackPort = STAND_IN_BLUE_CONTROL_PORT + 1000,
+                                            .yellowFeedbackPort = STAND_IN_YELLOW_CONTROL_PORT + 1000,
+                                            .configurationFeedbackPort = STAND_IN_CONFIGURATION_PORT + 1000};
+
+    // Optionally make the link behave like our radio link. Loss and reordering are given in percent
+    int lossPercent = getArgument(argc, argv, "-loss", 0);
+    int latencyMs = getArgument(argc, argv, "-latency", 0);
+    int jitterMs = getArgument(argc, argv, "-jitter", 0);
+    int reorderPercent = getArgument(argc, argv, "-reorder", 0);
+    if (lossPercent > 0 || latencyMs > 0 || jitterMs > 0 || reorderPercent > 0) {
+        LinkImpairmentSettings settings = {.lossProbability = lossPercent / 100.0,
+                                           .latency = std::chrono::milliseconds(latencyMs),
+                                           .jitter = std::chrono::milliseconds(jitterMs),
+                                           .reorderProbability = reorderPercent / 100.0};
+        config.linkImpairment = SimulatorLinkImpairment{.blue = settings, .yellow = settings, .seed = static_cast<uint64_t>(getArgument(argc, argv, "-seed", 0))};
+    }
+
+    FakeSimulatorConfiguration standInConfig = {.blueControlPort = STAND_IN_BLUE_CONTROL_PORT,
+                                                .yellowControlPort = STAND_IN_YELLOW_CONTROL_PORT,
+                                                .configurationPort = STAND_IN_CONFIGURATION_PORT,
+                                                .ballContactProbability = getArgument(argc, argv, "-ball-contact", 0) / 100.0,
+                                                .errorProbability = getArgument(argc, argv, "-errors", 0) / 100.0,
+                                                .responseDelay = std::chrono::microseconds(getArgument(argc, argv, "-delay-us", 0))};
+
+    std::unique_ptr<FakeSimulator> standIn;
+    std::unique_ptr<SimulatorManager> manager;
+    try {
+        standIn = std::make_unique<FakeSimulator>(standInConfig);
+        manager = std::make_unique<SimulatorManager>(config);
+    } catch (const FailedToBindPortException& e) {
+        std::cout << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+
+    std::cout << "Sending " << amountOfRobots << " robots per team at " << rateHz << " Hz for " << durationS << " seconds" << std::endl;
+
+    const auto interval = std::chrono::microseconds(1000000 / std::max(1, rateHz));
+    auto nextSend = std::chrono::steady_clock::now();
+    auto nextReport = nextSend + std::chrono::seconds(1);
+
+    for (int second = 0; second < durationS;) {
+        RobotControlCommand command;
+        for (int id = 0; id < amountOfRobots; ++id) {
+            command.addRobotControlWithGlobalSpeeds(id, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.5f);
+        }
+        manager->sendRobotControlCommand(command, rtt::Team::BLUE);
+        manager->sendRobotControlCommand(command, rtt::Team::YELLOW);
+
+        nextSend += interval;
+        std::this_thread::sleep_until(nextSend);
+
+        if (std::chrono::steady_clock::now() >= nextReport) {
+            printRoundTrip(manager->takeRoundTripStatistics(rtt::Team::BLUE), "Blue");
+            printRoundTrip(manager->takeRoundTripStatistics(rtt::Team::YELLOW), "Yellow");
+            nextReport += std::chrono::seconds(1);
+            second++;
+        }
+    }
+
+    manager = nullptr;
+    standIn = nullptr;
+
+    return 0;
+}
@@ -0,0 +1,199 @@
+#include <EventLoop.hpp>
+#include <pthread.h>
+#include <roboteam_utils/Print.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+namespace rtt::robothub {
+
+constexpr int MAX_EVENTS_PER_WAIT = 32;
+constexpr uint64_t WAKE_EVENT_DATA = UINT64_MAX;  // Marks events of the wakeDescriptor, as source ids are never negative
+
+EventLoop::EventLoop(const std::string& name, std::optional<ThreadRole> role) : role(role), shouldRun(true), nextSourceId(0) {
+    this->epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+    if (this->epollDescriptor < 0) throw FailedToCreateEventLoopException("Failed to create epoll instance: " + std::string(std::strerror(errno)));
+
+    this->wakeDescriptor = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    epoll_event wakeEvent = {};
+    wakeEvent.events = EPOLLIN;
+    wakeEvent.data.u64 = WAKE_EVENT_DATA;
+    if (this->wakeDescriptor < 0 || epoll_ctl(this->epollDescriptor, EPOLL_CTL_ADD, this->wakeDescriptor, &wakeEvent) != 0) {
+        auto message = "Failed to create wake event: " + std::string(std::strerror(errno));
+        if (this->wakeDescriptor >= 0) close(this->wakeDescriptor);
+        close(this->epollDescriptor);
+        throw FailedToCreateEventLoopException(message);
+    }
+
+    this->thread = std::thread(&EventLoop::run, this, name);
+
+    // The probe does nothing, as waking up is all that is measured
+    if (this->role.has_value()) {
+        auto probeInterval = getJitterProbeInterval(this->role.value());
+        if (probeInterval.count() > 0) this->addTimer(probeInterval, [] {});
+    }
+}
+
+EventLoop::~EventLoop() {
+    this->shouldRun = false;
+    uint64_t wake = 1;
+    if (write(this->wakeDescriptor, &wake, sizeof(wake)) < 0) RTT_ERROR("Failed to wake event loop: ", std::strerror(errno))
+    if (this->thread.joinable()) this->thread.join();
+
+    this->sources.clear();  // Closes the timerfds
+    close(this->wakeDescriptor);
+    close(this->epollDescriptor);
+}
+
+int EventLoop::addFileDescriptor(int fileDescriptor, uint32_t events, const std::function<void()>& handler) {
+    return this->addSource(fileDescriptor, events, Source{.fileDescriptor = fileDescriptor, .isTimer = false, .isTimeout = false, .handler = handler});
+}
+
+int EventLoop::addTimer(std::chrono::nanoseconds interval, const std::function<void()>& handler) { return this->addTimerSource(interval, false, handler); }
+
+int EventLoop::addTimeout(std::chrono::nanoseconds delay, const std::function<void()>& handler) { return this->addTimerSource(delay, true, handler); }
+
+void EventLoop::remove(int sourceId) {
+    if (sourceId < 0) return;  // Failed to add, so there is nothing to wait for
+    this->unregister(sourceId);
+
+    // Wait for the handlers that are running, as one could be this source. Within a handler, nothing else runs
+    if (!this->isInLoopThread()) {
+        std::scoped_lock<std::mutex> lock(this->dispatchMutex);
+    }
+}
+
+void EventLoop::removeWithoutWaiting(int sourceId) {
+    if (sourceId >= 0) this->unregister(sourceId);
+}
+
+void EventLoop::unregister(int sourceId) {
+    std::shared_ptr<Source> source;
+    {
+        std::scoped_lock<std::mutex> lock(this->sourcesMutex);
+        auto iterator = this->sources.find(sourceId);
+        if (iterator == this->sources.end()) return;
+        source = iterator->second;
+        this->sources.erase(iterator);
+    }
+    epoll_ctl(this->epollDescriptor, EPOLL_CTL_DEL, source->fileDescriptor, nullptr);
+}
+
+int EventLoop::getAmountOfSources() const {
+    std::scoped_lock<std::mutex> lock(this->sourcesMutex);
+    return static_cast<int>(this->sources.size());
+}
+
+bool EventLoop::isInLoopThread() const { return std::this_thread::get_id() == this->thread.get_id(); }
+
+int EventLoop::addSource(int fileDescriptor, uint32_t events, const Source& source) {
+    std::scoped_lock<std::mutex> lock(this->sourcesMutex);
+    int sourceId = this->nextSourceId++;
+
+    epoll_event event = {};
+    event.events = events;
+    event.data.u64 = static_cast<uint64_t>(sourceId);
+    if (epoll_ctl(this->epollDescriptor, EPOLL_CTL_ADD, fileDescriptor, &event) != 0) {
+        RTT_ERROR("Failed to watch file descriptor ", fileDescriptor, ": ", std::strerror(errno))
+        return -1;
+    }
+
+    // The timerfd is only closed once no dispatch uses the source anymore, so a dispatch never reads a closed or reused descriptor
+    this->sources[sourceId] = std::shared_ptr<Source>(new Source(source), [](Source* ownedSource) {
+        if (ownedSource->isTimer) close(ownedSource->fileDescriptor);
+        delete ownedSource;
+    });
+    return sourceId;
+}
+
+int EventLoop::addTimerSource(std::chrono::nanoseconds interval, bool isTimeout, const std::function<void()>& handler) {
+    int timerDescriptor = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timerDescriptor < 0) {
+        RTT_ERROR("Failed to create timer: ", std::strerror(errno))
+        return -1;
+    }
+
+    // A zero expiration would disarm the timer, so expire as soon as possible instead
+    auto nanoseconds = std::max<int64_t>(interval.count(), 1);
+    timespec period = {.tv_sec = nanoseconds / 1000000000, .tv_nsec = nanoseconds % 1000000000};
+    itimerspec specification = {.it_interval = isTimeout ? timespec{0, 0} : period, .it_value = period};
+    auto firstExpiration = std::chrono::steady_clock::now() + std::chrono::nanoseconds(nanoseconds);
+    timerfd_settime(timerDescriptor, 0, &specification, nullptr);
+
+    int sourceId = this->addSource(timerDescriptor, EPOLLIN,
+                                   Source{.fileDescriptor = timerDescriptor,
+                                          .isTimer = true,
+                                          .isTimeout = isTimeout,
+                                          .handler = handler,
+                                          .interval = std::chrono::nanoseconds(nanoseconds),
+                                          .nextExpiration = firstExpiration});
+    if (sourceId < 0) close(timerDescriptor);
+    return sourceId;
+}
+
+void EventLoop::run(const std::string& name) {
+    // Thread names are limited to 15 characters
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+    if (this->role.has_value()) tuneCurrentThread(this->role.value());
+
+    std::array<epoll_event, MAX_EVENTS_PER_WAIT> events = {};
+    while (this->shouldRun) {
+        int amountOfEvents = epoll_wait(this->epollDescriptor, events.data(), MAX_EVENTS_PER_WAIT, -1);
+        if (amountOfEvents < 0) {
+            if (errno == EINTR) continue;
+            RTT_ERROR("Event loop ", name, " stopped: ", std::strerror(errno))
+            return;
+        }
+
+        std::scoped_lock<std::mutex> lock(this->dispatchMutex);
+        for (int i = 0; i < amountOfEvents; ++i) {
+            if (events[i].data.u64 == WAKE_EVENT_DATA) {
+                uint64_t wakes;
+                if (read(this->wakeDescriptor, &wakes, sizeof(wakes)) < 0) RTT_ERROR("Failed to clear the wake event: ", std::strerror(errno))
+                continue;
+            }
+            this->dispatch(static_cast<int>(events[i].data.u64));
+        }
+    }
+}
+
+void EventLoop::dispatch(int sourceId) {
+    // An earlier handler of this batch could have removed the source
+    std::shared_ptr<Source> source;
+    {
+        std::scoped_lock<std::mutex> lock(this->sourcesMutex);
+        auto iterator = this->sources.find(sourceId);
+        if (iterator == this->sources.end()) return;
+        source = iterator->second;
+        if (source->isTimeout) this->sources.erase(iterator);
+    }
+
+    if (source->isTimer) {
+        // Fails when the timer did not expire after all. A timeout is already removed, so it has to run now
+        uint64_t expirations;
+        if (read(source->fileDescriptor, &expirations, sizeof(expirations)) < 0) {
+            if (!source->isTimeout) return;
+            expirations = 1;
+        }
+
+        // Only this thread touches the expiration, and the latest expiration is the one we woke up for
+        auto expiredAt = source->nextExpiration + (static_cast<int64_t>(expirations) - 1) * source->interval;
+        source->nextExpiration = expiredAt + source->interval;
+        if (this->role.has_value()) recordSchedulerJitter(this->role.value(), std::chrono::steady_clock::now() - expiredAt);
+    }
+
+    source->handler();
+
+    // The timerfd of the timeout is closed once the source is destroyed, when this is the last dispatch using it
+    if (source->isTimeout) epoll_ctl(this->epollDescriptor, EPOLL_CTL_DEL, source->fileDescriptor, nullptr);
+}
+
+FailedToCreateEventLoopException::FailedToCreateEventLoopException(const std::string& message) : message(message) {}
+const char* FailedToCreateEventLoopException::what() const noexcept { return this->message.c_str(); }
+
+}  // namespace rtt::robothub
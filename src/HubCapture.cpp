@@ -0,0 +1,132 @@
+#include <HubCapture.hpp>
+#include <Rembin.hpp>
+#include <bit>
+#include <cstring>
+#include <vector>
+
+namespace rtt::robothub {
+
+// Bytes of a serialized robot command: int32 id, 7 doubles and 6 flags
+constexpr std::size_t SERIALIZED_ROBOT_COMMAND_SIZE = 4 + 7 * 8 + 6;
+
+static void appendDouble(std::vector<uint8_t>& buffer, double value) { appendLittleEndian(buffer, std::bit_cast<uint64_t>(value), 8); }
+
+static double readDouble(const uint8_t* data) { return std::bit_cast<double>(readLittleEndian(data, 8)); }
+
+HubCaptureWriter::HubCaptureWriter(const std::string& path) : file(path, std::ios::binary | std::ios::trunc) {
+    if (!this->file.is_open()) throw FailedToOpenCaptureException("Could not open capture file " + path);
+    this->start = std::chrono::steady_clock::now();
+
+    auto sinceEpoch = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch());
+    std::vector<uint8_t> header(std::begin(CAPTURE_MAGIC), std::end(CAPTURE_MAGIC));
+    appendLittleEndian(header, CAPTURE_FORMAT_VERSION, 2);
+    appendLittleEndian(header, CAPTURE_HEADER_SIZE, 2);
+    appendLittleEndian(header, 0, 4);
+    appendLittleEndian(header, sinceEpoch.count(), 8);
+    this->file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+}
+
+void HubCaptureWriter::captureRobotCommands(std::span<const rtt::RobotCommand> commands, rtt::Team color) {
+    this->writeInput(CaptureInputType::ROBOT_COMMANDS, color, serializeRobotCommands(commands));
+}
+
+void HubCaptureWriter::captureSettings(const proto::Setting& settings) { this->writeInput(CaptureInputType::SETTINGS, rtt::Team::YELLOW, settings.SerializeAsString()); }
+
+void HubCaptureWriter::captureSimulationConfiguration(const proto::SimulationConfiguration& configuration) {
+    this->writeInput(CaptureInputType::SIMULATION_CONFIGURATION, rtt::Team::YELLOW, configuration.SerializeAsString());
+}
+
+void HubCaptureWriter::captureBasestationPacket(const uint8_t* packet, std::size_t size, rtt::Team color) {
+    this->writeInput(CaptureInputType::BASESTATION_PACKET, color, std::string(reinterpret_cast<const char*>(packet), size));
+}
+
+void HubCaptureWriter::writeInput(CaptureInputType type, rtt::Team team, const std::string& payload) {
+    std::scoped_lock<PriorityInheritanceMutex> lock(this->fileMutex);
+
+    auto sinceStart = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - this->start);
+    std::vector<uint8_t> inputHeader;
+    appendLittleEndian(inputHeader, sinceStart.count(), 8);
+    appendLittleEndian(inputHeader, static_cast<uint8_t>(type), 1);
+    appendLittleEndian(inputHeader, team == rtt::Team::BLUE ? 1 : 0, 1);
+    appendLittleEndian(inputHeader, payload.size(), 4);
+
+    this->file.write(reinterpret_cast<const char*>(inputHeader.data()), static_cast<std::streamsize>(inputHeader.size()));
+    this->file.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+}
+
+HubCaptureReader::HubCaptureReader(const std::string& path) : file(path, std::ios::binary) {
+    uint8_t header[CAPTURE_HEADER_SIZE];
+    if (!this->file.is_open() || !this->file.read(reinterpret_cast<char*>(header), CAPTURE_HEADER_SIZE)) {
+        throw FailedToOpenCaptureException("Could not read capture file " + path);
+    }
+    if (std::memcmp(header, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0 || readLittleEndian(header + 8, 2) != CAPTURE_FORMAT_VERSION) {
+        throw FailedToOpenCaptureException(path + " is not a capture of format version " + std::to_string(CAPTURE_FORMAT_VERSION));
+    }
+    this->file.seekg(static_cast<std::streamoff>(readLittleEndian(header + 10, 2)));
+}
+
+bool HubCaptureReader::readNext(CapturedInput& input) {
+    uint8_t inputHeader[CAPTURE_INPUT_HEADER_SIZE];
+    if (!this->file.read(reinterpret_cast<char*>(inputHeader), CAPTURE_INPUT_HEADER_SIZE)) return false;
+
+    input.sinceStart = std::chrono::microseconds(readLittleEndian(inputHeader, 8));
+    input.type = static_cast<CaptureInputType>(inputHeader[8]);
+    input.team = inputHeader[9] == 1 ? rtt::Team::BLUE : rtt::Team::YELLOW;
+    input.payload.resize(readLittleEndian(inputHeader + 10, 4));
+
+    // A capture that was not closed properly can end halfway an input
+    return static_cast<bool>(this->file.read(input.payload.data(), static_cast<std::streamsize>(input.payload.size())));
+}
+
+std::string serializeRobotCommands(std::span<const rtt::RobotCommand> commands) {
+    std::vector<uint8_t> bytes;
+    bytes.reserve(commands.size() * SERIALIZED_ROBOT_COMMAND_SIZE);
+
+    for (const auto& command : commands) {
+        appendLittleEndian(bytes, static_cast<uint32_t>(command.id), 4);
+        appendDouble(bytes, command.velocity.x);
+        appendDouble(bytes, command.velocity.y);
+        appendDouble(bytes, command.targetAngle.getValue());
+        appendDouble(bytes, command.targetAngularVelocity);
+        appendDouble(bytes, command.cameraAngleOfRobot);
+        appendDouble(bytes, command.kickSpeed);
+        appendDouble(bytes, command.dribblerSpeed);
+        appendLittleEndian(bytes, command.useAngularVelocity, 1);
+        appendLittleEndian(bytes, command.cameraAngleOfRobotIsSet, 1);
+        appendLittleEndian(bytes, command.waitForBall, 1);
+        appendLittleEndian(bytes, static_cast<uint8_t>(command.kickType), 1);
+        appendLittleEndian(bytes, command.kickAtAngle, 1);
+        appendLittleEndian(bytes, command.ignorePacket, 1);
+    }
+    return {bytes.begin(), bytes.end()};
+}
+
+rtt::RobotCommands deserializeRobotCommands(const std::string& bytes) {
+    rtt::RobotCommands commands;
+    const auto* data = reinterpret_cast<const uint8_t*>(bytes.data());
+
+    for (std::size_t offset = 0; offset + SERIALIZED_ROBOT_COMMAND_SIZE <= bytes.size(); offset += SERIALIZED_ROBOT_COMMAND_SIZE) {
+        const uint8_t* serialized = data + offset;
+        rtt::RobotCommand command;
+        command.id = static_cast<int>(static_cast<int32_t>(readLittleEndian(serialized, 4)));
+        command.velocity = Vector2(readDouble(serialized + 4), readDouble(serialized + 12));
+        command.targetAngle = Angle(readDouble(serialized + 20));
+        command.targetAngularVelocity = readDouble(serialized + 28);
+        command.cameraAngleOfRobot = readDouble(serialized + 36);
+        command.kickSpeed = readDouble(serialized + 44);
+        command.dribblerSpeed = readDouble(serialized + 52);
+        command.useAngularVelocity = serialized[60] != 0;
+        command.cameraAngleOfRobotIsSet = serialized[61] != 0;
+        command.waitForBall = serialized[62] != 0;
+        command.kickType = static_cast<rtt::KickType>(serialized[63]);
+        command.kickAtAngle = serialized[64] != 0;
+        command.ignorePacket = serialized[65] != 0;
+        commands.push_back(command);
+    }
+    return commands;
+}
+
+FailedToOpenCaptureException::FailedToOpenCaptureException(const std::string& message) : message(message) {}
+const char* FailedToOpenCaptureException::what() const noexcept { return this->message.c_str(); }
+
+}  // namespace rtt::robothub
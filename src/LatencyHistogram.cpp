@@ -0,0 +1,79 @@
+#include <LatencyHistogram.hpp>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace rtt::robothub {
+
+constexpr double NANOSECONDS_PER_MICROSECOND = 1000.0;
+
+void LatencyHistogram::record(std::chrono::nanoseconds latency) {
+    auto nanoseconds = static_cast<uint64_t>(std::max<int64_t>(0, latency.count()));
+    this->buckets.increment(toBucket(nanoseconds));
+
+    uint64_t max = this->maxNanoseconds.load(std::memory_order_relaxed);
+    while (nanoseconds > max && !this->maxNanoseconds.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::record(std::chrono::time_point<std::chrono::steady_clock> start, std::chrono::time_point<std::chrono::steady_clock> end) {
+    this->record(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start));
+}
+
+LatencySummary LatencyHistogram::takeSummary() {
+    std::scoped_lock<std::mutex> lock(this->summaryMutex);
+
+    auto totals = this->buckets.read();
+    ShardedCounters<LATENCY_BUCKETS>::Values counts;
+    uint64_t samples = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; ++i) {
+        counts[i] = totals[i] - this->previousTotals[i];
+        samples += counts[i];
+    }
+    this->previousTotals = totals;
+    uint64_t max = this->maxNanoseconds.exchange(0, std::memory_order_relaxed);
+
+    LatencySummary summary;
+    summary.samples = samples;
+    if (samples == 0) return summary;
+
+    // The smallest latency that at least the given fraction of the samples is below
+    auto percentile = [&](double fraction) {
+        auto wanted = static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(samples)));
+        uint64_t seen = 0;
+        for (int i = 0; i < LATENCY_BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen >= wanted && counts[i] > 0) return static_cast<double>(getBucketUpperBound(i)) / NANOSECONDS_PER_MICROSECOND;
+        }
+        return static_cast<double>(getBucketUpperBound(LATENCY_BUCKETS - 1)) / NANOSECONDS_PER_MICROSECOND;
+    };
+
+    // A sample recorded while summarizing can have its maximum in this interval but its count in the next, so the
+    // maximum can be missing. The buckets report up to 1/16th too much, so no percentile is reported above the maximum
+    summary.maxUs = max > 0 ? static_cast<double>(max) / NANOSECONDS_PER_MICROSECOND : percentile(1.0);
+    summary.p50Us = std::min(percentile(0.5), summary.maxUs);
+    summary.p99Us = std::min(percentile(0.99), summary.maxUs);
+    summary.p999Us = std::min(percentile(0.999), summary.maxUs);
+    return summary;
+}
+
+int LatencyHistogram::toBucket(uint64_t nanoseconds) {
+    if (nanoseconds < LATENCY_SUB_BUCKETS) return static_cast<int>(nanoseconds);
+
+    int magnitude = std::bit_width(nanoseconds) - 1;
+    if (magnitude > LATENCY_MAX_MAGNITUDE) return LATENCY_BUCKETS - 1;
+
+    // The highest bits of the latency select the bucket within its power of two
+    int shift = magnitude - LATENCY_SUB_BUCKET_BITS;
+    return shift * LATENCY_SUB_BUCKETS + static_cast<int>(nanoseconds >> shift);
+}
+
+uint64_t LatencyHistogram::getBucketUpperBound(int bucket) {
+    if (bucket < LATENCY_SUB_BUCKETS) return bucket;
+
+    int shift = bucket / LATENCY_SUB_BUCKETS - 1;
+    uint64_t lowerBound = static_cast<uint64_t>(bucket - shift * LATENCY_SUB_BUCKETS) << shift;
+    return lowerBound + (uint64_t(1) << shift) - 1;
+}
+
+}  // namespace rtt::robothub
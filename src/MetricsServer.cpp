@@ -0,0 +1,99 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <roboteam_utils/Print.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <MetricsServer.hpp>
+#include <cerrno>
+#include <cstring>
+
+namespace rtt::robothub {
+
+constexpr int ACCEPT_POLL_TIMEOUT_MS = 100;  // How often the serve thread checks whether it should stop
+constexpr int REQUEST_TIMEOUT_MS = 500;      // Clients that do not send their request in time are dropped
+constexpr int REQUEST_BUFFER_SIZE = 1024;    // The request itself is ignored, so only its start is read
+
+MetricsServer::MetricsServer(int port) {
+    this->listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (this->listenSocket < 0) {
+        throw FailedToStartMetricsServerException("Failed to create metrics socket: " + std::string(std::strerror(errno)));
+    }
+
+    int reuseAddress = 1;
+    setsockopt(this->listenSocket, SOL_SOCKET, SO_REUSEADDR, &reuseAddress, sizeof(reuseAddress));
+
+    // Only listen on localhost, as the metrics are not meant to leave this machine
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(static_cast<uint16_t>(port));
+
+    if (bind(this->listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(this->listenSocket, SOMAXCONN) < 0) {
+        std::string error = std::strerror(errno);
+        close(this->listenSocket);
+        throw FailedToStartMetricsServerException("Failed to listen for metrics requests on port " + std::to_string(port) + ": " + error);
+    }
+
+    this->shouldServe = true;
+    this->serveThread = std::thread(&MetricsServer::serve, this);
+    RTT_INFO("Serving metrics on http://localhost:", port, "/metrics")
+}
+
+MetricsServer::~MetricsServer() {
+    this->shouldServe = false;
+    if (this->serveThread.joinable()) this->serveThread.join();
+    close(this->listenSocket);
+}
+
+void MetricsServer::setMetrics(const std::string& metricsText) {
+    std::scoped_lock<std::mutex> lock(this->metricsMutex);
+    this->metrics = metricsText;
+}
+
+void MetricsServer::serve() {
+    pollfd listenPoll = {.fd = this->listenSocket, .events = POLLIN, .revents = 0};
+
+    while (this->shouldServe) {
+        if (poll(&listenPoll, 1, ACCEPT_POLL_TIMEOUT_MS) <= 0) continue;
+
+        int connection = accept(this->listenSocket, nullptr, nullptr);
+        if (connection < 0) continue;
+
+        this->answerRequest(connection);
+        close(connection);
+    }
+}
+
+void MetricsServer::answerRequest(int connection) {
+    // Wait for the request before answering, as closing a socket with unread data resets the connection
+    pollfd requestPoll = {.fd = connection, .events = POLLIN, .revents = 0};
+    if (poll(&requestPoll, 1, REQUEST_TIMEOUT_MS) <= 0) return;
+
+    char request[REQUEST_BUFFER_SIZE];
+    if (recv(connection, request, sizeof(request), 0) <= 0) return;
+
+    std::string body;
+    {
+        std::scoped_lock<std::mutex> lock(this->metricsMutex);
+        body = this->metrics;
+    }
+
+    std::string response = "HTTP/1.0 200 OK\r\n"
+                           "Content-Type: text/plain; version=0.0.4\r\n"
+                           "Content-Length: " +
+                           std::to_string(body.size()) + "\r\n\r\n" + body;
+
+    std::size_t bytesSent = 0;
+    while (bytesSent < response.size()) {
+        ssize_t sent = send(connection, response.data() + bytesSent, response.size() - bytesSent, MSG_NOSIGNAL);
+        if (sent <= 0) return;
+        bytesSent += static_cast<std::size_t>(sent);
+    }
+}
+
+FailedToStartMetricsServerException::FailedToStartMetricsServerException(const std::string& message) : message(message) {}
+const char* FailedToStartMetricsServerException::what() const noexcept { return this->message.c_str(); }
+
+}  // namespace rtt::robothub
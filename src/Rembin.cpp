@@ -0,0 +1,70 @@
+#include <REM_BaseTypes.h>
+#include <REM_Packet.h>
+
+#include <Rembin.hpp>
+#include <algorithm>
+
+namespace rtt::robothub {
+
+void RembinBlockSummary::addRecord(uint64_t timestampUs, uint8_t team, const uint8_t* packet, std::size_t size) {
+    // Records from different threads are not necessarily in order of their timestamps
+    this->firstTimestampUs = std::min(this->firstTimestampUs, timestampUs);
+    this->lastTimestampUs = std::max(this->lastTimestampUs, timestampUs);
+    this->teams |= static_cast<uint8_t>(1 << team);
+    this->records++;
+
+    auto packetType = getREMPacketType(packet, size);
+    if (packetType.has_value() && packetType.value() < 64) this->packetTypes |= uint64_t(1) << packetType.value();
+
+    auto robotId = getREMRobotId(packet, size);
+    if (robotId.has_value() && robotId.value() < 32) this->robots |= uint32_t(1) << robotId.value();
+}
+
+void RembinBlockSummary::clear() { *this = RembinBlockSummary(); }
+
+std::optional<uint8_t> getREMPacketType(const uint8_t* packet, std::size_t size) {
+    if (size < REM_PACKET_SIZE_REM_PACKET) return std::nullopt;
+    return static_cast<uint8_t>(REM_Packet_get_header((REM_PacketPayload*)packet));
+}
+
+std::optional<int> getREMRobotId(const uint8_t* packet, std::size_t size) {
+    auto packetType = getREMPacketType(packet, size);
+    if (!packetType.has_value()) return std::nullopt;
+
+    auto* payload = (REM_PacketPayload*)packet;
+    switch (packetType.value()) {
+        case REM_PACKET_TYPE_REM_ROBOT_COMMAND:
+        case REM_PACKET_TYPE_REM_ROBOT_BUZZER:
+            return static_cast<int>(REM_Packet_get_toRobotId(payload));
+        case REM_PACKET_TYPE_REM_ROBOT_FEEDBACK:
+        case REM_PACKET_TYPE_REM_ROBOT_STATE_INFO:
+            return static_cast<int>(REM_Packet_get_fromRobotId(payload));
+        default:
+            return std::nullopt;
+    }
+}
+
+void appendIndexEntry(std::vector<uint8_t>& buffer, const RembinBlockSummary& summary) {
+    appendLittleEndian(buffer, summary.offset, 8);
+    appendLittleEndian(buffer, summary.firstTimestampUs, 8);
+    appendLittleEndian(buffer, summary.lastTimestampUs, 8);
+    appendLittleEndian(buffer, summary.packetTypes, 8);
+    appendLittleEndian(buffer, summary.robots, 4);
+    appendLittleEndian(buffer, summary.records, 4);
+    appendLittleEndian(buffer, summary.teams, 1);
+    appendLittleEndian(buffer, 0, 7);
+}
+
+RembinBlockSummary readIndexEntry(const uint8_t* entry) {
+    RembinBlockSummary summary;
+    summary.offset = readLittleEndian(entry, 8);
+    summary.firstTimestampUs = readLittleEndian(entry + 8, 8);
+    summary.lastTimestampUs = readLittleEndian(entry + 16, 8);
+    summary.packetTypes = readLittleEndian(entry + 24, 8);
+    summary.robots = static_cast<uint32_t>(readLittleEndian(entry + 32, 4));
+    summary.records = static_cast<uint32_t>(readLittleEndian(entry + 36, 4));
+    summary.teams = static_cast<uint8_t>(readLittleEndian(entry + 40, 1));
+    return summary;
+}
+
+}  // namespace rtt::robothub
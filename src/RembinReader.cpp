@@ -0,0 +1,175 @@
+#include <fcntl.h>
+#include <roboteam_utils/Print.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <RembinReader.hpp>
+#include <cerrno>
+#include <cstring>
+
+namespace rtt::robothub {
+
+RembinReader::RembinReader(const std::string& path) : path(path) {
+    int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) throw FailedToReadRembinException("Could not open " + path + ": " + std::strerror(errno));
+
+    struct stat fileStatus = {};
+    if (fstat(file, &fileStatus) < 0 || fileStatus.st_size < REMBIN_HEADER_SIZE) {
+        close(file);
+        throw FailedToReadRembinException(path + " is too small to be a .rembin file");
+    }
+    this->size = static_cast<std::size_t>(fileStatus.st_size);
+
+    void* mapping = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);  // The mapping stays valid without the file descriptor
+    if (mapping == MAP_FAILED) throw FailedToReadRembinException("Could not map " + path + ": " + std::strerror(errno));
+    this->data = static_cast<const uint8_t*>(mapping);
+
+    auto formatVersion = static_cast<uint16_t>(readLittleEndian(this->data + 8, 2));
+    if (std::memcmp(this->data, REMBIN_MAGIC, sizeof(REMBIN_MAGIC)) != 0 || formatVersion != REMBIN_FORMAT_VERSION) {
+        munmap(mapping, this->size);
+        throw FailedToReadRembinException(path + " is not a .rembin file of format version " + std::to_string(REMBIN_FORMAT_VERSION));
+    }
+    this->remVersion = static_cast<uint32_t>(readLittleEndian(this->data + 12, 4));
+    this->startTimestampUs = readLittleEndian(this->data + 16, 8);
+
+    this->indexIsPresent = this->readIndex();
+    if (!this->indexIsPresent) {
+        RTT_WARNING(path, " has no index, probably because it was not closed. Rebuilding it from the blocks")
+        this->rebuildIndex();
+    }
+}
+
+RembinReader::~RembinReader() { munmap(const_cast<uint8_t*>(this->data), this->size); }
+
+uint32_t RembinReader::getREMVersion() const { return this->remVersion; }
+
+uint64_t RembinReader::getStartTimestampUs() const { return this->startTimestampUs; }
+
+bool RembinReader::hasIndex() const { return this->indexIsPresent; }
+
+const std::vector<RembinBlockSummary>& RembinReader::getBlocks() const { return this->blocks; }
+
+std::vector<std::size_t> RembinReader::findBlocks(const RembinQuery& query) const {
+    std::vector<std::size_t> matchingBlocks;
+
+    for (std::size_t i = 0; i < this->blocks.size(); ++i) {
+        const auto& block = this->blocks[i];
+        if (block.lastTimestampUs < query.fromTimestampUs || block.firstTimestampUs > query.toTimestampUs) continue;
+
+        uint8_t teamBit = query.team == rtt::Team::BLUE ? 1 << REMBIN_TEAM_BLUE : 1 << REMBIN_TEAM_YELLOW;
+        if (query.team.has_value() && (block.teams & teamBit) == 0) continue;
+        // Robots and packet types that do not fit in the bitmaps are not indexed, so they can be in any block
+        if (query.robotId.has_value() && query.robotId.value() < 32 && (block.robots & (uint32_t(1) << query.robotId.value())) == 0) continue;
+        if (query.packetType.has_value() && query.packetType.value() < 64 && (block.packetTypes & (uint64_t(1) << query.packetType.value())) == 0) continue;
+
+        matchingBlocks.push_back(i);
+    }
+    return matchingBlocks;
+}
+
+const std::vector<RembinRecord>& RembinReader::readBlock(std::size_t blockIndex) {
+    if (!this->decompressBlock(this->blocks.at(blockIndex).offset)) {
+        RTT_ERROR("Block ", blockIndex, " of ", this->path, " is corrupt")
+        this->records.clear();
+    }
+    return this->records;
+}
+
+void RembinReader::forEachRecord(const RembinQuery& query, const std::function<void(const RembinRecord&)>& callback) {
+    for (std::size_t blockIndex : this->findBlocks(query)) {
+        for (const auto& record : this->readBlock(blockIndex)) {
+            if (matchesQuery(record, query)) callback(record);
+        }
+    }
+}
+
+bool RembinReader::readIndex() {
+    auto headerSize = static_cast<uint16_t>(readLittleEndian(this->data + 10, 2));
+    if (this->size < headerSize + REMBIN_TRAILER_SIZE) return false;
+
+    const uint8_t* trailer = this->data + this->size - REMBIN_TRAILER_SIZE;
+    if (std::memcmp(trailer + 16, REMBIN_INDEX_MAGIC, sizeof(REMBIN_INDEX_MAGIC)) != 0) return false;
+
+    uint64_t indexOffset = readLittleEndian(trailer, 8);
+    uint64_t amountOfEntries = readLittleEndian(trailer + 8, 8);
+    if (indexOffset < headerSize || indexOffset > this->size || (this->size - REMBIN_TRAILER_SIZE - indexOffset) != amountOfEntries * REMBIN_INDEX_ENTRY_SIZE) return false;
+
+    this->blocks.clear();
+    this->blocks.reserve(amountOfEntries);
+    for (uint64_t i = 0; i < amountOfEntries; ++i) {
+        auto block = readIndexEntry(this->data + indexOffset + i * REMBIN_INDEX_ENTRY_SIZE);
+        if (block.offset + REMBIN_BLOCK_HEADER_SIZE > indexOffset) return false;
+        this->blocks.push_back(block);
+    }
+    return true;
+}
+
+void RembinReader::rebuildIndex() {
+    this->blocks.clear();
+
+    uint64_t offset = readLittleEndian(this->data + 10, 2);
+    while (offset + REMBIN_BLOCK_HEADER_SIZE <= this->size) {
+        // The last block can be partially written, which ends the file as well
+        if (!this->decompressBlock(offset)) break;
+
+        RembinBlockSummary block;
+        for (const auto& record : this->records) {
+            uint8_t team = record.team == rtt::Team::BLUE ? REMBIN_TEAM_BLUE : REMBIN_TEAM_YELLOW;
+            block.addRecord(record.timestampUs, team, record.packet, record.size);
+        }
+        block.offset = offset;
+        this->blocks.push_back(block);
+
+        offset += REMBIN_BLOCK_HEADER_SIZE + readLittleEndian(this->data + offset, 4);
+    }
+}
+
+bool RembinReader::decompressBlock(uint64_t offset) {
+    this->records.clear();
+    if (offset + REMBIN_BLOCK_HEADER_SIZE > this->size) return false;
+
+    const uint8_t* blockHeader = this->data + offset;
+    uint64_t compressedSize = readLittleEndian(blockHeader, 4);
+    uint64_t uncompressedSize = readLittleEndian(blockHeader + 4, 4);
+    uint64_t amountOfRecords = readLittleEndian(blockHeader + 8, 4);
+    uint64_t checksum = readLittleEndian(blockHeader + 12, 4);
+
+    const uint8_t* compressed = blockHeader + REMBIN_BLOCK_HEADER_SIZE;
+    if (offset + REMBIN_BLOCK_HEADER_SIZE + compressedSize > this->size) return false;
+    if (crc32(0, compressed, compressedSize) != checksum) return false;
+
+    this->decompressedBlock.resize(uncompressedSize);
+    uLongf decompressedSize = uncompressedSize;
+    if (uncompress(this->decompressedBlock.data(), &decompressedSize, compressed, compressedSize) != Z_OK || decompressedSize != uncompressedSize) return false;
+
+    this->records.reserve(amountOfRecords);
+    std::size_t position = 0;
+    while (position + REMBIN_RECORD_HEADER_SIZE <= uncompressedSize) {
+        const uint8_t* record = this->decompressedBlock.data() + position;
+        std::size_t packetSize = readLittleEndian(record + 9, 2);
+        if (position + REMBIN_RECORD_HEADER_SIZE + packetSize > uncompressedSize) return false;
+
+        this->records.push_back({.timestampUs = readLittleEndian(record, 8),
+                                 .team = record[8] == REMBIN_TEAM_BLUE ? rtt::Team::BLUE : rtt::Team::YELLOW,
+                                 .packet = record + REMBIN_RECORD_HEADER_SIZE,
+                                 .size = packetSize});
+        position += REMBIN_RECORD_HEADER_SIZE + packetSize;
+    }
+    return position == uncompressedSize && this->records.size() == amountOfRecords;
+}
+
+bool matchesQuery(const RembinRecord& record, const RembinQuery& query) {
+    if (record.timestampUs < query.fromTimestampUs || record.timestampUs > query.toTimestampUs) return false;
+    if (query.team.has_value() && record.team != query.team.value()) return false;
+    if (query.robotId.has_value() && getREMRobotId(record.packet, record.size) != query.robotId) return false;
+    if (query.packetType.has_value() && getREMPacketType(record.packet, record.size) != query.packetType) return false;
+    return true;
+}
+
+FailedToReadRembinException::FailedToReadRembinException(const std::string& message) : message(message) {}
+const char* FailedToReadRembinException::what() const noexcept { return this->message.c_str(); }
+
+}  // namespace rtt::robothub
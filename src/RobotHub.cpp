@@ -5,6 +5,7 @@
 #include <roboteam_utils/Time.h>
 
 
+#include <atomic>
 #include <cmath>
 
 #include <sstream>
@@ -12,61 +13,200 @@
 
 namespace rtt::robothub {
 
-constexpr int DEFAULT_GRSIM_FEEDBACK_PORT_BLUE_CONTROL = 30011;
-constexpr int DEFAULT_GRSIM_FEEDBACK_PORT_YELLOW_CONTROL = 30012;
-constexpr int DEFAULT_GRSIM_FEEDBACK_PORT_CONFIGURATION = 30013;
-
 // These two values are properties of our physical robots. We use these in commands for simulators
 constexpr float SIM_CHIPPER_ANGLE_DEGREES = 45.0f;     // The angle at which the chipper shoots
 constexpr float SIM_MAX_DRIBBLER_SPEED_RPM = 1021.0f;  // The theoretical maximum speed of the dribblers
 
-RobotHub::RobotHub(bool shouldLog, bool logInMarpleFormat) {
-    simulation::SimulatorNetworkConfiguration config = {.blueFeedbackPort = DEFAULT_GRSIM_FEEDBACK_PORT_BLUE_CONTROL,
-                                                        .yellowFeedbackPort = DEFAULT_GRSIM_FEEDBACK_PORT_YELLOW_CONTROL,
-                                                        .configurationFeedbackPort = DEFAULT_GRSIM_FEEDBACK_PORT_CONFIGURATION};
-
-    if (!this->initializeNetworkers()) {
+RobotHub::RobotHub(const RobotHubConfiguration &configuration)
+    : simulatorSessionFeedbackCallback(configuration.simulatorSessionFeedbackCallback), feedbackCallback(configuration.feedbackCallback) {
+    // The capture must exist before the networkers call back
+    if (!configuration.captureFile.empty()) {
+        this->capture = std::make_unique<HubCaptureWriter>(configuration.captureFile);
+        RTT_INFO("Capturing all inputs to ", configuration.captureFile)
+    }
+    // Feedback can arrive as soon as the basestations and simulators exist
+    if (!configuration.sharedFeedbackName.empty()) {
+        this->sharedFeedback = std::make_unique<SharedFeedbackWriter>(configuration.sharedFeedbackName);
+        RTT_INFO("Sharing feedback in shared memory ", configuration.sharedFeedbackName)
+    }
+    if (configuration.publishFeedback && !this->initializeFeedbackPublisher()) {
         throw FailedToInitializeNetworkersException();
     }
 
+    try {
+        this->startThreads(configuration);
+    } catch (...) {
+        // The destructor does not run for a hub that failed to construct, so stop the threads that already call into it
+        this->stopThreads();
+        throw;
+    }
+}
+
+void RobotHub::startThreads(const RobotHubConfiguration &configuration) {
     this->mode = utils::RobotHubMode::NEITHER;
+    this->latencyHistograms = std::make_unique<std::array<LatencyHistogram, AMOUNT_OF_LATENCY_STAGES>>();
+
+    this->sendWheelVelocitiesToSimulator = configuration.sendWheelVelocitiesToSimulator;
+    if (this->sendWheelVelocitiesToSimulator) RTT_INFO("Sending wheel velocities to the simulator")
+
+    this->simulationErrorAggregator =
+        std::make_unique<simulation::SimulationErrorAggregator>(configuration.simulationErrorReportInterval, [](const std::string &message) { RTT_ERROR(message) });
+
+    this->simulatorIOPool = std::make_shared<simulation::SimulatorIOPool>(configuration.simulatorIOThreads);
+    this->simulationErrorEvictionTask =
+        this->simulatorIOPool->addTimerTask(configuration.simulationErrorReportInterval, [this] { this->simulationErrorAggregator->evictQuietErrors(); });
+    for (const auto &sessionConfiguration : configuration.simulatorSessions) {
+        int sessionId = static_cast<int>(this->simulatorSessions.size());
+
+        SimulatorSession session = {.simulatorManager = std::make_unique<simulation::SimulatorManager>(sessionConfiguration.networkConfiguration, this->simulatorIOPool),
+                                    .configurationCache = std::make_unique<simulation::ConfigurationCache>(configuration.simulationConfigurationCoalesceWindow),
+                                    .configurationFlushTask = -1,
+                                    .wheelKinematics = std::make_unique<simulation::WheelKinematics>()};
+        session.simulatorManager->setRobotControlFeedbackCallback(
+            [&, sessionId](const simulation::RobotControlFeedback &feedback) { this->handleRobotFeedbackFromSimulator(feedback, sessionId); });
+        // The sessions vector can still grow while feedback arrives, so use the cache itself instead of indexing
+        auto *configurationCache = session.configurationCache.get();
+        session.simulatorManager->setConfigurationFeedbackCallback(
+            [this, configurationCache](const simulation::ConfigurationFeedback &feedback) { this->handleSimulationConfigurationFeedback(feedback, *configurationCache); });
+        // A simulator that restarted lost its configuration, so send the robot properties again
+        session.simulatorManager->setLinkEstablishedCallback([configurationCache] { configurationCache->forgetAppliedRobotProperties(); });
+
+        this->simulatorSessions.push_back(std::move(session));
+    }
 
-    this->simulatorManager = std::make_unique<simulation::SimulatorManager>(config);
-    this->simulatorManager->setRobotControlFeedbackCallback([&](const simulation::RobotControlFeedback &feedback) { this->handleRobotFeedbackFromSimulator(feedback); });
-    this->simulatorManager->setConfigurationFeedbackCallback([&](const simulation::ConfigurationFeedback &feedback) { this->handleSimulationConfigurationFeedback(feedback); });
+    // Only add the flush tasks once the sessions vector will not change anymore
+    for (int sessionId = 0; sessionId < this->getAmountOfSimulatorSessions(); ++sessionId) {
+        // Changes that arrive within the coalesce window of the previous flush are sent at most one window later
+        this->simulatorSessions[sessionId].configurationFlushTask =
+            this->simulatorIOPool->addTimerTask(configuration.simulationConfigurationCoalesceWindow, [this, sessionId] { this->flushSimulationConfiguration(sessionId); });
+    }
 
-    this->basestationManager = std::make_unique<basestation::BasestationManager>();
+    this->basestationManager = std::make_unique<basestation::BasestationManager>(basestation::BasestationManagerConfiguration{
+        .useStandInBasestations = configuration.useStandInBasestations,
+        .collection = {.keepBasestationsWarm = configuration.keepBasestationsWarm, .channelMapFile = configuration.basestationChannelMapFile}});
     this->basestationManager->setFeedbackCallback([&](const REM_RobotFeedback &feedback, rtt::Team color) { this->handleRobotFeedbackFromBasestation(feedback, color); });
-    this->basestationManager->setRobotStateInfoCallback([&](const REM_RobotStateInfo& robotStateInfo, rtt::Team color) { this->handleRobotStateInfo(robotStateInfo, color); });
     this->basestationManager->setBasestationLogCallback([&](const std::string& log, rtt::Team color) { this->handleBasestationLog(log, color); });
 
-    // if (shouldLog) { this->logger = RobotHubLogger(logInMarpleFormat); }
+    if (configuration.shouldLog) this->logger = std::make_unique<RobotHubLogger>(configuration.loggerConfiguration);
+    this->basestationManager->setIncomingPacketCallback([&](const uint8_t *packet, std::size_t size, rtt::Team color) { this->handleIncomingBasestationPacket(packet, size, color); });
+
+    // Only take inputs once everything they are sent to exists
+    if (!configuration.sharedYellowCommandsName.empty() && !configuration.sharedBlueCommandsName.empty()) {
+        this->sharedCommands = std::make_unique<SharedCommandIngress>(configuration.sharedYellowCommandsName, configuration.sharedBlueCommandsName,
+                                                                      [&](const rtt::RobotCommands &commands, rtt::Team color) {
+                                                                          tuneCurrentThread(ThreadRole::TRANSMIT);
+                                                                          this->onRobotCommands(commands, color);
+                                                                      });
+        RTT_INFO("Taking commands from shared memory ", configuration.sharedYellowCommandsName, " and ", configuration.sharedBlueCommandsName)
+    }
+    if (configuration.listenToNetworkers && !this->initializeSubscribers()) {
+        throw FailedToInitializeNetworkersException();
+    }
+}
+
+RobotHub::~RobotHub() { this->stopThreads(); }
+
+void RobotHub::stopThreads() {
+    // Stop taking inputs before anything they are sent to is destroyed
+    this->robotCommandsBlueSubscriber.reset();
+    this->robotCommandsYellowSubscriber.reset();
+    this->settingsSubscriber.reset();
+    this->simulationConfigurationSubscriber.reset();
+    this->sharedCommands.reset();
+
+    // The basestation and simulator threads call into members that are declared after them, which would be destroyed first
+    this->basestationManager.reset();
+    if (this->simulatorIOPool != nullptr) {
+        // The flush tasks use the sessions, so remove them before the sessions are stopped
+        for (const auto &session : this->simulatorSessions) {
+            this->simulatorIOPool->removeTask(session.configurationFlushTask);
+        }
+        this->simulatorIOPool->removeTask(this->simulationErrorEvictionTask);
+    }
+    for (auto &session : this->simulatorSessions) {
+        session.simulatorManager.reset();
+    }
+    // Joins the threads of the pool, as the managers do not share it anymore
+    this->simulatorIOPool.reset();
 }
 
 const RobotHubStatistics &RobotHub::getStatistics() {
+    this->counters.fillStatistics(this->statistics);
+    this->statistics.robotHubMode = this->mode;
+    for (int stage = 0; stage < AMOUNT_OF_LATENCY_STAGES; ++stage) {
+        this->statistics.stageLatencies[stage] = this->latencyHistograms->at(stage).takeSummary();
+    }
+    for (int role = 0; role < AMOUNT_OF_THREAD_ROLES; ++role) {
+        this->statistics.schedulerJitter[role] = takeSchedulerJitter(static_cast<ThreadRole>(role));
+    }
     this->statistics.basestationManagerStatus = this->basestationManager->getStatus();
+    this->statistics.distinctSimulationErrors = this->simulationErrorAggregator->getDistinctErrors();
+    if (!this->simulatorSessions.empty()) {
+        // Round trip times are taken, so they cover the time since the previous call
+        const auto &simulatorManager = this->simulatorSessions[DEFAULT_SIMULATOR_SESSION].simulatorManager;
+        this->statistics.yellowSimulatorRoundTrip = simulatorManager->takeRoundTripStatistics(rtt::Team::YELLOW);
+        this->statistics.blueSimulatorRoundTrip = simulatorManager->takeRoundTripStatistics(rtt::Team::BLUE);
+    }
     return this->statistics;
 }
 
-void RobotHub::resetStatistics() { this->statistics.resetValues(); }
+void RobotHub::resetStatistics() {
+    this->counters.reset();
+    this->statistics.resetValues();
+}
+
+int RobotHub::getAmountOfSimulatorSessions() const { return static_cast<int>(this->simulatorSessions.size()); }
+
+void RobotHub::submitSimulatorCommands(int sessionId, const rtt::RobotCommands &commands, rtt::Team color) {
+    auto receivedAt = std::chrono::steady_clock::now();
+    std::scoped_lock<PriorityInheritanceMutex> lock(this->onRobotCommandsMutex);
+    this->sendCommandsToSimulator(commands, color, sessionId, receivedAt);
+}
+
+void RobotHub::submitSimulatorConfiguration(int sessionId, const proto::SimulationConfiguration &configuration) {
+    this->stageSimulationConfiguration(configuration, sessionId);
+}
+
+void RobotHub::submitRobotCommands(const rtt::RobotCommands &commands, rtt::Team color) { this->onRobotCommands(commands, color); }
+
+void RobotHub::submitCommands(rtt::Team team, std::span<const rtt::RobotCommand> commands) { this->onRobotCommands(commands, team); }
+
+void RobotHub::submitSettings(const proto::Setting &_settings) { this->onSettings(_settings); }
+
+void RobotHub::submitSimulationConfiguration(const proto::SimulationConfiguration &configuration) { this->onSimulationConfiguration(configuration); }
+
+void RobotHub::submitBasestationPacket(const uint8_t *packet, std::size_t size, rtt::Team color) { this->basestationManager->injectIncomingPacket(packet, size, color); }
+
+bool RobotHub::initializeFeedbackPublisher() {
+    try {
+        this->robotFeedbackPublisher = std::make_unique<rtt::net::RobotFeedbackPublisher>();
+        return true;
+    } catch (const std::exception &e) {
+        return false;
+    }
+}
 
-bool RobotHub::initializeNetworkers() {
+bool RobotHub::initializeSubscribers() {
     bool successfullyInitialized;
 
     try {
         this->robotCommandsBlueSubscriber =
-            std::make_unique<rtt::net::RobotCommandsBlueSubscriber>([&](const rtt::RobotCommands &commands) { this->onRobotCommands(commands, rtt::Team::BLUE); });
+            std::make_unique<rtt::net::RobotCommandsBlueSubscriber>([&](const rtt::RobotCommands &commands) {
+                tuneCurrentThread(ThreadRole::TRANSMIT);
+                this->onRobotCommands(commands, rtt::Team::BLUE);
+            });
 
         this->robotCommandsYellowSubscriber =
-            std::make_unique<rtt::net::RobotCommandsYellowSubscriber>([&](const rtt::RobotCommands &commands) { this->onRobotCommands(commands, rtt::Team::YELLOW); });
+            std::make_unique<rtt::net::RobotCommandsYellowSubscriber>([&](const rtt::RobotCommands &commands) {
+                tuneCurrentThread(ThreadRole::TRANSMIT);
+                this->onRobotCommands(commands, rtt::Team::YELLOW);
+            });
 
         this->settingsSubscriber = std::make_unique<rtt::net::SettingsSubscriber>([&](const proto::Setting &_settings) { this->onSettings(_settings); });
 
         this->simulationConfigurationSubscriber =
             std::make_unique<rtt::net::SimulationConfigurationSubscriber>([&](const proto::SimulationConfiguration &config) { this->onSimulationConfiguration(config); });
 
-        this->robotFeedbackPublisher = std::make_unique<rtt::net::RobotFeedbackPublisher>();
-
         successfullyInitialized = true;
     } catch (const std::exception &e) {  // TODO: Figure out the exception
         successfullyInitialized = false;
@@ -75,10 +215,14 @@ bool RobotHub::initializeNetworkers() {
     return successfullyInitialized;
 }
 
-void RobotHub::sendCommandsToSimulator(const rtt::RobotCommands &commands, rtt::Team color) {
-    if (this->simulatorManager == nullptr) return;
+void RobotHub::sendCommandsToSimulator(std::span<const rtt::RobotCommand> commands, rtt::Team color, int sessionId, TimePoint receivedAt) {
+    if (sessionId < 0 || sessionId >= this->getAmountOfSimulatorSessions()) return;
+    auto lockedAt = std::chrono::steady_clock::now();  // Callers hold the onRobotCommandsMutex
 
     simulation::RobotControlCommand simCommand;
+    simulation::TeamVelocities wheelDrivenRobots;
+    std::array<const rtt::RobotCommand *, simulation::MAX_ROBOTS_PER_TEAM> wheelDrivenCommands = {};
+
     for (const auto &robotCommand : commands) {
         int id = robotCommand.id;
         auto kickSpeed = static_cast<float>(robotCommand.kickSpeed);
@@ -92,126 +236,152 @@ void RobotHub::sendCommandsToSimulator(const rtt::RobotCommands &commands, rtt::
             RTT_WARNING("Robot command used absolute angle, but simulator requires angular velocity")
         }
 
-        simCommand.addRobotControlWithGlobalSpeeds(id, kickSpeed, kickAngle, dribblerSpeed, xVelocity, yVelocity, angularVelocity);
+        // Wheel velocities need the orientation of the robot, so robots without one still use global velocities
+        bool canUseWheelVelocities = this->sendWheelVelocitiesToSimulator && robotCommand.cameraAngleOfRobotIsSet && id >= 0 &&
+                                     id < simulation::MAX_ROBOTS_PER_TEAM && wheelDrivenRobots.amount < simulation::MAX_ROBOTS_PER_TEAM;
+        if (canUseWheelVelocities) {
+            int index = wheelDrivenRobots.amount++;
+            wheelDrivenRobots.robotId[index] = id;
+            wheelDrivenRobots.xVelocity[index] = xVelocity;
+            wheelDrivenRobots.yVelocity[index] = yVelocity;
+            wheelDrivenRobots.angularVelocity[index] = angularVelocity;
+            wheelDrivenRobots.orientation[index] = static_cast<float>(robotCommand.cameraAngleOfRobot);
+            wheelDrivenCommands[index] = &robotCommand;
+        } else {
+            simCommand.addRobotControlWithGlobalSpeeds(id, kickSpeed, kickAngle, dribblerSpeed, xVelocity, yVelocity, angularVelocity);
+        }
 
         // Update received commands stats
-        this->statistics.incrementCommandsReceivedCounter(id, color);
+        this->counters.incrementCommandsReceivedCounter(id, color);
     }
 
-    auto bytesSent = this->simulatorManager->sendRobotControlCommand(simCommand, color);
+    if (wheelDrivenRobots.amount > 0) {
+        simulation::TeamWheelVelocities wheelVelocities;
+        this->simulatorSessions[sessionId].wheelKinematics->computeWheelVelocities(color, wheelDrivenRobots, wheelVelocities);
+
+        for (int i = 0; i < wheelVelocities.amount; ++i) {
+            const auto &robotCommand = *wheelDrivenCommands[i];
+            auto kickSpeed = static_cast<float>(robotCommand.kickSpeed);
+            float kickAngle = robotCommand.kickType == rtt::KickType::CHIP ? SIM_CHIPPER_ANGLE_DEGREES : 0.0f;
+            float dribblerSpeed = static_cast<float>(robotCommand.dribblerSpeed) * SIM_MAX_DRIBBLER_SPEED_RPM;
+
+            simCommand.addRobotControlWithWheelSpeeds(robotCommand.id, kickSpeed, kickAngle, dribblerSpeed, wheelVelocities.frontRight[i], wheelVelocities.backRight[i],
+                                                      wheelVelocities.backLeft[i], wheelVelocities.frontLeft[i]);
+        }
+    }
+
+    auto convertedAt = std::chrono::steady_clock::now();
+    auto bytesSent = this->simulatorSessions[sessionId].simulatorManager->sendRobotControlCommand(simCommand, color);
+    this->recordCommandLatencies(receivedAt, lockedAt, convertedAt, std::chrono::steady_clock::now());
 
     // Update bytes sent/packets dropped statistics
     if (bytesSent > 0) {
-        if (color == rtt::Team::YELLOW) {
-            this->statistics.yellowTeamBytesSent += bytesSent;
-        } else {
-            this->statistics.blueTeamBytesSent += bytesSent;
-        }
+        this->counters.addBytesSent(color, bytesSent);
     } else {
-        if (color == rtt::Team::YELLOW) {
-            this->statistics.yellowTeamPacketsDropped++;
-        } else {
-            this->statistics.blueTeamPacketsDropped++;
-        }
+        this->counters.incrementPacketsDropped(color);
     }
 }
 
-void RobotHub::sendCommandsToBasestation(const rtt::RobotCommands &commands, rtt::Team color) {
-    for (const auto &robotCommand : commands) {
-        // Convert the RobotCommand to a command for the basestation
-
-        REM_RobotCommand command;
-        command.header = REM_PACKET_TYPE_REM_ROBOT_COMMAND;
-        command.toRobotId = robotCommand.id;
-        command.toColor = color == rtt::Team::BLUE;
-        command.fromBS = true;
-        command.remVersion = REM_LOCAL_VERSION;
-        // command.messageId = 0; TODO implement incrementing message id
-        command.payloadSize = REM_PACKET_SIZE_REM_ROBOT_COMMAND;
-
-        command.kickAtAngle = robotCommand.kickAtAngle;
-        command.doKick = robotCommand.kickSpeed > 0.0 && robotCommand.kickType == KickType::KICK;
-        command.doChip = robotCommand.kickSpeed > 0.0 && robotCommand.kickType == KickType::CHIP;
-        command.doForce = !robotCommand.waitForBall;
-        command.kickChipPower = static_cast<float>(robotCommand.kickSpeed);
-        command.dribbler = static_cast<float>(robotCommand.dribblerSpeed);
-
-        command.rho = static_cast<float>(robotCommand.velocity.length());
-        command.theta = static_cast<float>(robotCommand.velocity.angle());
+void RobotHub::sendCommandsToBasestation(std::span<const rtt::RobotCommand> commands, rtt::Team color, TimePoint receivedAt,
+                                         std::vector<REM_RobotCommandPayload> *sentPackets) {
+    auto lockedAt = std::chrono::steady_clock::now();  // Callers hold the onRobotCommandsMutex
 
-        command.useAbsoluteAngle = !robotCommand.useAngularVelocity;
-        command.angle = static_cast<float>(robotCommand.targetAngle.getValue());
-        command.angularVelocity = static_cast<float>(robotCommand.targetAngularVelocity);
+    // Convert the RobotCommands to commands for the basestation all at once
+    this->basestationCommandBatch.convert(commands, color);
+    auto convertedAt = std::chrono::steady_clock::now();
 
-        command.useCameraAngle = robotCommand.cameraAngleOfRobotIsSet;
-        command.cameraAngle = command.useCameraAngle ? static_cast<float>(robotCommand.cameraAngleOfRobot) : 0.0f;
-
-        command.feedback = robotCommand.ignorePacket;
-
-        int bytesSent = this->basestationManager->sendRobotCommand(command, color);
+    for (int i = 0; i < this->basestationCommandBatch.size(); ++i) {
+        int bytesSent = this->basestationManager->sendRobotCommandPayload(this->basestationCommandBatch.getPayload(i), color);
 
         // Update statistics
-        this->statistics.incrementCommandsReceivedCounter(robotCommand.id, color);
+        this->counters.incrementCommandsReceivedCounter(this->basestationCommandBatch.getRobotId(i), color);
 
         if (bytesSent > 0) {
-            if (color == rtt::Team::YELLOW) {
-                this->statistics.yellowTeamBytesSent += bytesSent;
-            } else {
-                this->statistics.blueTeamBytesSent += bytesSent;
-            }
+            this->counters.addBytesSent(color, bytesSent);
+            if (sentPackets != nullptr) sentPackets->push_back(this->basestationCommandBatch.getPayload(i));
         } else {
-            if (color == rtt::Team::YELLOW) {
-                this->statistics.yellowTeamPacketsDropped++;
-            } else {
-                this->statistics.blueTeamPacketsDropped++;
-            }
+            this->counters.incrementPacketsDropped(color);
         }
     }
+    this->recordCommandLatencies(receivedAt, lockedAt, convertedAt, std::chrono::steady_clock::now());
 }
 
-void RobotHub::onRobotCommands(const rtt::RobotCommands &commands, rtt::Team color) {
-    std::scoped_lock<std::mutex> lock(this->onRobotCommandsMutex);
-
-    switch (this->mode) {
-        case utils::RobotHubMode::SIMULATOR:
-            this->sendCommandsToSimulator(commands, color);
-            break;
-        case utils::RobotHubMode::BASESTATION:
-            this->sendCommandsToBasestation(commands, color);
-            break;
-        case utils::RobotHubMode::NEITHER:
-            // Do not handle commands
-            break;
-        default:
-            RTT_WARNING("Unknown RobotHub mode")
-            break;
+void RobotHub::onRobotCommands(std::span<const rtt::RobotCommand> commands, rtt::Team color) {
+    auto receivedAt = std::chrono::steady_clock::now();  // Before locking, so waiting for the other team counts as well
+    if (this->capture != nullptr) this->capture->captureRobotCommands(commands, color);
+
+    // Only the packets that reach a basestation are logged. Reused per thread, so logging does not allocate
+    thread_local std::vector<REM_RobotCommandPayload> sentPackets;
+    sentPackets.clear();
+
+    {
+        std::scoped_lock<PriorityInheritanceMutex> lock(this->onRobotCommandsMutex);
+        switch (this->mode) {
+            case utils::RobotHubMode::SIMULATOR:
+                this->sendCommandsToSimulator(commands, color, DEFAULT_SIMULATOR_SESSION, receivedAt);
+                break;
+            case utils::RobotHubMode::BASESTATION:
+                this->sendCommandsToBasestation(commands, color, receivedAt, this->logger != nullptr ? &sentPackets : nullptr);
+                break;
+            case utils::RobotHubMode::NEITHER:
+                // Do not handle commands
+                break;
+            default:
+                RTT_WARNING("Unknown RobotHub mode")
+                break;
+        }
     }
 
-    // if (this->logger.has_value()) { this->logger.value().logRobotCommands(commands, color); }
+    if (sentPackets.empty()) return;
+    auto timestampUs = getLogTimestampUs();
+    for (const auto &packet : sentPackets) {
+        this->logger->logREM(packet.payload, REM_PACKET_SIZE_REM_ROBOT_COMMAND, color, timestampUs);
+    }
 }
 
 void RobotHub::onSettings(const proto::Setting &_settings) {
+    if (this->capture != nullptr) this->capture->captureSettings(_settings);
     this->settings = _settings;
 
     utils::RobotHubMode newMode = settings.serialmode() ? utils::RobotHubMode::BASESTATION : utils::RobotHubMode::SIMULATOR;
 
     this->mode = newMode;
-    this->statistics.robotHubMode = newMode;
 }
 
 void RobotHub::onSimulationConfiguration(const proto::SimulationConfiguration &configuration) {
-    simulation::ConfigurationCommand configCommand;
+    if (this->capture != nullptr) this->capture->captureSimulationConfiguration(configuration);
+    this->stageSimulationConfiguration(configuration, DEFAULT_SIMULATOR_SESSION);
+}
+
+void RobotHub::stageSimulationConfiguration(const proto::SimulationConfiguration &configuration, int sessionId) {
+    if (sessionId < 0 || sessionId >= this->getAmountOfSimulatorSessions()) return;
+
+    auto &session = this->simulatorSessions[sessionId];
+    auto &cache = *session.configurationCache;
 
     if (configuration.has_ball_location()) {
         const auto &ballLocation = configuration.ball_location();
-        configCommand.setBallLocation(ballLocation.x(), ballLocation.y(), ballLocation.z(), ballLocation.x_velocity(), ballLocation.y_velocity(), ballLocation.z_velocity(),
-                                      ballLocation.velocity_in_rolling(), ballLocation.teleport_safely(), ballLocation.by_force());
+        cache.stageBallLocation({.x = ballLocation.x(),
+                                 .y = ballLocation.y(),
+                                 .z = ballLocation.z(),
+                                 .xVelocity = ballLocation.x_velocity(),
+                                 .yVelocity = ballLocation.y_velocity(),
+                                 .zVelocity = ballLocation.z_velocity(),
+                                 .velocityInRolling = ballLocation.velocity_in_rolling(),
+                                 .teleportSafely = ballLocation.teleport_safely(),
+                                 .byForce = ballLocation.by_force()});
     }
 
     for (const auto &robotLocation : configuration.robot_locations()) {
-        configCommand.addRobotLocation(robotLocation.id(), robotLocation.is_team_yellow() ? rtt::Team::YELLOW : rtt::Team::BLUE, robotLocation.x(), robotLocation.y(),
-                                       robotLocation.x_velocity(), robotLocation.y_velocity(), robotLocation.angular_velocity(), robotLocation.orientation(),
-                                       robotLocation.present_on_field(), robotLocation.by_force());
+        cache.stageRobotLocation(static_cast<int>(robotLocation.id()), robotLocation.is_team_yellow() ? rtt::Team::YELLOW : rtt::Team::BLUE,
+                                 {.x = robotLocation.x(),
+                                  .y = robotLocation.y(),
+                                  .xVelocity = robotLocation.x_velocity(),
+                                  .yVelocity = robotLocation.y_velocity(),
+                                  .angularVelocity = robotLocation.angular_velocity(),
+                                  .orientation = robotLocation.orientation(),
+                                  .shouldBePresentOnField = robotLocation.present_on_field(),
+                                  .byForce = robotLocation.by_force()});
     }
 
     for (const auto &robotProperties : configuration.robot_properties()) {
@@ -234,14 +404,30 @@ void RobotHub::onSimulationConfiguration(const proto::SimulationConfiguration &c
                                                       .backLeftWheelAngle = robotProperties.back_left_wheel_angle(),
                                                       .frontLeftWheelAngle = robotProperties.front_left_wheel_angle()};
 
-        configCommand.addRobotSpecs(robotProperties.id(), robotProperties.is_team_yellow() ? rtt::Team::YELLOW : rtt::Team::BLUE, propertyValues);
+        int id = static_cast<int>(robotProperties.id());
+        rtt::Team color = robotProperties.is_team_yellow() ? rtt::Team::YELLOW : rtt::Team::BLUE;
+        cache.stageRobotProperties(id, color, propertyValues);
+        session.wheelKinematics->setRobotProperties(id, color, propertyValues);
     }
 
+    // Send immediately if the previous configuration was sent long enough ago. Otherwise, the flush task sends it later
+    this->flushSimulationConfiguration(sessionId);
+}
+
+bool RobotHub::flushSimulationConfiguration(int sessionId) {
+    auto &session = this->simulatorSessions[sessionId];
+
+    simulation::ConfigurationCommand configCommand;
+    if (!session.configurationCache->takeDueChanges(configCommand)) return false;
+
     // TODO: Put these bytes sent into nice statistics output (low priority)
-    this->simulatorManager->sendConfigurationCommand(configCommand);
+    auto bytesSent = session.simulatorManager->sendConfigurationCommand(configCommand);
+    session.configurationCache->confirmTakenChanges(bytesSent > 0);
+    return true;
 }
 
-void RobotHub::handleRobotFeedbackFromSimulator(const simulation::RobotControlFeedback &feedback) {
+void RobotHub::handleRobotFeedbackFromSimulator(const simulation::RobotControlFeedback &feedback, int sessionId) {
+    auto receivedAt = std::chrono::steady_clock::now();
     rtt::RobotsFeedback robotsFeedback;
     robotsFeedback.source = rtt::RobotFeedbackSource::SIMULATOR;
     robotsFeedback.team = feedback.color;
@@ -265,16 +451,21 @@ void RobotHub::handleRobotFeedbackFromSimulator(const simulation::RobotControlFe
         robotsFeedback.feedback.push_back(robotFeedback);
 
         // Increment the feedback counter of this robot
-        this->statistics.incrementFeedbackReceivedCounter(robotId, feedback.color);
+        this->counters.incrementFeedbackReceivedCounter(robotId, feedback.color);
     }
 
-    this->sendRobotFeedback(robotsFeedback);
-    this->handleSimulationErrors(feedback.simulationErrors);
+    // Only the default session publishes its feedback on the networkers
+    if (sessionId == DEFAULT_SIMULATOR_SESSION) {
+        this->sendRobotFeedback(robotsFeedback);
+        this->latencyHistograms->at(static_cast<int>(LatencyStage::FEEDBACK_PUBLISH)).record(receivedAt, std::chrono::steady_clock::now());
+    }
+    if (this->simulatorSessionFeedbackCallback != nullptr) this->simulatorSessionFeedbackCallback(sessionId, robotsFeedback);
 
-    // if (this->logger.has_value()) { this->logger->logRobotFeedback(robotsFeedback); }
+    this->handleSimulationErrors(feedback.simulationErrors);
 }
 
 void RobotHub::handleRobotFeedbackFromBasestation(const REM_RobotFeedback &feedback, rtt::Team basestationColor) {
+    auto receivedAt = std::chrono::steady_clock::now();
     rtt::RobotsFeedback robotsFeedback;
     robotsFeedback.source = rtt::RobotFeedbackSource::BASESTATION;
     robotsFeedback.team = basestationColor;
@@ -297,68 +488,59 @@ void RobotHub::handleRobotFeedbackFromBasestation(const REM_RobotFeedback &feedb
     robotsFeedback.feedback.push_back(robotFeedback);
 
     this->sendRobotFeedback(robotsFeedback);
+    this->latencyHistograms->at(static_cast<int>(LatencyStage::FEEDBACK_PUBLISH)).record(receivedAt, std::chrono::steady_clock::now());
 
     // Increment the feedback counter of this robot
-    this->statistics.incrementFeedbackReceivedCounter(feedback.fromRobotId, basestationColor);
+    this->counters.incrementFeedbackReceivedCounter(feedback.fromRobotId, basestationColor);
+}
 
-    // if (this->logger.has_value()) { this->logger->logRobotFeedback(robotsFeedback); }
+void RobotHub::recordCommandLatencies(TimePoint receivedAt, TimePoint lockedAt, TimePoint convertedAt, TimePoint writtenAt) {
+    this->latencyHistograms->at(static_cast<int>(LatencyStage::COMMAND_ENQUEUE)).record(receivedAt, lockedAt);
+    this->latencyHistograms->at(static_cast<int>(LatencyStage::COMMAND_CONVERSION)).record(lockedAt, convertedAt);
+    this->latencyHistograms->at(static_cast<int>(LatencyStage::COMMAND_WRITE)).record(convertedAt, writtenAt);
+    this->latencyHistograms->at(static_cast<int>(LatencyStage::COMMAND_TOTAL)).record(receivedAt, writtenAt);
 }
 
 bool RobotHub::sendRobotFeedback(const rtt::RobotsFeedback &feedback) {
+    if (this->feedbackCallback) this->feedbackCallback(feedback);
+    if (this->sharedFeedback != nullptr) this->sharedFeedback->publish(feedback);
+    if (this->robotFeedbackPublisher == nullptr) return true;
+
     auto bytesSent = this->robotFeedbackPublisher->publish(feedback);
-    this->statistics.feedbackBytesSent += bytesSent;
+    if (bytesSent > 0) {
+        this->counters.addFeedbackBytesSent(bytesSent);
+    } else {
+        this->counters.incrementFeedbackPacketsDropped();
+    }
     return bytesSent > 0;
 }
 
-void RobotHub::handleSimulationConfigurationFeedback(const simulation::ConfigurationFeedback &configFeedback) {
+void RobotHub::handleSimulationConfigurationFeedback(const simulation::ConfigurationFeedback &configFeedback, simulation::ConfigurationCache &configurationCache) {
     this->handleSimulationErrors(configFeedback.simulationErrors);
-}
 
-void RobotHub::handleRobotStateInfo(const REM_RobotStateInfo& info, rtt::Team team) {
-    // if (this->logger.has_value()) { this->logger->logRobotStateInfo(info, team); }
+    // We can not tell which part of the configuration failed, so send all robot properties again
+    if (!configFeedback.simulationErrors.empty()) configurationCache.forgetAppliedRobotProperties();
 }
 
 void RobotHub::handleBasestationLog(const std::string &basestationLogMessage, rtt::Team team) {
-    // if (this->logger.has_value()) { this->logger->logInfo("[" + teamToString(team) + "] " + basestationLogMessage); }
     RTT_DEBUG("Basestation ", teamToString(team), ": ", basestationLogMessage)
 }
 
+void RobotHub::handleIncomingBasestationPacket(const uint8_t *packet, std::size_t size, rtt::Team team) {
+    // Log everything the basestations send, including packets RobotHub itself does not handle
+    if (this->logger != nullptr) this->logger->logREM(packet, size, team);
+    if (this->capture != nullptr) this->capture->captureBasestationPacket(packet, size, team);
+}
+
 void RobotHub::handleSimulationErrors(const std::vector<simulation::SimulationError> &errors) {
     for (const auto& error : errors) {
-        std::string message;
-        if (error.code.has_value() && error.message.has_value())
-            message = "Received Simulation error ", error.code.value(), ": ", error.message.value();
-        else if (error.code.has_value())
-            message = "Received Simulation error with code: ", error.code.value();
-        else if (error.message.has_value())
-            message = "Received Simulation error: ", error.message.value();
-        else
-            message = "Received unknown Simulation error";
-
-        RTT_ERROR(message);
-        // if (this->logger.has_value()) { this->logger->logInfo("WARNING: " + message); }
+        this->counters.incrementSimulationErrorsReceived();
+
+        // Persistent errors arrive with every packet, so only report them once in a while
+        this->simulationErrorAggregator->addError(error);
     }
 }
 
 const char *FailedToInitializeNetworkersException::what() const noexcept { return "Failed to initialize networker(s). Is another RobotHub running?"; }
 
 }  // namespace rtt::robothub
-
-int main(int argc, char *argv[]) {
-    auto itLog = std::find(argv, argv + argc, std::string("-log"));
-    // bool shouldLog = itLog != argv + argc;
-
-    auto itMarple = std::find(argv, argv + argc, std::string("-marple"));
-    bool logForMarple = itMarple != argv + argc;
-
-    // if (logForMarple) shouldLog = true; // Log for marple means to log
-
-    // rtt::robothub::RobotHub app(shouldLog, logForMarple);
-    rtt::robothub::RobotHub app(false, false);
-
-    while (true) {
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-        app.getStatistics().print();
-        app.resetStatistics();
-    }
-}
\ No newline at end of file
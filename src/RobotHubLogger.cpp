@@ -1,96 +1,223 @@
+#include <REM_BaseTypes.h>
+#include <fcntl.h>
+#include <roboteam_utils/Print.h>
+#include <roboteam_utils/Time.h>
+#include <unistd.h>
+#include <zlib.h>
+
 #include <RobotHubLogger.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 
-#include <thread>
+namespace rtt::robothub {
 
-#include <REM_BaseTypes.h>
-#include <REM_Packet.h>
-#include <REM_RobotCommand.h>
-#include <REM_RobotFeedback.h>
+// Blocks are kept small enough that finding a moment in a file never needs much more than a second of records
+constexpr std::size_t BLOCK_SIZE = 256 * 1024;                    // Uncompressed bytes in a block
+constexpr std::chrono::milliseconds MAX_BLOCK_AGE(1000);          // A block that is not full yet is written after this time
+constexpr std::chrono::milliseconds IDLE_WRITER_COOLDOWN(2);      // Sleep of the writer when the ring was empty
+constexpr std::size_t MAX_RECORD_SIZE = REMBIN_RECORD_HEADER_SIZE + MAX_LOGGED_PACKET_SIZE;
+constexpr int COMPRESSION_LEVEL = Z_BEST_SPEED;                   // Logs compress well enough already, speed matters more
 
-#include <roboteam_utils/Time.h>
-#include <roboteam_utils/Format.hpp>
+static uint8_t toRembinTeam(rtt::Team team) { return team == rtt::Team::BLUE ? REMBIN_TEAM_BLUE : REMBIN_TEAM_YELLOW; }
 
-namespace rtt {
+uint64_t getLogTimestampUs() {
+    auto sinceEpoch = std::chrono::system_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(sinceEpoch).count());
+}
 
-RobotHubLogger::RobotHubLogger(std::string filename) : filename(filename) {
+RobotHubLogger::RobotHubLogger(const RobotHubLoggerConfiguration& configuration) : configuration(configuration), ring(configuration.ringCapacity) {
+    this->loggedPackets = 0;
+    this->droppedPackets = 0;
 
-    filestream.open(filename, std::ios::out | std::ios::binary);
-    
-    if (!filestream.is_open()) {
-        throw std::runtime_error("Could not open log file " + filename);
-    }
-}
+    this->file = -1;
+    this->fileIndex = 0;
+    this->block.reserve(BLOCK_SIZE + MAX_RECORD_SIZE);
+    this->compressedBlock.resize(REMBIN_BLOCK_HEADER_SIZE + compressBound(BLOCK_SIZE + MAX_RECORD_SIZE));
+
+    // Open the first file here, so a wrong directory is noticed at startup
+    this->openNextFile();
 
-void RobotHubLogger::writeREM(REM_PacketPayload* packet){
-    uint64_t timestamp = static_cast<uint64_t>( Time::now().asMilliSeconds() );
-    writeREM(packet, timestamp);
+    this->shouldWrite = true;
+    this->writerThread = std::thread(&RobotHubLogger::write, this);
 }
 
-void RobotHubLogger::writeREM(REM_PacketPayload* packetPayload, uint64_t timestamp){
-    write((uint8_t*) packetPayload, REM_Packet_get_payloadSize(packetPayload), timestamp);
+RobotHubLogger::~RobotHubLogger() {
+    this->shouldWrite = false;
+    if (this->writerThread.joinable()) this->writerThread.join();
+
+    // Write whatever was logged after the writer thread stopped
+    while (true) {
+        bool drainedAny = this->drainRing();
+        if (this->block.size() >= BLOCK_SIZE) {
+            this->writeBlock();
+        } else if (!drainedAny) {
+            break;
+        }
+    }
+    this->writeBlock();
+    this->closeFile();
+
+    RTT_INFO("Logged ", this->getLoggedPackets(), " REM packets, dropped ", this->getDroppedPackets())
 }
 
-void RobotHubLogger::write(uint8_t* byte_buffer, uint32_t size, uint64_t timestamp){
-    // Write the uint64_t timestamp to the file using reinterpret_casts
-    // TODO Check if this is written in little endian
-    filestream.write(reinterpret_cast<char*>(&timestamp), sizeof(uint64_t));
-    // Write the packet
-    filestream.write((char*) byte_buffer, size);
+bool RobotHubLogger::logREM(const uint8_t* packet, std::size_t size, rtt::Team team) { return this->logREM(packet, size, team, getLogTimestampUs()); }
+
+bool RobotHubLogger::logREM(const uint8_t* packet, std::size_t size, rtt::Team team, uint64_t timestampUs) {
+    if (size > MAX_LOGGED_PACKET_SIZE) {
+        this->droppedPackets.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    bool isPushed = this->ring.tryPush([&](LoggedPacket& loggedPacket) {
+        loggedPacket.timestampUs = timestampUs;
+        loggedPacket.size = static_cast<uint16_t>(size);
+        loggedPacket.team = toRembinTeam(team);
+        std::memcpy(loggedPacket.packet, packet, size);
+    });
+    if (!isPushed) {
+        // The writer fell behind so far that the ring is full
+        this->droppedPackets.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    this->loggedPackets.fetch_add(1, std::memory_order_relaxed);
+    return true;
 }
 
-} // namespace rtt
+uint64_t RobotHubLogger::getLoggedPackets() const { return this->loggedPackets.load(std::memory_order_relaxed); }
 
-/*int main(int argc, char **argv) {
+uint64_t RobotHubLogger::getDroppedPackets() const { return this->droppedPackets.load(std::memory_order_relaxed); }
 
-    std::string timeString = Time::getDate('-') + "_" + Time::getTime('-');
-    std::string filename = "robothub_log_" + timeString + ".rembin";
+void RobotHubLogger::write() {
+    auto blockStart = std::chrono::steady_clock::now();
 
-    rtt::RobotHubLogger logger("logfile.rembin");
+    while (this->shouldWrite) {
+        bool drainedAny = this->drainRing();
+        bool blockIsFull = this->block.size() >= BLOCK_SIZE;
 
-    REM_Packet packet;
-    packet.header = REM_PACKET_TYPE_REM_PACKET;
-    packet.fromPC = 1;
-    packet.toPC = 1;
-    packet.remVersion = REM_LOCAL_VERSION;
-    packet.payloadSize = REM_PACKET_SIZE_REM_PACKET;
+        auto now = std::chrono::steady_clock::now();
+        if (blockIsFull || (!this->block.empty() && now - blockStart >= MAX_BLOCK_AGE)) {
+            this->writeBlock();
+            blockStart = now;
+        }
 
-    REM_PacketPayload payload;
-    encodeREM_Packet(&payload, &packet);
-    logger.writeREM(&payload);
+        if (!drainedAny && !blockIsFull) std::this_thread::sleep_for(IDLE_WRITER_COOLDOWN);
+    }
+}
 
-    REM_RobotCommand command;
-    command.header = REM_PACKET_TYPE_REM_ROBOT_COMMAND;
-    command.fromPC = 1;
-    command.toPC = 1;
-    command.remVersion = REM_LOCAL_VERSION;
-    command.payloadSize = REM_PACKET_SIZE_REM_ROBOT_COMMAND;
+bool RobotHubLogger::drainRing() {
+    bool drainedAny = false;
+
+    // Stop once the block is full, so it never grows beyond one record past the block size
+    while (this->block.size() < BLOCK_SIZE) {
+        bool isPopped = this->ring.tryPop([this](const LoggedPacket& loggedPacket) {
+            appendLittleEndian(this->block, loggedPacket.timestampUs, 8);
+            appendLittleEndian(this->block, loggedPacket.team, 1);
+            appendLittleEndian(this->block, loggedPacket.size, 2);
+            this->block.insert(this->block.end(), loggedPacket.packet, loggedPacket.packet + loggedPacket.size);
+            this->blockSummary.addRecord(loggedPacket.timestampUs, loggedPacket.team, loggedPacket.packet, loggedPacket.size);
+        });
+        if (!isPopped) break;
+        drainedAny = true;
+    }
 
-    REM_RobotCommandPayload commandPayload;
-    encodeREM_RobotCommand(&commandPayload, &command);
+    return drainedAny;
+}
 
-    REM_RobotFeedback feedback;
-    feedback.header = REM_PACKET_TYPE_REM_ROBOT_FEEDBACK;
-    feedback.fromPC = 1;
-    feedback.toPC = 1;
-    feedback.remVersion = REM_LOCAL_VERSION;
-    feedback.payloadSize = REM_PACKET_SIZE_REM_ROBOT_FEEDBACK;
+void RobotHubLogger::writeBlock() {
+    if (this->block.empty()) return;
+
+    bool fileIsFull = this->fileBytes + this->block.size() > this->configuration.maxFileBytes;
+    bool fileIsOld = std::chrono::steady_clock::now() - this->fileStart >= this->configuration.maxFileDuration;
+    if (fileIsFull || fileIsOld) {
+        this->closeFile();
+        try {
+            this->openNextFile();
+        } catch (const FailedToOpenLogFileException& e) {
+            RTT_ERROR(e.what(), ". Dropping logged packets")
+        }
+    }
 
-    REM_RobotFeedbackPayload feedbackPayload;
-    encodeREM_RobotFeedback(&feedbackPayload, &feedback);
-    
-    for (int i = 0; i < 100; i++) {
-        logger.writeREM(&payload);
+    // Compress behind the space of the block header, so the whole block is written at once
+    uLongf compressedSize = this->compressedBlock.size() - REMBIN_BLOCK_HEADER_SIZE;
+    int result = compress2(this->compressedBlock.data() + REMBIN_BLOCK_HEADER_SIZE, &compressedSize, this->block.data(), this->block.size(), COMPRESSION_LEVEL);
+
+    if (result == Z_OK) {
+        std::vector<uint8_t> blockHeader;
+        appendLittleEndian(blockHeader, compressedSize, 4);
+        appendLittleEndian(blockHeader, this->block.size(), 4);
+        appendLittleEndian(blockHeader, this->blockSummary.records, 4);
+        appendLittleEndian(blockHeader, crc32(0, this->compressedBlock.data() + REMBIN_BLOCK_HEADER_SIZE, compressedSize), 4);
+        std::copy(blockHeader.begin(), blockHeader.end(), this->compressedBlock.begin());
+
+        if (this->file >= 0) {
+            this->blockSummary.offset = this->fileBytes;
+            appendIndexEntry(this->index, this->blockSummary);
+        }
+        this->writeToFile(this->compressedBlock.data(), REMBIN_BLOCK_HEADER_SIZE + compressedSize);
+    } else {
+        RTT_ERROR("Failed to compress log block (zlib error ", result, "). Dropping ", this->blockSummary.records, " logged packets")
+    }
 
-        REM_RobotCommand_set_messageId(&commandPayload, i);
-        REM_RobotFeedback_set_messageId(&feedbackPayload, i);
+    this->block.clear();
+    this->blockSummary.clear();
+}
 
-        logger.writeREM((REM_PacketPayload*) &commandPayload);
-        logger.writeREM((REM_PacketPayload*) &feedbackPayload);
+void RobotHubLogger::writeToFile(const uint8_t* data, std::size_t size) {
+    std::size_t written = 0;
+    while (this->file >= 0 && written < size) {
+        ssize_t result = ::write(this->file, data + written, size - written);
+        if (result < 0) {
+            if (errno == EINTR) continue;
+            RTT_ERROR("Failed to write to log file: ", std::strerror(errno))
+            break;
+        }
+        written += static_cast<std::size_t>(result);
+    }
+    this->fileBytes += written;
+}
 
-        // Sleep between 1 and 5 milliseconds
-        std::this_thread::sleep_for(std::chrono::milliseconds(1 + (rand() % 5)));
+void RobotHubLogger::openNextFile() {
+    std::string timeString = Time::getDate('-') + "_" + Time::getTime('-');
+    std::string path = this->configuration.directory + "/" + this->configuration.filePrefix + "_" + timeString + "_" + std::to_string(this->fileIndex) + ".rembin";
+    this->fileIndex++;
 
+    this->file = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (this->file < 0) {
+        throw FailedToOpenLogFileException("Could not open log file " + path + ": " + std::strerror(errno));
     }
+    this->fileStart = std::chrono::steady_clock::now();
+    this->fileBytes = 0;
+
+    std::vector<uint8_t> header(std::begin(REMBIN_MAGIC), std::end(REMBIN_MAGIC));
+    appendLittleEndian(header, REMBIN_FORMAT_VERSION, 2);
+    appendLittleEndian(header, REMBIN_HEADER_SIZE, 2);
+    appendLittleEndian(header, REM_LOCAL_VERSION, 4);
+    appendLittleEndian(header, getLogTimestampUs(), 8);
+    this->writeToFile(header.data(), header.size());
+
+    RTT_INFO("Logging REM packets to ", path)
+}
+
+void RobotHubLogger::closeFile() {
+    if (this->file < 0) return;
+
+    uint64_t indexOffset = this->fileBytes;
+    std::vector<uint8_t> trailer;
+    appendLittleEndian(trailer, indexOffset, 8);
+    appendLittleEndian(trailer, this->index.size() / REMBIN_INDEX_ENTRY_SIZE, 8);
+    trailer.insert(trailer.end(), std::begin(REMBIN_INDEX_MAGIC), std::end(REMBIN_INDEX_MAGIC));
+
+    this->writeToFile(this->index.data(), this->index.size());
+    this->writeToFile(trailer.data(), trailer.size());
+    this->index.clear();
+
+    close(this->file);
+    this->file = -1;
+}
+
+FailedToOpenLogFileException::FailedToOpenLogFileException(const std::string& message) : message(message) {}
+const char* FailedToOpenLogFileException::what() const noexcept { return this->message.c_str(); }
 
-    return 0;
-}*/
\ No newline at end of file
+}  // namespace rtt::robothub
@@ -0,0 +1,212 @@
+#include <MetricsServer.hpp>
+#include <RobotHub.h>
+#include <StatisticsHistory.hpp>
+#include <roboteam_utils/Print.h>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <thread>
+
+constexpr std::size_t DEFAULT_STATISTICS_HISTORY_SECONDS = 30 * 60;
+const std::string DEFAULT_STATISTICS_HISTORY_FILE = "robothub_statistics.csv";
+const std::string DEFAULT_BASESTATION_CHANNEL_MAP_FILE = "robothub_basestation_channels.txt";
+constexpr double MAX_IMPAIRMENT_DELAY_MS = 10000.0;   // Longer delays are surely a typo
+constexpr double MAX_IMPAIRMENT_BANDWIDTH = 1.0e9;    // In bytes per second
+
+// Set by the signal handlers, and handled by the main loop
+std::atomic<bool> shouldDumpStatisticsHistory = false;
+std::atomic<bool> shouldStop = false;
+
+void dumpStatisticsHistory(const rtt::robothub::StatisticsHistory &history, const std::string &path) {
+    if (!history.dumpToFile(path)) {
+        RTT_ERROR("Failed to write statistics history to ", path)
+        return;
+    }
+
+    auto yellowDrops = history.summarize(&rtt::robothub::StatisticsSample::yellowTeamPacketsDropped, std::chrono::seconds::max());
+    auto blueDrops = history.summarize(&rtt::robothub::StatisticsSample::blueTeamPacketsDropped, std::chrono::seconds::max());
+    RTT_INFO("Wrote ", history.size(), " seconds of statistics to ", path, ". Most packets dropped in one second: yellow ", yellowDrops.max, ", blue ", blueDrops.max)
+}
+
+// Returns the value that follows the given flag, if the flag was given
+std::optional<std::string> getArgumentValue(int argc, char *argv[], const std::string &flag) {
+    auto it = std::find(argv, argv + argc, flag);
+    if (it == argv + argc || it + 1 == argv + argc) return std::nullopt;
+    return std::string(*(it + 1));
+}
+
+// Returns the number that follows the given flag, or the default if the flag was not given. Stops RobotHub if it is not a number in the range
+template <typename Number>
+Number getNumericArgumentValue(int argc, char *argv[], const std::string &flag, Number defaultValue, Number minimum, Number maximum) {
+    auto value = getArgumentValue(argc, argv, flag);
+    if (!value.has_value()) return defaultValue;
+
+    Number number;
+    const char *end = value->data() + value->size();
+    auto [parsedUntil, error] = std::from_chars(value->data(), end, number);
+    if (error != std::errc() || parsedUntil != end || number < minimum || number > maximum) {
+        RTT_ERROR("Invalid value '", value.value(), "' for ", flag, ". Expected a number from ", minimum, " to ", maximum)
+        std::exit(EXIT_FAILURE);
+    }
+    return number;
+}
+
+// Impairment is enabled with -impair. Flags like -impair-loss apply to both teams, and flags like -impair-blue-loss override them for one team
+rtt::robothub::simulation::LinkImpairmentSettings getTeamLinkImpairment(int argc, char *argv[], const std::string &team) {
+    auto getSetting = [&](const std::string &setting, double maximum) {
+        double bothTeams = getNumericArgumentValue(argc, argv, "-impair-" + setting, 0.0, 0.0, maximum);
+        return getNumericArgumentValue(argc, argv, "-impair-" + team + "-" + setting, bothTeams, 0.0, maximum);
+    };
+
+    rtt::robothub::simulation::LinkImpairmentSettings settings;
+    settings.lossProbability = getSetting("loss", 1.0);
+    settings.latency = std::chrono::microseconds(static_cast<int64_t>(1000 * getSetting("latency-ms", MAX_IMPAIRMENT_DELAY_MS)));
+    settings.jitter = std::chrono::microseconds(static_cast<int64_t>(1000 * getSetting("jitter-ms", MAX_IMPAIRMENT_DELAY_MS)));
+    settings.reorderProbability = getSetting("reorder", 1.0);
+    settings.bandwidthBytesPerSecond = static_cast<std::size_t>(getSetting("bandwidth", MAX_IMPAIRMENT_BANDWIDTH));
+    return settings;
+}
+
+std::optional<rtt::robothub::simulation::SimulatorLinkImpairment> getLinkImpairment(int argc, char *argv[]) {
+    if (std::find(argv, argv + argc, std::string("-impair")) == argv + argc) return std::nullopt;
+
+    return rtt::robothub::simulation::SimulatorLinkImpairment{.blue = getTeamLinkImpairment(argc, argv, "blue"),
+                                                             .yellow = getTeamLinkImpairment(argc, argv, "yellow"),
+                                                             .seed = getNumericArgumentValue<uint64_t>(argc, argv, "-impair-seed", 0, 0, UINT64_MAX)};
+}
+
+// Feeds all inputs of a capture into the hub, at the pace they were captured or as fast as possible
+void replayCapture(rtt::robothub::RobotHub &app, const std::string &path, bool asFastAsPossible) {
+    try {
+        rtt::robothub::HubCaptureReader reader(path);
+        rtt::robothub::CapturedInput input;
+        int replayedInputs = 0;
+        auto start = std::chrono::steady_clock::now();
+
+        while (!shouldStop && reader.readNext(input)) {
+            if (!asFastAsPossible) std::this_thread::sleep_until(start + input.sinceStart);
+
+            switch (input.type) {
+                case rtt::robothub::CaptureInputType::ROBOT_COMMANDS:
+                    app.submitRobotCommands(rtt::robothub::deserializeRobotCommands(input.payload), input.team);
+                    break;
+                case rtt::robothub::CaptureInputType::SETTINGS: {
+                    proto::Setting settings;
+                    if (settings.ParseFromString(input.payload)) app.submitSettings(settings);
+                    break;
+                }
+                case rtt::robothub::CaptureInputType::SIMULATION_CONFIGURATION: {
+                    proto::SimulationConfiguration configuration;
+                    if (configuration.ParseFromString(input.payload)) app.submitSimulationConfiguration(configuration);
+                    break;
+                }
+                case rtt::robothub::CaptureInputType::BASESTATION_PACKET:
+                    app.submitBasestationPacket(reinterpret_cast<const uint8_t *>(input.payload.data()), input.payload.size(), input.team);
+                    break;
+                default:
+                    RTT_WARNING("Skipping input of unknown type ", static_cast<int>(input.type))
+                    continue;
+            }
+            replayedInputs++;
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        RTT_INFO("Replayed ", replayedInputs, " inputs from ", path, " in ", seconds, " s")
+    } catch (const rtt::robothub::FailedToOpenCaptureException &e) {
+        RTT_ERROR(e.what())
+    }
+}
+
+int main(int argc, char *argv[]) {
+    auto itLog = std::find(argv, argv + argc, std::string("-log"));
+    bool shouldLog = itLog != argv + argc;
+
+    rtt::robothub::SimulatorSessionConfiguration defaultSession = {
+        .networkConfiguration = {.blueFeedbackPort = rtt::robothub::DEFAULT_GRSIM_FEEDBACK_PORT_BLUE_CONTROL,
+                                 .yellowFeedbackPort = rtt::robothub::DEFAULT_GRSIM_FEEDBACK_PORT_YELLOW_CONTROL,
+                                 .configurationFeedbackPort = rtt::robothub::DEFAULT_GRSIM_FEEDBACK_PORT_CONFIGURATION,
+                                 .linkImpairment = getLinkImpairment(argc, argv)}};
+
+    rtt::robothub::RobotHubConfiguration configuration = {.shouldLog = shouldLog, .simulatorSessions = {defaultSession}};
+    configuration.loggerConfiguration.directory = getArgumentValue(argc, argv, "-log-dir").value_or(configuration.loggerConfiguration.directory);
+    configuration.sendWheelVelocitiesToSimulator = std::find(argv, argv + argc, std::string("-wheel-velocities")) != argv + argc;
+    configuration.keepBasestationsWarm = std::find(argv, argv + argc, std::string("-warm-basestations")) != argv + argc;
+    configuration.basestationChannelMapFile = getArgumentValue(argc, argv, "-channel-map").value_or(DEFAULT_BASESTATION_CHANNEL_MAP_FILE);
+    if (std::find(argv, argv + argc, std::string("-shared-feedback")) != argv + argc) configuration.sharedFeedbackName = rtt::robothub::DEFAULT_SHARED_FEEDBACK_NAME;
+    if (std::find(argv, argv + argc, std::string("-shared-commands")) != argv + argc) {
+        configuration.sharedYellowCommandsName = rtt::robothub::DEFAULT_SHARED_YELLOW_COMMANDS_NAME;
+        configuration.sharedBlueCommandsName = rtt::robothub::DEFAULT_SHARED_BLUE_COMMANDS_NAME;
+    }
+
+    // Without a tuning file, all threads keep the normal scheduler. The threads tune themselves when they start, so this
+    // is configured before RobotHub creates any of them
+    auto threadTuningFile = getArgumentValue(argc, argv, "-thread-tuning");
+    if (threadTuningFile.has_value()) {
+        auto threadTuning = rtt::robothub::loadThreadTuningConfiguration(threadTuningFile.value());
+        if (threadTuning.has_value()) rtt::robothub::configureThreadTuning(threadTuning.value());
+    }
+
+    // A replay takes the place of the networkers and the basestations
+    configuration.captureFile = getArgumentValue(argc, argv, "-capture").value_or("");
+    auto replayFile = getArgumentValue(argc, argv, "-replay");
+    if (replayFile.has_value()) {
+        configuration.useStandInBasestations = true;
+        configuration.listenToNetworkers = false;
+    }
+
+    int metricsPort = getNumericArgumentValue(argc, argv, "-metrics-port", rtt::robothub::DEFAULT_METRICS_PORT, 1, 65535);
+    std::size_t historySeconds = getNumericArgumentValue<std::size_t>(argc, argv, "-history-seconds", DEFAULT_STATISTICS_HISTORY_SECONDS, 1, SIZE_MAX);
+
+    // Started before RobotHub, so a port that is in use stops the program before it drives any robots
+    std::unique_ptr<rtt::robothub::MetricsServer> metricsServer;
+    if (getArgumentValue(argc, argv, "-metrics-port").has_value() || std::find(argv, argv + argc, std::string("-metrics")) != argv + argc) {
+        try {
+            metricsServer = std::make_unique<rtt::robothub::MetricsServer>(metricsPort);
+        } catch (const rtt::robothub::FailedToStartMetricsServerException &e) {
+            RTT_ERROR(e.what())
+            return EXIT_FAILURE;
+        }
+    }
+
+    rtt::robothub::RobotHub app(configuration);
+
+    // The terminal view and the metrics endpoint both consume the same statistics snapshot
+    bool shouldPrintStatistics = std::find(argv, argv + argc, std::string("-no-print")) == argv + argc;
+
+    // The history is dumped on SIGUSR1 and when stopping
+    std::string historyFile = getArgumentValue(argc, argv, "-history-file").value_or(DEFAULT_STATISTICS_HISTORY_FILE);
+    rtt::robothub::StatisticsHistory history(historySeconds);
+    std::signal(SIGUSR1, [](int) { shouldDumpStatisticsHistory = true; });
+    std::signal(SIGINT, [](int) { shouldStop = true; });
+    std::signal(SIGTERM, [](int) { shouldStop = true; });
+
+    std::thread replayThread;
+    if (replayFile.has_value()) {
+        bool asFastAsPossible = std::find(argv, argv + argc, std::string("-replay-fast")) != argv + argc;
+        replayThread = std::thread([&] {
+            replayCapture(app, replayFile.value(), asFastAsPossible);
+            shouldStop = true;
+        });
+    }
+
+    while (!shouldStop) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        const auto &statistics = app.getStatistics();
+        history.add(statistics);
+        if (metricsServer != nullptr) metricsServer->setMetrics(statistics.toPrometheusText());
+        if (shouldPrintStatistics) statistics.print();
+        app.resetStatistics();
+
+        if (shouldDumpStatisticsHistory.exchange(false)) dumpStatisticsHistory(history, historyFile);
+    }
+
+    if (replayThread.joinable()) replayThread.join();
+    dumpStatisticsHistory(history, historyFile);
+    return 0;
+}
\ No newline at end of file
@@ -3,10 +3,14 @@
 
 #include <RobotHubStatistics.hpp>
 #include <chrono>
+#include <numeric>
 #include <sstream>
 
 namespace rtt::robothub {
 
+// Names of the latency stages in the metrics, in the order of LatencyStage
+constexpr std::array<const char*, AMOUNT_OF_LATENCY_STAGES> LATENCY_STAGE_METRIC_NAMES = {"command_enqueue", "command_conversion", "command_write", "command_total", "feedback_publish"};
+
 RobotHubStatistics::RobotHubStatistics() {
     this->startTime = std::chrono::steady_clock::now();
 
@@ -22,6 +26,8 @@ RobotHubStatistics::RobotHubStatistics() {
     this->yellowTeamPacketsDropped = 0;
     this->blueTeamPacketsDropped = 0;
     this->feedbackPacketsDropped = 0;
+    this->simulationErrorsReceived = 0;
+    this->distinctSimulationErrors = 0;
 }
 
 void RobotHubStatistics::resetValues() {
@@ -36,6 +42,11 @@ void RobotHubStatistics::resetValues() {
     this->yellowTeamPacketsDropped = 0;
     this->blueTeamPacketsDropped = 0;
     this->feedbackPacketsDropped = 0;
+    this->simulationErrorsReceived = 0;
+    this->yellowSimulatorRoundTrip = {};
+    this->blueSimulatorRoundTrip = {};
+    this->stageLatencies = {};
+    this->schedulerJitter = {};
 }
 
 void RobotHubStatistics::print() const {
@@ -66,18 +77,127 @@ void RobotHubStatistics::print() const {
        << "┃" << b[1] << " │" << b[5] << " │ " << b[9] << " │ " << b[13] << " ┃ Yellow team: " << this->numberToSideBox(this->yellowTeamPacketsDropped) << " ┃" << std::endl
        << "┃" << b[2] << " │" << b[6] << " │ " << b[10] << " │ " << b[14] << " ┃ Blue team:   " << this->numberToSideBox(this->blueTeamPacketsDropped) << " ┃" << std::endl
        << "┃" << b[3] << " │" << b[7] << " │ " << b[11] << " │ " << b[15] << " ┃ Feedback:    " << this->numberToSideBox(this->feedbackPacketsDropped) << " ┃" << std::endl
-       << "┗━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┻━━━━━━━━━━━━━━━━━━━━━━┛" << std::endl;
+       << "┣━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┻━━━━━━━━━━━━━━━━━━━━━━┫" << std::endl
+       << "┃ " << this->getSimulationErrors() << " ┃" << std::endl
+       << "┃ " << this->getBasestationColdPathDrops() << " ┃" << std::endl
+       << "┃ " << getSimulatorRoundTrip(this->yellowSimulatorRoundTrip, rtt::Team::YELLOW) << " ┃" << std::endl
+       << "┃ " << getSimulatorRoundTrip(this->blueSimulatorRoundTrip, rtt::Team::BLUE) << " ┃" << std::endl
+       << "┃ " << this->getStageLatency(LatencyStage::COMMAND_ENQUEUE) << " ┃" << std::endl
+       << "┃ " << this->getStageLatency(LatencyStage::COMMAND_CONVERSION) << " ┃" << std::endl
+       << "┃ " << this->getStageLatency(LatencyStage::COMMAND_WRITE) << " ┃" << std::endl
+       << "┃ " << this->getStageLatency(LatencyStage::COMMAND_TOTAL) << " ┃" << std::endl
+       << "┃ " << this->getStageLatency(LatencyStage::FEEDBACK_PUBLISH) << " ┃" << std::endl
+       << "┃ " << this->getSchedulerJitter(ThreadRole::USB) << " ┃" << std::endl
+       << "┃ " << this->getSchedulerJitter(ThreadRole::SIMULATOR) << " ┃" << std::endl
+       << "┗━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┛" << std::endl;
 
     RTT_INFO("\n", ss.str())
 }
 
-void RobotHubStatistics::incrementCommandsReceivedCounter(int id, rtt::Team color) {
-    auto& arrayToIncrement = color == rtt::Team::YELLOW ? this->yellowCommandsSent : this->blueCommandsSent;
-    arrayToIncrement[id]++;
+std::string RobotHubStatistics::toPrometheusText() const {
+    std::stringstream ss;
+
+    auto metric = [&](const std::string& name, const std::string& type, const std::string& help) {
+        ss << "# HELP " << name << " " << help << "\n# TYPE " << name << " " << type << "\n";
+    };
+    auto teamLabel = [](rtt::Team team) { return team == rtt::Team::YELLOW ? "yellow" : "blue"; };
+    auto quantiles = [&](const std::string& name, const std::string& labels, const LatencySummary& latency) {
+        ss << name << "{" << labels << ",quantile=\"0.5\"} " << latency.p50Us << "\n";
+        ss << name << "{" << labels << ",quantile=\"0.99\"} " << latency.p99Us << "\n";
+        ss << name << "{" << labels << ",quantile=\"0.999\"} " << latency.p999Us << "\n";
+        ss << name << "{" << labels << ",quantile=\"1\"} " << latency.maxUs << "\n";
+    };
+
+    metric("robothub_uptime_seconds", "gauge", "Time since RobotHub started");
+    ss << "robothub_uptime_seconds " << std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - this->startTime).count() << "\n";
+
+    metric("robothub_mode", "gauge", "Whether RobotHub is in the mode");
+    for (auto mode : {utils::RobotHubMode::NEITHER, utils::RobotHubMode::SIMULATOR, utils::RobotHubMode::BASESTATION}) {
+        ss << "robothub_mode{mode=\"" << utils::modeToString(mode) << "\"} " << (mode == this->robotHubMode ? 1 : 0) << "\n";
+    }
+
+    metric("robothub_basestations_connected", "gauge", "Amount of connected basestations");
+    ss << "robothub_basestations_connected " << this->basestationManagerStatus.basestationCollection.amountOfBasestations << "\n";
+
+    metric("robothub_basestation_cold_path_drops_total", "counter", "Commands dropped because no basestation was selected for the team");
+    ss << "robothub_basestation_cold_path_drops_total{team=\"yellow\"} " << this->basestationManagerStatus.basestationCollection.yellowColdPathDrops << "\n";
+    ss << "robothub_basestation_cold_path_drops_total{team=\"blue\"} " << this->basestationManagerStatus.basestationCollection.blueColdPathDrops << "\n";
+
+    metric("robothub_bytes_sent_total", "counter", "Bytes of commands sent");
+    ss << "robothub_bytes_sent_total{team=\"yellow\"} " << this->totals.yellow.bytesSent << "\n";
+    ss << "robothub_bytes_sent_total{team=\"blue\"} " << this->totals.blue.bytesSent << "\n";
+
+    metric("robothub_packets_dropped_total", "counter", "Command packets that could not be sent");
+    ss << "robothub_packets_dropped_total{team=\"yellow\"} " << this->totals.yellow.packetsDropped << "\n";
+    ss << "robothub_packets_dropped_total{team=\"blue\"} " << this->totals.blue.packetsDropped << "\n";
+
+    metric("robothub_feedback_bytes_sent_total", "counter", "Bytes of feedback published");
+    ss << "robothub_feedback_bytes_sent_total " << this->totals.feedbackBytesSent << "\n";
+    metric("robothub_feedback_packets_dropped_total", "counter", "Feedback that could not be published");
+    ss << "robothub_feedback_packets_dropped_total " << this->totals.feedbackPacketsDropped << "\n";
+
+    metric("robothub_commands_received_total", "counter", "Commands received per robot");
+    for (rtt::Team team : {rtt::Team::YELLOW, rtt::Team::BLUE}) {
+        const auto& commands = team == rtt::Team::YELLOW ? this->totals.yellow.commandsReceived : this->totals.blue.commandsReceived;
+        for (int id = 0; id < MAX_ROBOT_STATISTICS; ++id) {
+            ss << "robothub_commands_received_total{team=\"" << teamLabel(team) << "\",robot=\"" << id << "\"} " << commands[id] << "\n";
+        }
+    }
+    metric("robothub_feedback_received_total", "counter", "Feedback received per robot");
+    for (rtt::Team team : {rtt::Team::YELLOW, rtt::Team::BLUE}) {
+        const auto& feedback = team == rtt::Team::YELLOW ? this->totals.yellow.feedbackReceived : this->totals.blue.feedbackReceived;
+        for (int id = 0; id < MAX_ROBOT_STATISTICS; ++id) {
+            ss << "robothub_feedback_received_total{team=\"" << teamLabel(team) << "\",robot=\"" << id << "\"} " << feedback[id] << "\n";
+        }
+    }
+
+    metric("robothub_simulation_errors_total", "counter", "Simulation errors received");
+    ss << "robothub_simulation_errors_total " << this->totals.simulationErrorsReceived << "\n";
+    metric("robothub_distinct_simulation_errors", "gauge", "Distinct simulation errors that are still occurring");
+    ss << "robothub_distinct_simulation_errors " << this->distinctSimulationErrors << "\n";
+
+    metric("robothub_simulator_round_trip_microseconds", "summary", "Round trip times to the simulator in the last interval");
+    for (rtt::Team team : {rtt::Team::YELLOW, rtt::Team::BLUE}) {
+        const auto& roundTrip = team == rtt::Team::YELLOW ? this->yellowSimulatorRoundTrip : this->blueSimulatorRoundTrip;
+        ss << "robothub_simulator_round_trip_microseconds{team=\"" << teamLabel(team) << "\",quantile=\"0.5\"} " << roundTrip.p50Us << "\n";
+        ss << "robothub_simulator_round_trip_microseconds{team=\"" << teamLabel(team) << "\",quantile=\"0.99\"} " << roundTrip.p99Us << "\n";
+        ss << "robothub_simulator_round_trip_microseconds{team=\"" << teamLabel(team) << "\",quantile=\"1\"} " << roundTrip.maxUs << "\n";
+    }
+    metric("robothub_simulator_packets_lost", "gauge", "Simulator packets without response in the last interval");
+    ss << "robothub_simulator_packets_lost{team=\"yellow\"} " << this->yellowSimulatorRoundTrip.lost << "\n";
+    ss << "robothub_simulator_packets_lost{team=\"blue\"} " << this->blueSimulatorRoundTrip.lost << "\n";
+
+    metric("robothub_stage_latency_microseconds", "summary", "Time spent in each stage of RobotHub in the last interval");
+    for (int stage = 0; stage < AMOUNT_OF_LATENCY_STAGES; ++stage) {
+        quantiles("robothub_stage_latency_microseconds", "stage=\"" + std::string(LATENCY_STAGE_METRIC_NAMES[stage]) + "\"", this->stageLatencies[stage]);
+    }
+    metric("robothub_stage_latency_samples", "gauge", "Measurements of each stage in the last interval");
+    for (int stage = 0; stage < AMOUNT_OF_LATENCY_STAGES; ++stage) {
+        ss << "robothub_stage_latency_samples{stage=\"" << LATENCY_STAGE_METRIC_NAMES[stage] << "\"} " << this->stageLatencies[stage].samples << "\n";
+    }
+
+    metric("robothub_scheduler_jitter_microseconds", "summary", "How late the timers of each thread role fired in the last interval");
+    for (int role = 0; role < AMOUNT_OF_THREAD_ROLES; ++role) {
+        // The transmit threads are woken by incoming commands instead of timers, so they have no jitter to export
+        if (static_cast<ThreadRole>(role) == ThreadRole::TRANSMIT) continue;
+        quantiles("robothub_scheduler_jitter_microseconds", "role=\"" + threadRoleToString(static_cast<ThreadRole>(role)) + "\"", this->schedulerJitter[role]);
+    }
+
+    return ss.str();
+}
+
+int RobotHubStatistics::getTotalCommandsReceived(rtt::Team color) const {
+    const auto& commands = color == rtt::Team::YELLOW ? this->yellowCommandsSent : this->blueCommandsSent;
+    return std::accumulate(commands.begin(), commands.end(), 0);
 }
-void RobotHubStatistics::incrementFeedbackReceivedCounter(int id, rtt::Team color) {
-    auto& arrayToIncrement = color == rtt::Team::YELLOW ? this->yellowFeedbackReceived : this->blueFeedbackReceived;
-    arrayToIncrement[id]++;
+
+int RobotHubStatistics::getTotalFeedbackReceived(rtt::Team color) const {
+    const auto& feedback = color == rtt::Team::YELLOW ? this->yellowFeedbackReceived : this->blueFeedbackReceived;
+    return std::accumulate(feedback.begin(), feedback.end(), 0);
+}
+
+double RobotHubStatistics::getSecondsSinceStart() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - this->startTime).count();
 }
 
 std::string RobotHubStatistics::getRobotStats(int robotId, rtt::Team team) const {
@@ -150,6 +270,56 @@ std::string RobotHubStatistics::getSelectedBasestations() const {
 
     return formatString("%-9s", basestations.c_str());
 }
+std::string RobotHubStatistics::getSimulationErrors() const {
+    std::string errors = formatString("Simulation errors: %7d   Distinct errors: %7d", this->simulationErrorsReceived, static_cast<int>(this->distinctSimulationErrors));
+    return formatString("%-70s", errors.c_str());
+}
+
+std::string RobotHubStatistics::getBasestationColdPathDrops() const {
+    const auto& collection = this->basestationManagerStatus.basestationCollection;
+    std::string drops = formatString("Dropped without selected basestation: yellow %7d   blue %7d", collection.yellowColdPathDrops, collection.blueColdPathDrops);
+    return formatString("%-70s", drops.c_str());
+}
+
+std::string RobotHubStatistics::getSimulatorRoundTrip(const simulation::RoundTripStatistics& roundTrip, rtt::Team team) {
+    std::string roundTripText = formatString("Sim RTT %-6s %5d pkts %4d lost p50 %6.0f p99 %6.0f max %6.0fus", team == rtt::Team::YELLOW ? "yellow" : "blue",
+                                             roundTrip.samples, roundTrip.lost, roundTrip.p50Us, roundTrip.p99Us, roundTrip.maxUs);
+    return formatString("%-70s", roundTripText.c_str());
+}
+
+std::string RobotHubStatistics::getStageLatency(LatencyStage stage) const {
+    std::string name;
+    switch (stage) {
+        case LatencyStage::COMMAND_ENQUEUE:
+            name = "Enqueue";
+            break;
+        case LatencyStage::COMMAND_CONVERSION:
+            name = "Convert";
+            break;
+        case LatencyStage::COMMAND_WRITE:
+            name = "Write";
+            break;
+        case LatencyStage::COMMAND_TOTAL:
+            name = "Command";
+            break;
+        case LatencyStage::FEEDBACK_PUBLISH:
+            name = "Feedback";
+            break;
+    }
+
+    const auto& latency = this->stageLatencies[static_cast<int>(stage)];
+    std::string latencyText = formatString("%-8s %6d smp p50 %6.1f p99 %6.1f p99.9 %6.1f max %7.1fus", name.c_str(), static_cast<int>(latency.samples), latency.p50Us,
+                                           latency.p99Us, latency.p999Us, latency.maxUs);
+    return formatString("%-70s", latencyText.c_str());
+}
+
+std::string RobotHubStatistics::getSchedulerJitter(ThreadRole role) const {
+    const auto& jitter = this->schedulerJitter[static_cast<int>(role)];
+    std::string jitterText = formatString("Wake %-3s %6d smp p50 %6.1f p99 %6.1f p99.9 %6.1f max %7.1fus", threadRoleToString(role).substr(0, 3).c_str(),
+                                          static_cast<int>(jitter.samples), jitter.p50Us, jitter.p99Us, jitter.p999Us, jitter.maxUs);
+    return formatString("%-70s", jitterText.c_str());
+}
+
 std::string RobotHubStatistics::numberToSideBox(int n) const { return formatString("%7d", n); }
 
 std::string RobotHubStatistics::wantedBasestationsToString(basestation::WantedBasestations wantedBasestations) {
@@ -174,4 +344,73 @@ std::string RobotHubStatistics::wantedBasestationsToString(basestation::WantedBa
     return text;
 }
 
+void RobotHubCounters::addBytesSent(rtt::Team color, std::size_t bytes) {
+    this->counters.add(color == rtt::Team::YELLOW ? YELLOW_TEAM_BYTES_SENT : BLUE_TEAM_BYTES_SENT, bytes);
+}
+void RobotHubCounters::incrementPacketsDropped(rtt::Team color) {
+    this->counters.increment(color == rtt::Team::YELLOW ? YELLOW_TEAM_PACKETS_DROPPED : BLUE_TEAM_PACKETS_DROPPED);
+}
+void RobotHubCounters::addFeedbackBytesSent(std::size_t bytes) { this->counters.add(FEEDBACK_BYTES_SENT, bytes); }
+void RobotHubCounters::incrementFeedbackPacketsDropped() { this->counters.increment(FEEDBACK_PACKETS_DROPPED); }
+void RobotHubCounters::incrementSimulationErrorsReceived() { this->counters.increment(SIMULATION_ERRORS_RECEIVED); }
+
+void RobotHubCounters::incrementCommandsReceivedCounter(int id, rtt::Team color) {
+    this->incrementRobotCounter(color == rtt::Team::YELLOW ? YELLOW_COMMANDS_SENT : BLUE_COMMANDS_SENT, id);
+}
+void RobotHubCounters::incrementFeedbackReceivedCounter(int id, rtt::Team color) {
+    this->incrementRobotCounter(color == rtt::Team::YELLOW ? YELLOW_FEEDBACK_RECEIVED : BLUE_FEEDBACK_RECEIVED, id);
+}
+
+void RobotHubCounters::incrementRobotCounter(Counter firstRobotCounter, int id) {
+    if (id < 0 || id >= MAX_ROBOT_STATISTICS) return;
+    this->counters.increment(firstRobotCounter + id);
+}
+
+void RobotHubCounters::fillStatistics(RobotHubStatistics& statistics) {
+    std::scoped_lock<std::mutex> lock(this->intervalMutex);
+
+    this->lastFill = this->counters.read();
+    this->hasFilledSinceReset = true;
+
+    auto count = [&](std::size_t counter) { return this->lastFill[counter] - this->intervalStart[counter]; };
+
+    statistics.yellowTeamBytesSent = count(YELLOW_TEAM_BYTES_SENT);
+    statistics.blueTeamBytesSent = count(BLUE_TEAM_BYTES_SENT);
+    statistics.feedbackBytesSent = count(FEEDBACK_BYTES_SENT);
+    statistics.yellowTeamPacketsDropped = static_cast<int>(count(YELLOW_TEAM_PACKETS_DROPPED));
+    statistics.blueTeamPacketsDropped = static_cast<int>(count(BLUE_TEAM_PACKETS_DROPPED));
+    statistics.feedbackPacketsDropped = static_cast<int>(count(FEEDBACK_PACKETS_DROPPED));
+    statistics.simulationErrorsReceived = static_cast<int>(count(SIMULATION_ERRORS_RECEIVED));
+
+    for (int id = 0; id < MAX_ROBOT_STATISTICS; ++id) {
+        statistics.yellowCommandsSent[id] = static_cast<int>(count(YELLOW_COMMANDS_SENT + id));
+        statistics.yellowFeedbackReceived[id] = static_cast<int>(count(YELLOW_FEEDBACK_RECEIVED + id));
+        statistics.blueCommandsSent[id] = static_cast<int>(count(BLUE_COMMANDS_SENT + id));
+        statistics.blueFeedbackReceived[id] = static_cast<int>(count(BLUE_FEEDBACK_RECEIVED + id));
+    }
+
+    auto& totals = statistics.totals;
+    totals.yellow.bytesSent = this->lastFill[YELLOW_TEAM_BYTES_SENT];
+    totals.blue.bytesSent = this->lastFill[BLUE_TEAM_BYTES_SENT];
+    totals.yellow.packetsDropped = this->lastFill[YELLOW_TEAM_PACKETS_DROPPED];
+    totals.blue.packetsDropped = this->lastFill[BLUE_TEAM_PACKETS_DROPPED];
+    totals.feedbackBytesSent = this->lastFill[FEEDBACK_BYTES_SENT];
+    totals.feedbackPacketsDropped = this->lastFill[FEEDBACK_PACKETS_DROPPED];
+    totals.simulationErrorsReceived = this->lastFill[SIMULATION_ERRORS_RECEIVED];
+    for (int id = 0; id < MAX_ROBOT_STATISTICS; ++id) {
+        totals.yellow.commandsReceived[id] = this->lastFill[YELLOW_COMMANDS_SENT + id];
+        totals.yellow.feedbackReceived[id] = this->lastFill[YELLOW_FEEDBACK_RECEIVED + id];
+        totals.blue.commandsReceived[id] = this->lastFill[BLUE_COMMANDS_SENT + id];
+        totals.blue.feedbackReceived[id] = this->lastFill[BLUE_FEEDBACK_RECEIVED + id];
+    }
+}
+
+void RobotHubCounters::reset() {
+    std::scoped_lock<std::mutex> lock(this->intervalMutex);
+
+    // Without a fill since the previous reset, nothing was reported yet, so the interval simply starts now
+    this->intervalStart = this->hasFilledSinceReset ? this->lastFill : this->counters.read();
+    this->hasFilledSinceReset = false;
+}
+
 }  // namespace rtt::robothub
\ No newline at end of file
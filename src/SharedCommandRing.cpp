@@ -0,0 +1,228 @@
+#include <SharedCommandRing.hpp>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <new>
+
+namespace rtt::robothub {
+
+constexpr char SHARED_COMMANDS_MAGIC[8] = {'R', 'T', 'T', 'C', 'M', 'R', 'N', 'G'};
+constexpr std::chrono::milliseconds CONSUMER_WAIT_TIMEOUT(100);  // How often consumers check whether they should stop
+
+static uint32_t roundUpToPowerOfTwo(uint32_t value) {
+    uint32_t powerOfTwo = 1;
+    while (powerOfTwo < value) powerOfTwo <<= 1;
+    return powerOfTwo;
+}
+
+static std::size_t getSegmentSize(uint32_t capacity) { return sizeof(SharedCommandRingHeader) + static_cast<std::size_t>(capacity) * sizeof(SharedRobotCommands); }
+
+// The futex is not private, as the processes that use it each map the segment at their own address
+static void futexWait(std::atomic<uint32_t>& word, uint32_t expectedValue, std::chrono::milliseconds timeout) {
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    struct timespec relativeTimeout = {.tv_sec = seconds.count(), .tv_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout - seconds).count()};
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expectedValue, &relativeTimeout, nullptr, 0);
+}
+
+static void futexWake(std::atomic<uint32_t>& word) { syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, 1, nullptr, nullptr, 0); }
+
+// Both sides check the ring the other side created, as they may have been built from different versions
+static void validateRing(const SharedMemorySegment& segment, const std::string& name) {
+    const auto* header = static_cast<const SharedCommandRingHeader*>(segment.getData());
+    bool isValid = segment.getSize() >= sizeof(SharedCommandRingHeader) && std::memcmp(header->magic, SHARED_COMMANDS_MAGIC, sizeof(SHARED_COMMANDS_MAGIC)) == 0;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    isValid = isValid && header->version == SHARED_COMMANDS_VERSION && header->slotSize == sizeof(SharedRobotCommands) && header->capacity > 0 &&
+              (header->capacity & (header->capacity - 1)) == 0 && segment.getSize() >= getSegmentSize(header->capacity);
+    if (!isValid) throw FailedToOpenSharedMemoryException(name + " does not contain a command ring of version " + std::to_string(SHARED_COMMANDS_VERSION));
+}
+
+bool toSharedRobotCommands(const rtt::RobotCommands& commands, SharedRobotCommands& sharedCommands) {
+    auto amount = std::min<std::size_t>(commands.size(), MAX_SHARED_ROBOT_COMMANDS);
+    sharedCommands.timestampNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    sharedCommands.amountOfCommands = static_cast<uint32_t>(amount);
+    sharedCommands.reserved = 0;
+
+    for (std::size_t i = 0; i < amount; i++) {
+        const auto& command = commands[i];
+        sharedCommands.commands[i] = {.id = command.id,
+                                      .useAngularVelocity = command.useAngularVelocity,
+                                      .cameraAngleOfRobotIsSet = command.cameraAngleOfRobotIsSet,
+                                      .waitForBall = command.waitForBall,
+                                      .kickType = static_cast<uint8_t>(command.kickType),
+                                      .kickAtAngle = command.kickAtAngle,
+                                      .ignorePacket = command.ignorePacket,
+                                      .reserved = {0, 0},
+                                      .velocityX = command.velocity.x,
+                                      .velocityY = command.velocity.y,
+                                      .targetAngle = command.targetAngle.getValue(),
+                                      .targetAngularVelocity = command.targetAngularVelocity,
+                                      .cameraAngleOfRobot = command.cameraAngleOfRobot,
+                                      .kickSpeed = command.kickSpeed,
+                                      .dribblerSpeed = command.dribblerSpeed};
+    }
+    return amount == commands.size();
+}
+
+void fromSharedRobotCommands(const SharedRobotCommands& sharedCommands, rtt::RobotCommands& commands) {
+    auto amount = std::min<uint32_t>(sharedCommands.amountOfCommands, MAX_SHARED_ROBOT_COMMANDS);
+    commands.resize(amount);
+
+    for (uint32_t i = 0; i < amount; i++) {
+        const auto& sharedCommand = sharedCommands.commands[i];
+        auto& command = commands[i];
+        command.id = sharedCommand.id;
+        command.velocity = Vector2(sharedCommand.velocityX, sharedCommand.velocityY);
+        command.targetAngle = Angle(sharedCommand.targetAngle);
+        command.targetAngularVelocity = sharedCommand.targetAngularVelocity;
+        command.useAngularVelocity = sharedCommand.useAngularVelocity != 0;
+        command.cameraAngleOfRobot = sharedCommand.cameraAngleOfRobot;
+        command.cameraAngleOfRobotIsSet = sharedCommand.cameraAngleOfRobotIsSet != 0;
+        command.kickSpeed = sharedCommand.kickSpeed;
+        command.waitForBall = sharedCommand.waitForBall != 0;
+        command.kickType = static_cast<rtt::KickType>(sharedCommand.kickType);
+        command.kickAtAngle = sharedCommand.kickAtAngle != 0;
+        command.dribblerSpeed = sharedCommand.dribblerSpeed;
+        command.ignorePacket = sharedCommand.ignorePacket != 0;
+    }
+}
+
+static uint64_t getSteadyTimeNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+SharedCommandRingReader::SharedCommandRingReader(const std::string& name, uint32_t capacity, std::chrono::milliseconds maxAge)
+    : segment(SharedMemorySegment::create(name, getSegmentSize(roundUpToPowerOfTwo(std::max<uint32_t>(capacity, 1))))), maxAge(maxAge) {
+    uint32_t slotCapacity = roundUpToPowerOfTwo(std::max<uint32_t>(capacity, 1));
+    this->slotMask = slotCapacity - 1;
+
+    this->header = new (this->segment.getData()) SharedCommandRingHeader();
+    this->slots = reinterpret_cast<SharedRobotCommands*>(static_cast<uint8_t*>(this->segment.getData()) + sizeof(SharedCommandRingHeader));
+    this->header->version = SHARED_COMMANDS_VERSION;
+    this->header->capacity = slotCapacity;
+    this->header->slotSize = sizeof(SharedRobotCommands);
+    this->header->generation = makeSharedMemoryGeneration();
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(this->header->magic, SHARED_COMMANDS_MAGIC, sizeof(SHARED_COMMANDS_MAGIC));
+}
+
+SharedCommandRingReader::~SharedCommandRingReader() { this->header->readerIsGone.store(1, std::memory_order_release); }
+
+bool SharedCommandRingReader::readNext(SharedRobotCommands& commands) {
+    uint64_t readIndex = this->header->readIndex.load(std::memory_order_relaxed);
+    uint64_t writeIndex = this->header->writeIndex.load(std::memory_order_acquire);
+    uint64_t now = getSteadyTimeNs();
+
+    while (readIndex != writeIndex) {
+        commands = this->slots[readIndex & this->slotMask];
+        // Only now the writer may reuse the slot
+        this->header->readIndex.store(++readIndex, std::memory_order_release);
+
+        if (commands.timestampNs + this->maxAge.count() >= now) return true;
+        this->header->droppedBatches.fetch_add(1, std::memory_order_relaxed);
+    }
+    return false;
+}
+
+bool SharedCommandRingReader::waitForCommands(std::chrono::milliseconds timeout) {
+    auto hasCommands = [this] { return this->header->readIndex.load(std::memory_order_relaxed) != this->header->writeIndex.load(std::memory_order_seq_cst); };
+    if (hasCommands()) return true;
+
+    // Announce that we wait before checking the ring a last time. A writer either sees the announcement and wakes us,
+    // or wrote its batch before our check. If it wakes us before we sleep, the counter has changed and we do not sleep
+    uint32_t counter = this->header->wakeCounter.load(std::memory_order_seq_cst);
+    this->header->readerIsWaiting.store(1, std::memory_order_seq_cst);
+    if (!hasCommands()) futexWait(this->header->wakeCounter, counter, timeout);
+    this->header->readerIsWaiting.store(0, std::memory_order_relaxed);
+    return hasCommands();
+}
+
+uint64_t SharedCommandRingReader::getDroppedBatches() const { return this->header->droppedBatches.load(std::memory_order_relaxed); }
+
+SharedCommandRingWriter::SharedCommandRingWriter(const std::string& name) : name(name), segment(SharedMemorySegment::open(name, true)) {
+    validateRing(this->segment, name);
+    this->header = static_cast<SharedCommandRingHeader*>(this->segment.getData());
+    this->slots = reinterpret_cast<SharedRobotCommands*>(static_cast<uint8_t*>(this->segment.getData()) + sizeof(SharedCommandRingHeader));
+    this->slotMask = this->header->capacity - 1;
+    this->generation = this->header->generation;
+}
+
+bool SharedCommandRingWriter::reopenIfReplaced() {
+    try {
+        auto newSegment = SharedMemorySegment::open(this->name, true);
+        validateRing(newSegment, this->name);
+        auto* newHeader = static_cast<SharedCommandRingHeader*>(newSegment.getData());
+        if (newHeader->generation == this->generation) return false;
+
+        this->segment = std::move(newSegment);
+        this->header = newHeader;
+        this->slots = reinterpret_cast<SharedRobotCommands*>(static_cast<uint8_t*>(this->segment.getData()) + sizeof(SharedCommandRingHeader));
+        this->slotMask = this->header->capacity - 1;
+        this->generation = this->header->generation;
+        return true;
+    } catch (const FailedToOpenSharedMemoryException&) {
+        return false;  // RobotHub did not create a new ring (yet)
+    }
+}
+
+bool SharedCommandRingWriter::write(const rtt::RobotCommands& commands) {
+    SharedRobotCommands sharedCommands;
+    toSharedRobotCommands(commands, sharedCommands);
+    return this->write(sharedCommands);
+}
+
+bool SharedCommandRingWriter::write(const SharedRobotCommands& commands) {
+    // A RobotHub that crashed never reads its ring again, so a full ring is also a reason to look for a new one
+    auto isFull = [this] { return this->header->writeIndex.load(std::memory_order_relaxed) - this->header->readIndex.load(std::memory_order_acquire) > this->slotMask; };
+    if (this->header->readerIsGone.load(std::memory_order_acquire) != 0 || isFull()) this->reopenIfReplaced();
+
+    if (this->header->readerIsGone.load(std::memory_order_relaxed) != 0 || isFull()) {
+        this->header->droppedBatches.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    uint64_t writeIndex = this->header->writeIndex.load(std::memory_order_relaxed);
+    this->slots[writeIndex & this->slotMask] = commands;
+    this->header->writeIndex.store(writeIndex + 1, std::memory_order_seq_cst);
+
+    this->header->wakeCounter.fetch_add(1, std::memory_order_seq_cst);
+    if (this->header->readerIsWaiting.load(std::memory_order_seq_cst) != 0) futexWake(this->header->wakeCounter);
+    return true;
+}
+
+SharedCommandIngress::SharedCommandIngress(const std::string& yellowName, const std::string& blueName,
+                                           const std::function<void(const rtt::RobotCommands&, rtt::Team)>& callback)
+    : yellowRing(yellowName), blueRing(blueName), callback(callback), shouldConsume(true) {
+    this->yellowConsumer = std::thread(&SharedCommandIngress::consume, this, std::ref(this->yellowRing), rtt::Team::YELLOW);
+    this->blueConsumer = std::thread(&SharedCommandIngress::consume, this, std::ref(this->blueRing), rtt::Team::BLUE);
+}
+
+SharedCommandIngress::~SharedCommandIngress() {
+    // The consumers notice within their wait timeout
+    this->shouldConsume = false;
+    if (this->yellowConsumer.joinable()) this->yellowConsumer.join();
+    if (this->blueConsumer.joinable()) this->blueConsumer.join();
+}
+
+uint64_t SharedCommandIngress::getDroppedBatches(rtt::Team team) const {
+    return team == rtt::Team::BLUE ? this->blueRing.getDroppedBatches() : this->yellowRing.getDroppedBatches();
+}
+
+void SharedCommandIngress::consume(SharedCommandRingReader& ring, rtt::Team team) {
+    SharedRobotCommands sharedCommands;
+    rtt::RobotCommands commands;  // Reused, so a batch costs no allocations once the largest one was seen
+
+    while (this->shouldConsume) {
+        if (!ring.waitForCommands(CONSUMER_WAIT_TIMEOUT)) continue;
+
+        while (this->shouldConsume && ring.readNext(sharedCommands)) {
+            fromSharedRobotCommands(sharedCommands, commands);
+            this->callback(commands, team);
+        }
+    }
+}
+
+}  // namespace rtt::robothub
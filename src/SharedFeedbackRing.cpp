@@ -0,0 +1,164 @@
+#include <SharedFeedbackRing.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+
+namespace rtt::robothub {
+
+constexpr char SHARED_FEEDBACK_MAGIC[8] = {'R', 'T', 'T', 'F', 'B', 'R', 'N', 'G'};
+
+static uint32_t roundUpToPowerOfTwo(uint32_t value) {
+    uint32_t powerOfTwo = 1;
+    while (powerOfTwo < value) powerOfTwo <<= 1;
+    return powerOfTwo;
+}
+
+static std::size_t getSegmentSize(uint32_t capacity) { return sizeof(SharedFeedbackRingHeader) + static_cast<std::size_t>(capacity) * sizeof(SharedFeedbackSlot); }
+
+// Returns nothing if the segment does not contain a complete ring of this version
+static const SharedFeedbackRingHeader* getValidHeader(const SharedMemorySegment& segment) {
+    const auto* header = static_cast<const SharedFeedbackRingHeader*>(segment.getData());
+    bool isValid = segment.getSize() >= sizeof(SharedFeedbackRingHeader) && std::memcmp(header->magic, SHARED_FEEDBACK_MAGIC, sizeof(SHARED_FEEDBACK_MAGIC)) == 0;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    isValid = isValid && header->version == SHARED_FEEDBACK_VERSION && header->slotSize == sizeof(SharedFeedbackSlot) && segment.getSize() >= getSegmentSize(header->capacity);
+    return isValid ? header : nullptr;
+}
+
+SharedRobotFeedback toSharedRobotFeedback(const rtt::RobotFeedback& feedback, rtt::Team team, rtt::RobotFeedbackSource source, uint64_t timestampNs) {
+    return {.timestampNs = timestampNs,
+            .id = feedback.id,
+            .team = static_cast<uint8_t>(team == rtt::Team::BLUE ? 1 : 0),
+            .source = static_cast<uint8_t>(source == rtt::RobotFeedbackSource::BASESTATION ? 1 : 0),
+            .ballSensorSeesBall = feedback.ballSensorSeesBall,
+            .ballSensorIsWorking = feedback.ballSensorIsWorking,
+            .dribblerSeesBall = feedback.dribblerSeesBall,
+            .xSensIsCalibrated = feedback.xSensIsCalibrated,
+            .capacitorIsCharged = feedback.capacitorIsCharged,
+            .reserved = 0,
+            .ballPosition = feedback.ballPosition,
+            .velocityX = static_cast<float>(feedback.velocity.x),
+            .velocityY = static_cast<float>(feedback.velocity.y),
+            .angle = static_cast<float>(feedback.angle.getValue()),
+            .batteryLevel = feedback.batteryLevel,
+            .wheelLocked = feedback.wheelLocked,
+            .wheelBraking = feedback.wheelBraking,
+            .signalStrength = feedback.signalStrength};
+}
+
+rtt::RobotsFeedback fromSharedRobotFeedback(const SharedRobotFeedback& feedback) {
+    rtt::RobotsFeedback robotsFeedback;
+    robotsFeedback.team = feedback.team == 1 ? rtt::Team::BLUE : rtt::Team::YELLOW;
+    robotsFeedback.source = feedback.source == 1 ? rtt::RobotFeedbackSource::BASESTATION : rtt::RobotFeedbackSource::SIMULATOR;
+    robotsFeedback.feedback.push_back({.id = feedback.id,
+                                       .ballSensorSeesBall = feedback.ballSensorSeesBall != 0,
+                                       .ballPosition = feedback.ballPosition,
+                                       .ballSensorIsWorking = feedback.ballSensorIsWorking != 0,
+                                       .dribblerSeesBall = feedback.dribblerSeesBall != 0,
+                                       .velocity = Vector2(feedback.velocityX, feedback.velocityY),
+                                       .angle = Angle(feedback.angle),
+                                       .xSensIsCalibrated = feedback.xSensIsCalibrated != 0,
+                                       .capacitorIsCharged = feedback.capacitorIsCharged != 0,
+                                       .wheelLocked = feedback.wheelLocked,
+                                       .wheelBraking = feedback.wheelBraking,
+                                       .batteryLevel = feedback.batteryLevel,
+                                       .signalStrength = feedback.signalStrength});
+    return robotsFeedback;
+}
+
+SharedFeedbackWriter::SharedFeedbackWriter(const std::string& name, uint32_t capacity)
+    : segment(SharedMemorySegment::create(name, getSegmentSize(roundUpToPowerOfTwo(std::max<uint32_t>(capacity, 1))))), nextIndex(0) {
+    uint32_t slotCapacity = roundUpToPowerOfTwo(std::max<uint32_t>(capacity, 1));
+    this->slotMask = slotCapacity - 1;
+
+    // A new segment is zeroed, so every slot starts with sequence 0, which matches no record
+    this->header = new (this->segment.getData()) SharedFeedbackRingHeader();
+    this->slots = reinterpret_cast<SharedFeedbackSlot*>(static_cast<uint8_t*>(this->segment.getData()) + sizeof(SharedFeedbackRingHeader));
+    this->header->version = SHARED_FEEDBACK_VERSION;
+    this->header->capacity = slotCapacity;
+    this->header->slotSize = sizeof(SharedFeedbackSlot);
+    this->header->generation = makeSharedMemoryGeneration();
+    this->header->writeIndex.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(this->header->magic, SHARED_FEEDBACK_MAGIC, sizeof(SHARED_FEEDBACK_MAGIC));
+}
+
+void SharedFeedbackWriter::publish(const rtt::RobotsFeedback& feedback) {
+    auto timestampNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    for (const auto& robotFeedback : feedback.feedback) {
+        this->publish(toSharedRobotFeedback(robotFeedback, feedback.team, feedback.source, timestampNs));
+    }
+}
+
+void SharedFeedbackWriter::publish(const SharedRobotFeedback& feedback) {
+    std::scoped_lock<std::mutex> lock(this->writeMutex);
+    uint64_t index = this->nextIndex++;
+    auto& slot = this->slots[index & this->slotMask];
+
+    // Mark the slot as being written before touching the record, so readers that copy it meanwhile discard their copy
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.record = feedback;
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+
+    this->header->writeIndex.store(index + 1, std::memory_order_release);
+}
+
+SharedFeedbackReader::SharedFeedbackReader(const std::string& name)
+    : name(name), segment(SharedMemorySegment::open(name, false)), readIndex(0), missedRecords(0) {
+    this->header = getValidHeader(this->segment);
+    if (this->header == nullptr) throw FailedToOpenSharedMemoryException(name + " does not contain a feedback ring of version " + std::to_string(SHARED_FEEDBACK_VERSION));
+
+    this->slots = reinterpret_cast<const SharedFeedbackSlot*>(static_cast<const uint8_t*>(this->segment.getData()) + sizeof(SharedFeedbackRingHeader));
+    this->slotMask = this->header->capacity - 1;
+    this->generation = this->header->generation;
+    this->readIndex = this->header->writeIndex.load(std::memory_order_acquire);
+}
+
+bool SharedFeedbackReader::readNext(SharedRobotFeedback& feedback) {
+    while (true) {
+        uint64_t written = this->header->writeIndex.load(std::memory_order_acquire);
+        if (this->readIndex >= written) return false;
+
+        // Records older than the capacity are overwritten already, so skip to the oldest one that may still be there
+        uint64_t capacity = this->slotMask + 1;
+        if (written - this->readIndex > capacity) {
+            this->missedRecords += written - capacity - this->readIndex;
+            this->readIndex = written - capacity;
+        }
+
+        const auto& slot = this->slots[this->readIndex & this->slotMask];
+        uint64_t expectedSequence = 2 * this->readIndex + 2;
+
+        uint64_t sequenceBefore = slot.sequence.load(std::memory_order_acquire);
+        if (sequenceBefore == expectedSequence) {
+            SharedRobotFeedback copy = slot.record;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == expectedSequence) {
+                feedback = copy;
+                this->readIndex++;
+                return true;
+            }
+        }
+
+        // The writer lapped us while we were reading this record
+        this->missedRecords++;
+        this->readIndex++;
+    }
+}
+
+uint64_t SharedFeedbackReader::getMissedRecords() const { return this->missedRecords; }
+
+bool SharedFeedbackReader::isReplaced() const {
+    try {
+        auto current = SharedMemorySegment::open(this->name, false);
+        const auto* currentHeader = getValidHeader(current);
+        // A ring that is still being created is not complete yet, so it does not count until it is
+        return currentHeader != nullptr && currentHeader->generation != this->generation;
+    } catch (const FailedToOpenSharedMemoryException&) {
+        return false;  // The hub is gone, but did not start again yet
+    }
+}
+
+}  // namespace rtt::robothub
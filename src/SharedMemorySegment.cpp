@@ -0,0 +1,95 @@
+#include <SharedMemorySegment.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <utility>
+
+namespace rtt::robothub {
+
+static std::string getErrorMessage(const std::string& action, const std::string& name) { return "Failed to " + action + " shared memory " + name + ": " + std::strerror(errno); }
+
+SharedMemorySegment SharedMemorySegment::create(const std::string& name, std::size_t size) {
+    // Start from a fresh segment, so processes that still use an old one cannot mix it up with ours
+    shm_unlink(name.c_str());
+    // Only the user that runs RobotHub may open it, as a writable segment would let anyone send commands to the robots
+    int fileDescriptor = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fileDescriptor < 0) throw FailedToOpenSharedMemoryException(getErrorMessage("create", name));
+
+    if (ftruncate(fileDescriptor, static_cast<off_t>(size)) != 0) {
+        auto message = getErrorMessage("size", name);
+        close(fileDescriptor);
+        shm_unlink(name.c_str());
+        throw FailedToOpenSharedMemoryException(message);
+    }
+
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+    close(fileDescriptor);  // The mapping keeps the segment alive
+    if (data == MAP_FAILED) {
+        auto message = getErrorMessage("map", name);
+        shm_unlink(name.c_str());
+        throw FailedToOpenSharedMemoryException(message);
+    }
+    return {name, data, size, true};
+}
+
+SharedMemorySegment SharedMemorySegment::open(const std::string& name, bool writable) {
+    int fileDescriptor = shm_open(name.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+    if (fileDescriptor < 0) throw FailedToOpenSharedMemoryException(getErrorMessage("open", name) + ". Is RobotHub running?");
+
+    struct stat status = {};
+    if (fstat(fileDescriptor, &status) != 0 || status.st_size <= 0) {
+        close(fileDescriptor);
+        throw FailedToOpenSharedMemoryException("Shared memory " + name + " is empty");
+    }
+
+    auto size = static_cast<std::size_t>(status.st_size);
+    void* data = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fileDescriptor, 0);
+    close(fileDescriptor);
+    if (data == MAP_FAILED) throw FailedToOpenSharedMemoryException(getErrorMessage("map", name));
+    return {name, data, size, false};
+}
+
+SharedMemorySegment::SharedMemorySegment(std::string name, void* data, std::size_t size, bool isOwner)
+    : name(std::move(name)), data(data), size(size), isOwner(isOwner) {}
+
+SharedMemorySegment::SharedMemorySegment(SharedMemorySegment&& other) noexcept
+    : name(std::move(other.name)), data(std::exchange(other.data, nullptr)), size(other.size), isOwner(std::exchange(other.isOwner, false)) {}
+
+SharedMemorySegment& SharedMemorySegment::operator=(SharedMemorySegment&& other) noexcept {
+    if (this != &other) {
+        this->release();
+        this->name = std::move(other.name);
+        this->data = std::exchange(other.data, nullptr);
+        this->size = other.size;
+        this->isOwner = std::exchange(other.isOwner, false);
+    }
+    return *this;
+}
+
+SharedMemorySegment::~SharedMemorySegment() { this->release(); }
+
+void SharedMemorySegment::release() {
+    if (this->data != nullptr) munmap(this->data, this->size);
+    if (this->isOwner) shm_unlink(this->name.c_str());
+    this->data = nullptr;
+    this->isOwner = false;
+}
+
+void* SharedMemorySegment::getData() const { return this->data; }
+
+std::size_t SharedMemorySegment::getSize() const { return this->size; }
+
+uint64_t makeSharedMemoryGeneration() {
+    // The wall clock, as it keeps increasing across restarts of a process, unlike the steady clock after a reboot
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+FailedToOpenSharedMemoryException::FailedToOpenSharedMemoryException(const std::string& message) : message(message) {}
+const char* FailedToOpenSharedMemoryException::what() const noexcept { return this->message.c_str(); }
+
+}  // namespace rtt::robothub
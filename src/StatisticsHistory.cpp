@@ -0,0 +1,111 @@
+#include <StatisticsHistory.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+
+namespace rtt::robothub {
+
+StatisticsHistory::StatisticsHistory(std::size_t capacity) {
+    this->samples.resize(std::max<std::size_t>(1, capacity));
+    this->queryBuffer.reserve(this->samples.size());
+    this->amountOfSamples = 0;
+    this->nextIndex = 0;
+}
+
+void StatisticsHistory::add(const RobotHubStatistics& statistics) {
+    StatisticsSample sample = {
+        .secondsSinceStart = statistics.getSecondsSinceStart(),
+        .yellowTeamBytesSent = static_cast<double>(statistics.yellowTeamBytesSent),
+        .blueTeamBytesSent = static_cast<double>(statistics.blueTeamBytesSent),
+        .feedbackBytesSent = static_cast<double>(statistics.feedbackBytesSent),
+        .yellowTeamPacketsDropped = static_cast<double>(statistics.yellowTeamPacketsDropped),
+        .blueTeamPacketsDropped = static_cast<double>(statistics.blueTeamPacketsDropped),
+        .feedbackPacketsDropped = static_cast<double>(statistics.feedbackPacketsDropped),
+        .yellowCommandsReceived = static_cast<double>(statistics.getTotalCommandsReceived(rtt::Team::YELLOW)),
+        .blueCommandsReceived = static_cast<double>(statistics.getTotalCommandsReceived(rtt::Team::BLUE)),
+        .yellowFeedbackReceived = static_cast<double>(statistics.getTotalFeedbackReceived(rtt::Team::YELLOW)),
+        .blueFeedbackReceived = static_cast<double>(statistics.getTotalFeedbackReceived(rtt::Team::BLUE)),
+        .simulationErrorsReceived = static_cast<double>(statistics.simulationErrorsReceived),
+        .yellowSimulatorRoundTripP99Us = statistics.yellowSimulatorRoundTrip.p99Us,
+        .blueSimulatorRoundTripP99Us = statistics.blueSimulatorRoundTrip.p99Us,
+        .commandLatencyP99Us = statistics.stageLatencies[static_cast<int>(LatencyStage::COMMAND_TOTAL)].p99Us,
+        .commandLatencyMaxUs = statistics.stageLatencies[static_cast<int>(LatencyStage::COMMAND_TOTAL)].maxUs,
+        .feedbackLatencyP99Us = statistics.stageLatencies[static_cast<int>(LatencyStage::FEEDBACK_PUBLISH)].p99Us};
+
+    std::scoped_lock<std::mutex> lock(this->historyMutex);
+    this->samples[this->nextIndex] = sample;
+    this->nextIndex = (this->nextIndex + 1) % this->samples.size();
+    this->amountOfSamples = std::min(this->amountOfSamples + 1, this->samples.size());
+}
+
+StatisticsFieldSummary StatisticsHistory::summarize(StatisticsField field, std::chrono::seconds window) const {
+    std::scoped_lock<std::mutex> lock(this->historyMutex);
+
+    StatisticsFieldSummary summary;
+    if (this->amountOfSamples == 0) return summary;
+
+    // Walk from new to old until the window is covered
+    double newestTime = this->getSample(0).secondsSinceStart;
+    this->queryBuffer.clear();
+    for (std::size_t age = 0; age < this->amountOfSamples; ++age) {
+        const auto& sample = this->getSample(age);
+        if (newestTime - sample.secondsSinceStart >= static_cast<double>(window.count())) break;
+        this->queryBuffer.push_back(sample.*field);
+    }
+
+    // A window of 0 seconds selects no samples at all
+    auto& values = this->queryBuffer;
+    if (values.empty()) return summary;
+
+    summary.samples = static_cast<int>(values.size());
+    summary.min = *std::min_element(values.begin(), values.end());
+    summary.max = *std::max_element(values.begin(), values.end());
+    summary.mean = std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size());
+
+    auto percentile = [&](double fraction) {
+        auto index = static_cast<std::size_t>(std::ceil(fraction * static_cast<double>(values.size()))) - 1;
+        std::nth_element(values.begin(), values.begin() + static_cast<long>(index), values.end());
+        return values[index];
+    };
+    summary.p50 = percentile(0.5);
+    summary.p99 = percentile(0.99);
+
+    return summary;
+}
+
+std::size_t StatisticsHistory::size() const {
+    std::scoped_lock<std::mutex> lock(this->historyMutex);
+    return this->amountOfSamples;
+}
+
+void StatisticsHistory::dump(std::ostream& output) const {
+    std::scoped_lock<std::mutex> lock(this->historyMutex);
+
+    output << "seconds_since_start,yellow_bytes_sent,blue_bytes_sent,feedback_bytes_sent,yellow_packets_dropped,blue_packets_dropped,"
+              "feedback_packets_dropped,yellow_commands_received,blue_commands_received,yellow_feedback_received,blue_feedback_received,"
+              "simulation_errors,yellow_sim_rtt_p99_us,blue_sim_rtt_p99_us,command_latency_p99_us,command_latency_max_us,feedback_latency_p99_us\n";
+
+    for (std::size_t age = this->amountOfSamples; age-- > 0;) {
+        const auto& s = this->getSample(age);
+        output << s.secondsSinceStart << "," << s.yellowTeamBytesSent << "," << s.blueTeamBytesSent << "," << s.feedbackBytesSent << "," << s.yellowTeamPacketsDropped << ","
+               << s.blueTeamPacketsDropped << "," << s.feedbackPacketsDropped << "," << s.yellowCommandsReceived << "," << s.blueCommandsReceived << ","
+               << s.yellowFeedbackReceived << "," << s.blueFeedbackReceived << "," << s.simulationErrorsReceived << "," << s.yellowSimulatorRoundTripP99Us << ","
+               << s.blueSimulatorRoundTripP99Us << "," << s.commandLatencyP99Us << "," << s.commandLatencyMaxUs << "," << s.feedbackLatencyP99Us << "\n";
+    }
+}
+
+bool StatisticsHistory::dumpToFile(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) return false;
+
+    this->dump(file);
+    return file.good();
+}
+
+const StatisticsSample& StatisticsHistory::getSample(std::size_t age) const {
+    std::size_t capacity = this->samples.size();
+    return this->samples[(this->nextIndex + capacity - 1 - age) % capacity];
+}
+
+}  // namespace rtt::robothub
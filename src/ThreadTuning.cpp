@@ -0,0 +1,246 @@
+#include <ThreadTuning.hpp>
+#include <pthread.h>
+#include <roboteam_utils/Print.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+
+namespace rtt::robothub {
+
+typedef struct ThreadTuningState {
+    std::mutex configurationMutex;  // Guards the configuration
+    ThreadTuningConfiguration configuration;
+    std::atomic<uint64_t> generation = 0;  // Changes with every configuration, so threads know to tune themselves again
+    std::array<std::atomic<bool>, AMOUNT_OF_THREAD_ROLES> hasWarnedAboutPriority{};
+    std::array<std::atomic<bool>, AMOUNT_OF_THREAD_ROLES> hasWarnedAboutCpus{};
+    std::array<LatencyHistogram, AMOUNT_OF_THREAD_ROLES> schedulerJitter;
+} ThreadTuningState;
+
+static ThreadTuningState& getThreadTuningState() {
+    static ThreadTuningState state;
+    return state;
+}
+
+static std::optional<ThreadRole> stringToThreadRole(const std::string& name) {
+    for (int role = 0; role < AMOUNT_OF_THREAD_ROLES; ++role) {
+        if (threadRoleToString(static_cast<ThreadRole>(role)) == name) return static_cast<ThreadRole>(role);
+    }
+    return std::nullopt;
+}
+
+static std::vector<int> parseCpus(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string cpu;
+    while (std::getline(ss, cpu, ',')) cpus.push_back(std::stoi(cpu));
+    return cpus;
+}
+
+std::optional<ThreadTuningConfiguration> loadThreadTuningConfiguration(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        RTT_ERROR("Failed to open thread tuning file ", path)
+        return std::nullopt;
+    }
+
+    ThreadTuningConfiguration configuration;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        std::istringstream words(line);
+        std::string word;
+        if (!(words >> word) || word.starts_with("#")) continue;
+
+        try {
+            if (word == "lock-memory") {
+                configuration.lockMemory = true;
+                continue;
+            }
+            if (word.starts_with("jitter-probe-ms=")) {
+                configuration.jitterProbeInterval = std::chrono::milliseconds(std::stoi(word.substr(word.find('=') + 1)));
+                continue;
+            }
+
+            auto role = stringToThreadRole(word);
+            if (!role.has_value()) throw std::invalid_argument("unknown role " + word);
+            auto& tuning = configuration.roles[static_cast<int>(role.value())];
+            while (words >> word) {
+                if (word.starts_with("priority=")) {
+                    tuning.realtimePriority = std::stoi(word.substr(word.find('=') + 1));
+                } else if (word.starts_with("cpus=")) {
+                    tuning.cpus = parseCpus(word.substr(word.find('=') + 1));
+                } else {
+                    throw std::invalid_argument("unknown setting " + word);
+                }
+            }
+        } catch (const std::exception& e) {
+            RTT_ERROR("Line ", lineNumber, " of thread tuning file ", path, " is not understood (", e.what(), "): ", line)
+            return std::nullopt;
+        }
+    }
+    return configuration;
+}
+
+void configureThreadTuning(const ThreadTuningConfiguration& configuration) {
+    auto& state = getThreadTuningState();
+    {
+        std::scoped_lock<std::mutex> lock(state.configurationMutex);
+        state.configuration = configuration;
+    }
+    state.generation++;
+
+    if (configuration.lockMemory) {
+        // Once future memory is locked, allocations beyond the memlock limit fail, which would break starting threads
+        rlimit memoryLockLimit = {};
+        bool mayLockFutureMemory = geteuid() == 0 || (getrlimit(RLIMIT_MEMLOCK, &memoryLockLimit) == 0 && memoryLockLimit.rlim_cur == RLIM_INFINITY);
+        if (mlockall(mayLockFutureMemory ? MCL_CURRENT | MCL_FUTURE : MCL_CURRENT) != 0) {
+            RTT_WARNING("Failed to lock the memory of RobotHub in RAM, so its threads can still wait for page faults: ", std::strerror(errno), ". Raise the memlock limit to allow it")
+        } else if (!mayLockFutureMemory) {
+            RTT_WARNING("Only locked the memory RobotHub uses now, as the memlock limit is not unlimited. Raise it to also lock what RobotHub allocates later")
+        }
+    }
+
+    for (int role = 0; role < AMOUNT_OF_THREAD_ROLES; ++role) {
+        const auto& tuning = configuration.roles[role];
+        if (tuning.realtimePriority <= 0 && tuning.cpus.empty()) continue;
+
+        std::string cpus;
+        for (int cpu : tuning.cpus) cpus += (cpus.empty() ? "" : ",") + std::to_string(cpu);
+        RTT_INFO("Tuning the ", threadRoleToString(static_cast<ThreadRole>(role)), " threads: real-time priority ", tuning.realtimePriority, ", cpus ",
+                 cpus.empty() ? "all" : cpus)
+    }
+}
+
+// How a thread was scheduled before it was tuned, so it can get that back when its tuning is turned off
+typedef struct OriginalScheduling {
+    int policy = SCHED_OTHER;
+    sched_param parameters = {};
+    cpu_set_t cpus;
+    bool isPinned = false;    // Whether we changed the cpus of the thread
+    bool isRealtime = false;  // Whether we changed the scheduler of the thread
+} OriginalScheduling;
+
+void tuneCurrentThread(ThreadRole role) {
+    auto& state = getThreadTuningState();
+    thread_local std::optional<ThreadRole> tunedRole;
+    thread_local uint64_t tunedGeneration = 0;
+    thread_local std::optional<OriginalScheduling> original;
+
+    uint64_t generation = state.generation.load(std::memory_order_relaxed);
+    if (tunedRole == role && tunedGeneration == generation) return;
+    tunedRole = role;
+    tunedGeneration = generation;
+
+    ThreadRoleTuning tuning;
+    {
+        std::scoped_lock<std::mutex> lock(state.configurationMutex);
+        tuning = state.configuration.roles[static_cast<int>(role)];
+    }
+
+    if (!original.has_value()) {
+        original = OriginalScheduling();
+        pthread_getschedparam(pthread_self(), &original->policy, &original->parameters);
+        CPU_ZERO(&original->cpus);
+        pthread_getaffinity_np(pthread_self(), sizeof(original->cpus), &original->cpus);
+    }
+
+    // Lower the priority before unpinning, so the thread does not run with real-time priority on a cpu it should not run on
+    if (tuning.realtimePriority <= 0 && original->isRealtime) {
+        int error = pthread_setschedparam(pthread_self(), original->policy, &original->parameters);
+        if (error != 0) RTT_WARNING("Failed to give a ", threadRoleToString(role), " thread its original scheduler back: ", std::strerror(error))
+        original->isRealtime = error != 0;
+    }
+    if (tuning.cpus.empty() && original->isPinned) {
+        int error = pthread_setaffinity_np(pthread_self(), sizeof(original->cpus), &original->cpus);
+        if (error != 0) RTT_WARNING("Failed to give a ", threadRoleToString(role), " thread its original cpus back: ", std::strerror(error))
+        original->isPinned = error != 0;
+    }
+
+    // Pin first, so the thread does not get real-time priority on a cpu it should not run on
+    if (!tuning.cpus.empty()) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (int cpu : tuning.cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &cpus);
+        }
+        int error = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (error == 0) original->isPinned = true;
+        if (error != 0 && !state.hasWarnedAboutCpus[static_cast<int>(role)].exchange(true)) {
+            RTT_WARNING("Failed to pin the ", threadRoleToString(role), " threads to their cpus, so they run on all cpus: ", std::strerror(error))
+        }
+    }
+
+    if (tuning.realtimePriority > 0) {
+        sched_param parameters = {};
+        parameters.sched_priority = std::clamp(tuning.realtimePriority, sched_get_priority_min(SCHED_FIFO), sched_get_priority_max(SCHED_FIFO));
+        int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters);
+        if (error == 0) original->isRealtime = true;
+        if (error != 0 && !state.hasWarnedAboutPriority[static_cast<int>(role)].exchange(true)) {
+            if (error == EPERM) {
+                RTT_WARNING("No permission to give the ", threadRoleToString(role), " threads real-time priority, so they keep the normal scheduler. Grant RobotHub "
+                            "CAP_SYS_NICE or raise its rtprio limit to allow it")
+            } else {
+                RTT_WARNING("Failed to give the ", threadRoleToString(role), " threads real-time priority: ", std::strerror(error))
+            }
+        }
+    }
+}
+
+std::chrono::milliseconds getJitterProbeInterval(ThreadRole role) {
+    auto& state = getThreadTuningState();
+    std::scoped_lock<std::mutex> lock(state.configurationMutex);
+    const auto& tuning = state.configuration.roles[static_cast<int>(role)];
+    // Untuned roles are not probed, as their jitter is not what anyone is looking at
+    if (tuning.realtimePriority <= 0 && tuning.cpus.empty()) return std::chrono::milliseconds(0);
+    return state.configuration.jitterProbeInterval;
+}
+
+void recordSchedulerJitter(ThreadRole role, std::chrono::nanoseconds lateness) { getThreadTuningState().schedulerJitter[static_cast<int>(role)].record(lateness); }
+
+LatencySummary takeSchedulerJitter(ThreadRole role) { return getThreadTuningState().schedulerJitter[static_cast<int>(role)].takeSummary(); }
+
+PriorityInheritanceMutex::PriorityInheritanceMutex() {
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_setprotocol(&attributes, PTHREAD_PRIO_INHERIT);
+    int error = pthread_mutex_init(&this->mutex, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+    if (error != 0) throw std::system_error(error, std::generic_category(), "Failed to create priority inheritance mutex");
+}
+
+PriorityInheritanceMutex::~PriorityInheritanceMutex() { pthread_mutex_destroy(&this->mutex); }
+
+void PriorityInheritanceMutex::lock() {
+    int error = pthread_mutex_lock(&this->mutex);
+    if (error != 0) throw std::system_error(error, std::generic_category(), "Failed to lock priority inheritance mutex");
+}
+
+void PriorityInheritanceMutex::unlock() { pthread_mutex_unlock(&this->mutex); }
+
+bool PriorityInheritanceMutex::try_lock() { return pthread_mutex_trylock(&this->mutex) == 0; }
+
+std::string threadRoleToString(ThreadRole role) {
+    switch (role) {
+        case ThreadRole::USB:
+            return "usb";
+        case ThreadRole::SIMULATOR:
+            return "simulator";
+        case ThreadRole::TRANSMIT:
+            return "transmit";
+    }
+    return "unknown";
+}
+
+}  // namespace rtt::robothub
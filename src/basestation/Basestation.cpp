@@ -12,7 +12,7 @@ constexpr uint16_t BASESTATION_PRODUCT_ID = 22336;           // Product id all b
 constexpr int BASESTATION_USB_INTERFACE_NUMBER = 1;          // USB interface we use for connecting with a basestation
 constexpr uint8_t TRANSFER_IN_BUFFER_ENDPOINT = 129;         // Endpoint used for reading messages
 constexpr uint8_t TRANSFER_OUT_BUFFER_ENDPOINT = 1;          // Endpoint used for writing messages
-constexpr unsigned int TRANSFER_IN_TIMEOUT_MS = 100;         // Timeout for reading messages
+constexpr unsigned int TRANSFER_IN_TIMEOUT_MS = 0;           // Reading waits for a message as long as it takes
 constexpr unsigned int TRANSFER_OUT_TIMEOUT_MS = 500;        // Timeout for writing messages
 constexpr unsigned int PAUSE_ON_TRANSFER_IN_ERROR_MS = 100;  // Pause every time a read fails
 
@@ -32,7 +32,8 @@ std::string BasestationIdentifier::toString() const {
     return "(serialIdentifier=" + std::to_string(id) + ", usbAddress=" + std::to_string(address) + ")";
 }
 
-Basestation::Basestation(libusb_device *const device) : device(device), identifier(getIdentifierOfDevice(device)) {
+Basestation::Basestation(libusb_context *const usbContext, EventLoop &eventLoop, libusb_device *const device)
+    : usbContext(usbContext), eventLoop(eventLoop), device(device), identifier(getIdentifierOfDevice(device)), isClosing(false), incomingTransferIsDone(1), retryTimeout(-1) {
     if (!Basestation::isDeviceABasestation(device)) {
         throw FailedToOpenDeviceException("Device is not a basestation");
     }
@@ -56,19 +57,30 @@ Basestation::Basestation(libusb_device *const device) : device(device), identifi
         throw FailedToOpenDeviceException("Failed to claim interface");
     }
 
-    // Start listen thread for incoming messages
-    this->shouldListenForIncomingMessages = true;
-    this->incomingMessageListenerThread = std::thread(&Basestation::listenForIncomingMessages, this);
+    this->serialNumber = Basestation::readSerialNumber(this->device, this->deviceHandle);
+
+    this->incomingTransfer = libusb_alloc_transfer(0);
+    if (this->incomingTransfer == nullptr) {
+        libusb_release_interface(this->deviceHandle, BASESTATION_USB_INTERFACE_NUMBER);
+        libusb_close(this->deviceHandle);
+        throw FailedToOpenDeviceException("Failed to allocate transfer");
+    }
+    libusb_fill_bulk_transfer(this->incomingTransfer, this->deviceHandle, TRANSFER_IN_BUFFER_ENDPOINT, this->incomingMessage.payloadBuffer, BASESTATION_MESSAGE_BUFFER_SIZE,
+                              &Basestation::onIncomingTransfer, this, TRANSFER_IN_TIMEOUT_MS);
+
+    // Start listening for incoming messages
+    {
+        std::scoped_lock<std::mutex> lock(this->incomingTransferMutex);
+        this->submitIncomingTransfer();
+    }
 
     RTT_DEBUG("Opened basestation ", this->identifier.toString())
 }
 
 Basestation::~Basestation() {
-    // Stop the listen thread that reads messages of the basestation
-    this->shouldListenForIncomingMessages = false;
-    if (this->incomingMessageListenerThread.joinable()) {
-        this->incomingMessageListenerThread.join();
-    }
+    // Stop the transfer that reads messages of the basestation
+    this->stopReading();
+    libusb_free_transfer(this->incomingTransfer);
 
     // Release the interface so other programs can claim it
     int error = libusb_release_interface(this->deviceHandle, BASESTATION_USB_INTERFACE_NUMBER);
@@ -98,6 +110,8 @@ void Basestation::setIncomingMessageCallback(const std::function<void(const Base
 
 const BasestationIdentifier& Basestation::getIdentifier() const { return this->identifier; }
 
+const std::string& Basestation::getSerialNumber() const { return this->serialNumber; }
+
 bool Basestation::isDeviceABasestation(libusb_device* const device) {
     libusb_device_descriptor descriptor;
     int r = libusb_get_device_descriptor(device, &descriptor);
@@ -109,47 +123,74 @@ bool Basestation::isDeviceABasestation(libusb_device* const device) {
     return descriptor.idVendor == BASESTATION_VENDOR_ID && descriptor.idProduct == BASESTATION_PRODUCT_ID;
 }
 
-void Basestation::listenForIncomingMessages() {
-    // The incoming data will keep being written to this message object over and over
-    BasestationMessage incomingMessage;
+void Basestation::submitIncomingTransfer() {
+    int error = libusb_submit_transfer(this->incomingTransfer);
+    this->incomingTransferIsDone = error != LIBUSB_SUCCESS;
+    if (error) RTT_ERROR("Failed to start reading messages of basestation ", this->identifier.toString(), ": ", usbutils_errorToString(error))
+}
 
-    RTT_DEBUG(this->identifier.toString(), " listenForIncomingMessages()");
+void Basestation::onIncomingTransfer(libusb_transfer *transfer) { static_cast<Basestation *>(transfer->user_data)->handleIncomingTransfer(); }
 
-    while (this->shouldListenForIncomingMessages) {
-        bool hasReadMessage = this->readBasestationMessage(incomingMessage);
-        if (hasReadMessage) {
-            // RTT_DEBUG("[", this->identifier.toString(), "]", " listenForIncomingMessages() hasReadMessage!");
+void Basestation::handleIncomingTransfer() {
+    int status = this->incomingTransfer->status;
+    switch (status) {
+        case LIBUSB_TRANSFER_COMPLETED: {
             // TODO: Protect callback with mutex. Other threads are theoretically able to set the callback to nullptr,
             // so at this point, calling the callback could result in error.
+            this->incomingMessage.payloadSize = this->incomingTransfer->actual_length;
             if (this->incomingMessageCallback != nullptr) {
-                this->incomingMessageCallback(incomingMessage, this->identifier);
+                this->incomingMessageCallback(this->incomingMessage, this->identifier);
             }
-        } else {
-            // If an error occured, try waiting a while before reading again
-            std::this_thread::sleep_for(std::chrono::milliseconds(PAUSE_ON_TRANSFER_IN_ERROR_MS));
+            break;
         }
-    }
-}
-
-bool Basestation::readBasestationMessage(BasestationMessage& message) const {
-    int error =
-        libusb_bulk_transfer(this->deviceHandle, TRANSFER_IN_BUFFER_ENDPOINT, message.payloadBuffer, BASESTATION_MESSAGE_BUFFER_SIZE, &message.payloadSize, TRANSFER_IN_TIMEOUT_MS);
-
-    switch (error) {
-        case LIBUSB_SUCCESS:
-        case LIBUSB_ERROR_TIMEOUT:
-            // Either received a message correctly, or received nothing at all, so do not send any debug message
+        case LIBUSB_TRANSFER_TIMED_OUT:
+        case LIBUSB_TRANSFER_CANCELLED:
             break;
-        case LIBUSB_ERROR_NO_DEVICE: {
+        case LIBUSB_TRANSFER_NO_DEVICE: {
             RTT_WARNING("Cannot reach the basestation. Did you unplug the device?")
             break;
         }
         default: {
-            RTT_ERROR("Failed to read message: ", usbutils_errorToString(error))
+            RTT_ERROR("Failed to read message: ", usbutils_transferStatusToString(status))
         }
     }
 
-    return error == LIBUSB_SUCCESS;
+    std::scoped_lock<std::mutex> lock(this->incomingTransferMutex);
+    this->incomingTransferIsDone = 1;
+    if (this->isClosing || status == LIBUSB_TRANSFER_CANCELLED || status == LIBUSB_TRANSFER_NO_DEVICE) return;
+
+    if (status == LIBUSB_TRANSFER_COMPLETED || status == LIBUSB_TRANSFER_TIMED_OUT) {
+        this->submitIncomingTransfer();
+    } else {
+        // If an error occured, try waiting a while before reading again
+        this->retryTimeout = this->eventLoop.addTimeout(std::chrono::milliseconds(PAUSE_ON_TRANSFER_IN_ERROR_MS), [this] {
+            std::scoped_lock<std::mutex> retryLock(this->incomingTransferMutex);
+            this->retryTimeout = -1;
+            if (!this->isClosing) this->submitIncomingTransfer();
+        });
+    }
+}
+
+void Basestation::stopReading() {
+    int pendingRetry;
+    {
+        std::scoped_lock<std::mutex> lock(this->incomingTransferMutex);
+        this->isClosing = true;
+        pendingRetry = this->retryTimeout;
+        if (!this->incomingTransferIsDone) libusb_cancel_transfer(this->incomingTransfer);
+    }
+    // The retry takes the mutex, so only wait for it without holding it
+    this->eventLoop.remove(pendingRetry);
+
+    // The cancelled transfer completes during event handling, which libusb lets us do next to the event loop
+    while (true) {
+        {
+            std::scoped_lock<std::mutex> lock(this->incomingTransferMutex);
+            if (this->incomingTransferIsDone) break;
+        }
+        timeval timeout = {.tv_sec = 0, .tv_usec = 100000};
+        libusb_handle_events_timeout_completed(this->usbContext, &timeout, &this->incomingTransferIsDone);
+    }
 }
 int Basestation::writeBasestationMessage(BasestationMessage& message) const {
     int bytesSent = 0;
@@ -175,6 +216,20 @@ BasestationIdentifier Basestation::getIdentifierOfDevice(libusb_device* const de
     return identifier;
 }
 
+std::string Basestation::readSerialNumber(libusb_device* const device, libusb_device_handle* const deviceHandle) {
+    libusb_device_descriptor deviceDescriptor = {};
+    libusb_get_device_descriptor(device, &deviceDescriptor);
+    if (deviceDescriptor.iSerialNumber == 0) return "";
+
+    unsigned char serialNumber[256];
+    int length = libusb_get_string_descriptor_ascii(deviceHandle, deviceDescriptor.iSerialNumber, serialNumber, sizeof(serialNumber));
+    if (length <= 0) {
+        RTT_WARNING("Failed to read the serial number of a basestation: ", usbutils_errorToString(length))
+        return "";
+    }
+    return std::string(reinterpret_cast<char*>(serialNumber), length);
+}
+
 FailedToOpenDeviceException::FailedToOpenDeviceException(const std::string& message) : message(message) {}
 
 const char* FailedToOpenDeviceException::what() const noexcept { return this->message.c_str(); }
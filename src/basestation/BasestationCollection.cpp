@@ -5,20 +5,34 @@
 #include <REM_Packet.h>
 #include <roboteam_utils/Print.h>
 
+#include <algorithm>
 #include <basestation/BasestationCollection.hpp>
+#include <cstdio>
 #include <cstring>
+#include <fstream>
 
 namespace rtt::robothub::basestation {
 
 constexpr int TIME_UNTIL_BASESTATION_IS_UNWANTED_S = 1;        // 1 second with no interaction
 constexpr int BASESTATION_SELECTION_UPDATE_FREQUENCY_MS = 420;  // Why 420? No reason at all...
 
-BasestationCollection::BasestationCollection() {
+BasestationCollection::BasestationCollection(libusb_context* usbContext, EventLoop& eventLoop, const BasestationCollectionConfiguration& configuration)
+    : usbContext(usbContext),
+      eventLoop(eventLoop),
+      channelMapFile(configuration.channelMapFile),
+      keepBasestationsWarm(configuration.keepBasestationsWarm),
+      isSelectionUpdateRequested(false),
+      yellowColdPathDrops(0),
+      blueColdPathDrops(0) {
+    this->loadChannelMap();
+    if (this->keepBasestationsWarm) RTT_INFO("Keeping the basestations of both teams selected")
+
     this->shouldUpdateBasestationSelection = true;
     this->basestationSelectionUpdaterThread = std::thread(&BasestationCollection::updateBasestationSelection, this);
 }
 BasestationCollection::~BasestationCollection() {
     this->shouldUpdateBasestationSelection = false;
+    this->requestBasestationSelectionUpdate();
     if (this->basestationSelectionUpdaterThread.joinable()) {
         this->basestationSelectionUpdaterThread.join();
     }
@@ -65,12 +79,23 @@ void BasestationCollection::addNewBasestations(const std::vector<libusb_device*>
         if (!deviceIsInBasestationList(pluggedBasestationDevice, this->basestations)) {
             // This basestation device is plugged in but not in our list -> add it
             try {
-                auto newBasestation = std::make_shared<Basestation>(pluggedBasestationDevice);
+                auto newBasestation = std::make_shared<Basestation>(this->usbContext, this->eventLoop, pluggedBasestationDevice);
                 newBasestation->setIncomingMessageCallback(callbackForNewBasestations);
 
-                // Lock the basestations list so we can safely add this basestation
-                std::scoped_lock<std::mutex> lock(this->basestationsMutex);
-                this->basestations.push_back(newBasestation);
+                {
+                    // Lock the basestations list so we can safely add this basestation
+                    std::scoped_lock<std::mutex> lock(this->basestationsMutex);
+                    this->basestations.push_back(newBasestation);
+                }
+
+                // Assume it is still on its remembered channel, so it can be selected right away after a restart. It is
+                // asked anyway, and unselected if its reply shows that something else changed its channel meanwhile
+                auto rememberedChannel = this->getRememberedChannel(newBasestation->getSerialNumber());
+                if (rememberedChannel != WirelessChannel::UNKNOWN) {
+                    this->setChannelOfBasestation(newBasestation->getIdentifier(), rememberedChannel);
+                    this->requestBasestationSelectionUpdate();
+                }
+                askChannelOfBasestation(newBasestation);
             } catch (const FailedToOpenDeviceException &e) {
                 RTT_ERROR(e.what())
                 RTT_INFO("Did you edit your PC's user permissions?")
@@ -85,10 +110,17 @@ int BasestationCollection::sendMessageToBasestation(BasestationMessage& message,
     int bytesSent = -1;
     if (basestation != nullptr) {
         bytesSent = basestation->sendMessageToBasestation(message);
+    } else {
+        (teamColor == rtt::Team::YELLOW ? this->yellowColdPathDrops : this->blueColdPathDrops)++;
     }
 
+    // If this team was not wanted until now, select its basestation right away instead of at the next periodic update
+    auto lastRequest = (teamColor == rtt::Team::YELLOW ? this->lastRequestForYellowBasestation : this->lastRequestForBlueBasestation).load(std::memory_order_relaxed);
+    bool wasUnwanted = std::chrono::steady_clock::now() - lastRequest > std::chrono::seconds(TIME_UNTIL_BASESTATION_IS_UNWANTED_S);
+
     // Update our basestations usage
     this->updateWantedBasestations(teamColor);
+    if (wasUnwanted && basestation == nullptr) this->requestBasestationSelectionUpdate();
 
     return bytesSent;
 }
@@ -97,11 +129,17 @@ void BasestationCollection::setIncomingMessageCallback(std::function<void(const
     this->messageFromBasestationCallback = callback;
 }
 
+void BasestationCollection::setIncomingLogCallback(std::function<void(const BasestationIdentifier&, std::optional<rtt::Team>, std::span<const uint8_t>)> callback) {
+    this->logFromBasestationCallback = callback;
+}
+
 BasestationCollectionStatus BasestationCollection::getStatus() const {
     const BasestationCollectionStatus status{.wantedBasestations = this->getWantedBasestations(),
                                              .hasYellowBasestation = this->getSelectedBasestation(rtt::Team::YELLOW) != nullptr,
                                              .hasBlueBasestation = this->getSelectedBasestation(rtt::Team::BLUE) != nullptr,
-                                             .amountOfBasestations = (int)basestations.size()};
+                                             .amountOfBasestations = (int)basestations.size(),
+                                             .yellowColdPathDrops = this->yellowColdPathDrops.load(),
+                                             .blueColdPathDrops = this->blueColdPathDrops.load()};
 
     return status;
 }
@@ -121,7 +159,7 @@ std::vector<std::shared_ptr<Basestation>> BasestationCollection::getAllBasestati
 std::shared_ptr<Basestation> BasestationCollection::getSelectedBasestation(rtt::Team colorOfBasestation) const {
     std::shared_ptr<Basestation> basestation;
 
-    std::scoped_lock<std::mutex> lock(this->basestationSelectionMutex);
+    std::scoped_lock<PriorityInheritanceMutex> lock(this->basestationSelectionMutex);
 
     switch (colorOfBasestation) {
         case rtt::Team::BLUE:
@@ -136,7 +174,7 @@ std::shared_ptr<Basestation> BasestationCollection::getSelectedBasestation(rtt::
 }
 
 void BasestationCollection::setSelectedBasestation(const std::shared_ptr<Basestation>& newBasestation, rtt::Team color) {
-    std::scoped_lock<std::mutex> lock(this->basestationSelectionMutex);
+    std::scoped_lock<PriorityInheritanceMutex> lock(this->basestationSelectionMutex);
     switch (color) {
         case rtt::Team::BLUE:
             this->blueBasestation = newBasestation;
@@ -175,12 +213,72 @@ void BasestationCollection::removeBasestationIdToChannelEntry(const BasestationI
     this->basestationIdToChannel.erase(basestationId);
 }
 
+void BasestationCollection::loadChannelMap() {
+    if (this->channelMapFile.empty()) return;
+
+    std::ifstream file(this->channelMapFile);
+    if (!file.is_open()) return;  // Nothing remembered yet
+
+    // Every line contains a serial number and a channel, separated by the last space
+    std::scoped_lock<std::mutex> lock(this->serialNumberToChannelMutex);
+    std::string line;
+    while (std::getline(file, line)) {
+        auto separator = line.rfind(' ');
+        if (separator == std::string::npos || separator == 0) continue;
+
+        auto channel = stringToWirelessChannel(line.substr(separator + 1));
+        if (channel.has_value()) this->serialNumberToChannel[line.substr(0, separator)] = channel.value();
+    }
+    RTT_INFO("Remembered the channels of ", this->serialNumberToChannel.size(), " basestations from ", this->channelMapFile)
+}
+
+void BasestationCollection::rememberChannelOfBasestation(const BasestationIdentifier& basestationId, WirelessChannel channel) {
+    if (this->channelMapFile.empty() || channel == WirelessChannel::UNKNOWN) return;
+
+    std::string serialNumber;
+    for (const auto& basestation : this->getAllBasestations()) {
+        if (*basestation == basestationId) serialNumber = basestation->getSerialNumber();
+    }
+    if (serialNumber.empty()) return;
+
+    std::scoped_lock<std::mutex> lock(this->serialNumberToChannelMutex);
+    auto iterator = this->serialNumberToChannel.find(serialNumber);
+    if (iterator != this->serialNumberToChannel.end() && iterator->second == channel) return;
+    this->serialNumberToChannel[serialNumber] = channel;
+
+    // Write to a temporary file first, so a crash halfway never leaves a broken channel map behind
+    std::string temporaryFile = this->channelMapFile + ".tmp";
+    {
+        std::ofstream file(temporaryFile, std::ios::trunc);
+        for (const auto& [serial, rememberedChannel] : this->serialNumberToChannel) {
+            file << serial << ' ' << (rememberedChannel == WirelessChannel::BLUE_CHANNEL ? "blue" : "yellow") << '\n';
+        }
+        if (!file) {
+            RTT_WARNING("Failed to write the basestation channel map to ", temporaryFile)
+            return;
+        }
+    }
+    if (std::rename(temporaryFile.c_str(), this->channelMapFile.c_str()) != 0) {
+        RTT_WARNING("Failed to replace the basestation channel map ", this->channelMapFile)
+    }
+}
+
+WirelessChannel BasestationCollection::getRememberedChannel(const std::string& serialNumber) {
+    if (serialNumber.empty()) return WirelessChannel::UNKNOWN;
+
+    std::scoped_lock<std::mutex> lock(this->serialNumberToChannelMutex);
+    auto iterator = this->serialNumberToChannel.find(serialNumber);
+    return iterator != this->serialNumberToChannel.end() ? iterator->second : WirelessChannel::UNKNOWN;
+}
+
 WantedBasestations BasestationCollection::getWantedBasestations() const {
+    if (this->keepBasestationsWarm) return WantedBasestations::YELLOW_AND_BLUE;
+
     auto now = std::chrono::steady_clock::now();
 
     // Calculate how long ago the basestations were used
-    auto timeAfterLastYellowUsage = std::chrono::duration_cast<std::chrono::seconds>(now - this->lastRequestForYellowBasestation).count();
-    auto timeAfterLastBlueUsage = std::chrono::duration_cast<std::chrono::seconds>(now - this->lastRequestForBlueBasestation).count();
+    auto timeAfterLastYellowUsage = std::chrono::duration_cast<std::chrono::seconds>(now - this->lastRequestForYellowBasestation.load(std::memory_order_relaxed)).count();
+    auto timeAfterLastBlueUsage = std::chrono::duration_cast<std::chrono::seconds>(now - this->lastRequestForBlueBasestation.load(std::memory_order_relaxed)).count();
 
     // If they were used recently enough, we say we still want them
     bool wantsYellowBasestation = timeAfterLastYellowUsage <= TIME_UNTIL_BASESTATION_IS_UNWANTED_S;
@@ -206,10 +304,10 @@ void BasestationCollection::updateWantedBasestations(rtt::Team requestedBasestat
 
     switch (requestedBasestationColor) {
         case rtt::Team::YELLOW:
-            this->lastRequestForYellowBasestation = now;
+            this->lastRequestForYellowBasestation.store(now, std::memory_order_relaxed);
             break;
         case rtt::Team::BLUE:
-            this->lastRequestForBlueBasestation = now;
+            this->lastRequestForBlueBasestation.store(now, std::memory_order_relaxed);
             break;
     }
 }
@@ -227,11 +325,30 @@ void BasestationCollection::updateBasestationSelection() {
 
         this->selectWantedBasestations();
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(BASESTATION_SELECTION_UPDATE_FREQUENCY_MS));
+        std::unique_lock<std::mutex> lock(this->selectionUpdateMutex);
+        this->selectionUpdateRequested.wait_for(lock, std::chrono::milliseconds(BASESTATION_SELECTION_UPDATE_FREQUENCY_MS), [this] { return this->isSelectionUpdateRequested; });
+        this->isSelectionUpdateRequested = false;
+    }
+}
+
+void BasestationCollection::requestBasestationSelectionUpdate() {
+    {
+        std::scoped_lock<std::mutex> lock(this->selectionUpdateMutex);
+        this->isSelectionUpdateRequested = true;
     }
+    this->selectionUpdateRequested.notify_one();
 }
 
 void BasestationCollection::askChannelOfBasestationsWithUnknownChannel() const {
+    for (const auto& basestation : this->getAllBasestations()) {
+        WirelessChannel channel = this->getChannelOfBasestation(basestation->getIdentifier());
+        if (channel == WirelessChannel::UNKNOWN) {
+            askChannelOfBasestation(basestation);
+        }
+    }
+}
+
+void BasestationCollection::askChannelOfBasestation(const std::shared_ptr<Basestation>& basestation) {
     // Create the channel request message
     REM_BasestationGetConfiguration getConfigurationMessage = {0};
     getConfigurationMessage.header = REM_PACKET_TYPE_REM_BASESTATION_GET_CONFIGURATION;
@@ -247,14 +364,8 @@ void BasestationCollection::askChannelOfBasestationsWithUnknownChannel() const {
     message.payloadSize = REM_PACKET_SIZE_REM_BASESTATION_GET_CONFIGURATION;
     std::memcpy(&message.payloadBuffer, &getConfigurationPayload.payload, message.payloadSize);
 
-    // Send it to every basestation with unknown channel
-    for (const auto& basestation : this->getAllBasestations()) {
-        WirelessChannel channel = this->getChannelOfBasestation(basestation->getIdentifier());
-        if (channel == WirelessChannel::UNKNOWN) {
-            RTT_DEBUG("Sent GET_CONFIGURATION to basestation ", basestation->getIdentifier().toString());
-            basestation->sendMessageToBasestation(message);
-        }
-    }
+    RTT_DEBUG("Sent GET_CONFIGURATION to basestation ", basestation->getIdentifier().toString());
+    basestation->sendMessageToBasestation(message);
 }
 
 std::vector<std::shared_ptr<Basestation>> BasestationCollection::getSelectableBasestations() const {
@@ -451,15 +562,27 @@ void BasestationCollection::onMessageFromBasestation(const BasestationMessage& m
     if (REM_Packet_get_header(packetPayload) == REM_PACKET_TYPE_REM_BASESTATION_CONFIGURATION) {
         uint8_t basestation_channel_rem = REM_BasestationConfiguration_get_channel( (REM_BasestationConfigurationPayload*) message.payloadBuffer );
         WirelessChannel basestation_channel = BasestationCollection::remChannelToWirelessChannel(basestation_channel_rem);
+        WirelessChannel previousChannel = this->getChannelOfBasestation(basestationId);
         this->setChannelOfBasestation(basestationId, basestation_channel);
+        this->rememberChannelOfBasestation(basestationId, basestation_channel);
+
+        // A basestation that was selected on its remembered channel may turn out to be on the other one. Unselect it right
+        // away, so the commands of its team do not go to the robots of the other team until the next selection update
+        if (previousChannel != WirelessChannel::UNKNOWN && previousChannel != basestation_channel && this->unselectIncorrectlySelectedBasestations() > 0) {
+            RTT_WARNING("Basestation ", basestationId.toString(), " is on the ", wirelessChannelToString(basestation_channel), " instead of the remembered ",
+                        wirelessChannelToString(previousChannel), ", so it is unselected")
+        }
+        this->requestBasestationSelectionUpdate();
     }
 
-    if(REM_Packet_get_header(packetPayload) == REM_PACKET_TYPE_REM_LOG){
+    // Only the text of a log is copied here, as formatting and writing it would delay the next message
+    if (REM_Packet_get_header(packetPayload) == REM_PACKET_TYPE_REM_LOG && this->logFromBasestationCallback != nullptr) {
         REM_LogPayload* logPayload = (REM_LogPayload*) message.payloadBuffer;
-        uint32_t message_length = REM_Log_get_payloadSize(logPayload) - REM_PACKET_SIZE_REM_LOG;
-        char* charstring = (char*) &message.payloadBuffer[REM_PACKET_SIZE_REM_LOG];
-        std::string str = std::string(charstring, message_length);
-        std::cout << "[BS]" << str; // Logs should always end with \n, so no std::endl needed
+        int logSize = std::min(static_cast<int>(REM_Log_get_payloadSize(logPayload)), message.payloadSize);
+        if (logSize > REM_PACKET_SIZE_REM_LOG) {
+            std::span<const uint8_t> text(message.payloadBuffer + REM_PACKET_SIZE_REM_LOG, logSize - REM_PACKET_SIZE_REM_LOG);
+            this->logFromBasestationCallback(basestationId, this->getTeamOfSelectedBasestation(basestationId), text);
+        }
     }
 
     // This function can be called by multiple basestations simultaneously, so protect it with a mutex
@@ -480,6 +603,16 @@ void BasestationCollection::onMessageFromBasestation(const BasestationMessage& m
     }
 }
 
+std::optional<rtt::Team> BasestationCollection::getTeamOfSelectedBasestation(const BasestationIdentifier& basestationId) const {
+    const auto selectedYellowCopy = this->getSelectedBasestation(rtt::Team::YELLOW);
+    if (selectedYellowCopy != nullptr && selectedYellowCopy->operator==(basestationId)) return rtt::Team::YELLOW;
+
+    const auto selectedBlueCopy = this->getSelectedBasestation(rtt::Team::BLUE);
+    if (selectedBlueCopy != nullptr && selectedBlueCopy->operator==(basestationId)) return rtt::Team::BLUE;
+
+    return std::nullopt;
+}
+
 WirelessChannel BasestationCollection::getWirelessChannelCorrespondingTeamColor(rtt::Team color) {
     WirelessChannel matchingWirelessChannel;
 
@@ -562,4 +695,10 @@ std::string BasestationCollection::wirelessChannelToString(WirelessChannel chann
     }
 }
 
+std::optional<WirelessChannel> BasestationCollection::stringToWirelessChannel(const std::string& channel) {
+    if (channel == "yellow") return WirelessChannel::YELLOW_CHANNEL;
+    if (channel == "blue") return WirelessChannel::BLUE_CHANNEL;
+    return std::nullopt;
+}
+
 }  // namespace rtt::robothub::basestation
\ No newline at end of file
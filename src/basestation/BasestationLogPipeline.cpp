@@ -0,0 +1,138 @@
+#include <roboteam_utils/Print.h>
+
+#include <algorithm>
+#include <basestation/BasestationLogPipeline.hpp>
+#include <cstring>
+
+namespace rtt::robothub::basestation {
+
+constexpr std::chrono::milliseconds IDLE_WRITER_COOLDOWN(10);     // Sleep of the writer when the ring was empty. Logs are not urgent
+constexpr std::chrono::seconds RATE_LIMIT_WINDOW(1);              // Logs are counted per window
+constexpr std::chrono::seconds DROPPED_LOGS_REPORT_INTERVAL(1);  // Drops are reported at most this often
+
+// The usb address changes with every replug, so only the serial identifier is part of the key
+static uint32_t toRateLimitKey(const BasestationIdentifier& basestation) { return 1 + static_cast<uint32_t>(basestation.serialIdentifier); }
+
+static int64_t getSteadyTimeNs() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
+BasestationLogPipeline::BasestationLogPipeline(const std::function<void(const std::string&, const BasestationIdentifier&, std::optional<rtt::Team>)>& handler,
+                                               int maxLogsPerSecond, std::size_t capacity)
+    : handler(handler), maxLogsPerSecond(maxLogsPerSecond), ring(capacity) {
+    this->droppedLogs = 0;
+
+    this->shouldWrite = true;
+    this->writerThread = std::thread(&BasestationLogPipeline::write, this);
+}
+
+BasestationLogPipeline::~BasestationLogPipeline() {
+    this->shouldWrite = false;
+    if (this->writerThread.joinable()) this->writerThread.join();
+
+    // Hand over whatever was pushed after the writer thread stopped
+    this->drainRing();
+    this->reportDroppedLogs();
+}
+
+bool BasestationLogPipeline::push(const BasestationIdentifier& basestation, std::optional<rtt::Team> team, std::span<const uint8_t> text) {
+    if (!this->isWithinRateLimit(basestation)) {
+        this->droppedLogs.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    bool isPushed = this->ring.tryPush([&](BasestationLog& log) {
+        std::size_t length = std::min(text.size(), MAX_BASESTATION_LOG_LENGTH);
+        log.basestation = basestation;
+        log.team = static_cast<int8_t>(team.has_value() ? (team.value() == rtt::Team::BLUE ? 1 : 0) : -1);
+        log.length = static_cast<uint16_t>(length);
+        std::memcpy(log.text, text.data(), length);
+    });
+    // When the ring is full, the writer fell behind
+    if (!isPushed) this->droppedLogs.fetch_add(1, std::memory_order_relaxed);
+    return isPushed;
+}
+
+uint64_t BasestationLogPipeline::getDroppedLogs() const { return this->droppedLogs.load(std::memory_order_relaxed); }
+
+bool BasestationLogPipeline::isWithinRateLimit(const BasestationIdentifier& basestation) {
+    // Find the limit of this basestation, or claim an unused one
+    uint32_t key = toRateLimitKey(basestation);
+    RateLimit* limit = &this->rateLimits.back();
+    for (auto& candidate : this->rateLimits) {
+        uint32_t candidateKey = candidate.key.load(std::memory_order_acquire);
+        if (candidateKey == 0 && candidate.key.compare_exchange_strong(candidateKey, key, std::memory_order_acq_rel)) candidateKey = key;
+        if (candidateKey == key) {
+            limit = &candidate;
+            break;
+        }
+    }
+
+    // Threads that race at the start of a window may both reset it, which only lets a few more logs through
+    int64_t now = getSteadyTimeNs();
+    int64_t windowStart = limit->windowStartNs.load(std::memory_order_relaxed);
+    if (now - windowStart >= std::chrono::nanoseconds(RATE_LIMIT_WINDOW).count() &&
+        limit->windowStartNs.compare_exchange_strong(windowStart, now, std::memory_order_relaxed)) {
+        limit->logsInWindow.store(0, std::memory_order_relaxed);
+    }
+
+    if (limit->logsInWindow.fetch_add(1, std::memory_order_relaxed) < this->maxLogsPerSecond) return true;
+    limit->droppedLogs.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void BasestationLogPipeline::write() {
+    auto lastReport = std::chrono::steady_clock::now();
+
+    while (this->shouldWrite) {
+        bool drainedAny = this->drainRing();
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastReport >= DROPPED_LOGS_REPORT_INTERVAL) {
+            this->reportDroppedLogs();
+            lastReport = now;
+        }
+
+        if (!drainedAny) std::this_thread::sleep_for(IDLE_WRITER_COOLDOWN);
+    }
+}
+
+bool BasestationLogPipeline::drainRing() {
+    bool drainedAny = false;
+
+    std::string log;
+    BasestationIdentifier basestation{};
+    int8_t team = -1;
+    // Copy the log out of its slot, so the slot is free again before calling the handler, and producers can use it meanwhile
+    auto copyLog = [&](const BasestationLog& basestationLog) {
+        log.assign(basestationLog.text, basestationLog.length);
+        basestation = basestationLog.basestation;
+        team = basestationLog.team;
+    };
+
+    while (this->ring.tryPop(copyLog)) {
+        drainedAny = true;
+
+        // Logs end with a newline, which the handler does not want
+        while (!log.empty() && (log.back() == '\n' || log.back() == '\r')) log.pop_back();
+        if (log.empty()) {
+            RTT_WARNING("Received empty log message from basestation ", basestation.toString())
+            continue;
+        }
+
+        std::optional<rtt::Team> logTeam;
+        if (team >= 0) logTeam = team == 1 ? rtt::Team::BLUE : rtt::Team::YELLOW;
+        this->handler(log, basestation, logTeam);
+    }
+    return drainedAny;
+}
+
+void BasestationLogPipeline::reportDroppedLogs() {
+    for (auto& limit : this->rateLimits) {
+        uint32_t key = limit.key.load(std::memory_order_acquire);
+        if (key == 0) continue;
+
+        uint64_t dropped = limit.droppedLogs.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0) RTT_WARNING("Dropped ", dropped, " logs of the basestation with serial identifier ", key - 1, ", which logs more than ", this->maxLogsPerSecond, " times per second")
+    }
+}
+
+}  // namespace rtt::robothub::basestation
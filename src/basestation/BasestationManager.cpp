@@ -1,4 +1,7 @@
 #include <basestation/BasestationManager.hpp>
+#include <poll.h>
+#include <sys/epoll.h>
+
 #include <cstring>
 #include <REM_BaseTypes.h>
 #include <REM_Packet.h>
@@ -7,31 +10,62 @@
 
 namespace rtt::robothub::basestation {
 
-BasestationManager::BasestationManager() {
+constexpr std::chrono::milliseconds BASESTATION_PLUGS_CHECK_INTERVAL(500);  // How often the list of usb devices is checked for new basestations
+constexpr std::chrono::milliseconds USB_TIMEOUT_CHECK_INTERVAL(10);          // How often usb timeouts are handled, if libusb can not signal them itself
+constexpr std::chrono::microseconds MAX_USB_EVENT_HANDLER_WAIT(1000);       // How long the loop waits for another thread that handles usb events
+
+BasestationManager::BasestationManager() : BasestationManager(BasestationManagerConfiguration()) {}
+
+BasestationManager::BasestationManager(const BasestationManagerConfiguration& configuration) {
+    this->logPipeline = std::make_unique<BasestationLogPipeline>(
+        [this](const std::string& log, const BasestationIdentifier& basestation, std::optional<rtt::Team> color) { this->handleBasestationLog(log, basestation, color); });
+
+    if (configuration.useStandInBasestations) {
+        RTT_INFO("Using stand-in basestations instead of usb")
+        return;
+    }
+
     int error;
     error = libusb_init(&this->usbContext);
     if (error) {
         throw FailedToInitializeLibUsb("Failed to initialize libusb");
     }
 
-    this->basestationCollection = std::make_unique<BasestationCollection>();
+    // Watch the file descriptors of libusb, including those it adds later when devices are opened
+    this->usbEventLoop = std::make_unique<EventLoop>("robothub-usb", ThreadRole::USB);
+    libusb_set_pollfd_notifiers(this->usbContext, &BasestationManager::onUsbFileDescriptorAdded, &BasestationManager::onUsbFileDescriptorRemoved, this);
+    const libusb_pollfd **pollFileDescriptors = libusb_get_pollfds(this->usbContext);
+    if (pollFileDescriptors != nullptr) {
+        for (int i = 0; pollFileDescriptors[i] != nullptr; ++i) this->watchUsbFileDescriptor(pollFileDescriptors[i]->fd, pollFileDescriptors[i]->events);
+        libusb_free_pollfds(pollFileDescriptors);
+    }
+    if (!libusb_pollfds_handle_timeouts(this->usbContext)) {
+        this->usbTimeoutTimer = this->usbEventLoop->addTimer(USB_TIMEOUT_CHECK_INTERVAL, [this] { this->handleUsbEvents(); });
+    }
+
+    this->basestationCollection = std::make_unique<BasestationCollection>(this->usbContext, *this->usbEventLoop, configuration.collection);
     this->basestationCollection->setIncomingMessageCallback([&](const BasestationMessage& message, rtt::Team color) { this->handleIncomingMessage(message, color); });
+    this->basestationCollection->setIncomingLogCallback([&](const BasestationIdentifier& basestation, std::optional<rtt::Team> color, std::span<const uint8_t> text) {
+        this->logPipeline->push(basestation, color, text);
+    });
 
-    this->shouldListenForBasestationPlugs = true;
-    this->basestationPlugsListener = std::thread(&BasestationManager::listenForBasestationPlugs, this);
+    this->basestationPlugsTimer = this->usbEventLoop->addTimer(BASESTATION_PLUGS_CHECK_INTERVAL, [this] { this->checkForBasestationPlugs(); });
 }
 
 BasestationManager::~BasestationManager() {
-    // Stop threads
-    this->shouldListenForBasestationPlugs = false;
-    if (this->basestationPlugsListener.joinable()) {
-        this->basestationPlugsListener.join();
-    }
+    // Stand-in basestations have nothing to stop
+    if (this->usbContext == nullptr) return;
+
+    // Stop checking for plugs, which could add basestations
+    this->usbEventLoop->remove(this->basestationPlugsTimer);
 
     // In destructor of basestation objects, the usb device is closed. This needs to be done
     // before libusb_exit() is called, so delete all basestation objects now
     this->basestationCollection = nullptr;
 
+    // The loop handles usb events, so it must be gone before libusb is
+    libusb_set_pollfd_notifiers(this->usbContext, nullptr, nullptr, nullptr);
+    this->usbEventLoop = nullptr;
     libusb_exit(this->usbContext);
 }
 
@@ -41,12 +75,15 @@ int BasestationManager::sendRobotCommand(const REM_RobotCommand& command, rtt::T
     REM_RobotCommandPayload payload;
     encodeREM_RobotCommand(&payload, &copy);
 
+    return this->sendRobotCommandPayload(payload, color);
+}
+
+int BasestationManager::sendRobotCommandPayload(const REM_RobotCommandPayload& payload, rtt::Team color) const {
     BasestationMessage message;
     message.payloadSize = REM_PACKET_SIZE_REM_ROBOT_COMMAND;
     std::memcpy(&message.payloadBuffer, payload.payload, message.payloadSize);
 
-    int bytesSent = this->basestationCollection->sendMessageToBasestation(message, color);
-    return bytesSent;
+    return this->sendMessage(message, color);
 }
 
 int BasestationManager::sendRobotBuzzerCommand(const REM_RobotBuzzer& command, rtt::Team color) const {
@@ -59,34 +96,108 @@ int BasestationManager::sendRobotBuzzerCommand(const REM_RobotBuzzer& command, r
     message.payloadSize = REM_PACKET_SIZE_REM_ROBOT_BUZZER;
     std::memcpy(message.payloadBuffer, payload.payload, message.payloadSize);
 
+    return this->sendMessage(message, color);
+}
+
+int BasestationManager::sendMessage(BasestationMessage& message, rtt::Team color) const {
+    // Stand-in basestations accept every message
+    if (this->basestationCollection == nullptr) return message.payloadSize;
+
     int bytesSent = this->basestationCollection->sendMessageToBasestation(message, color);
     return bytesSent;
 }
 
+void BasestationManager::injectIncomingPacket(const uint8_t* packet, std::size_t size, rtt::Team color) const {
+    if (size > static_cast<std::size_t>(BASESTATION_MESSAGE_BUFFER_SIZE)) {
+        RTT_WARNING("Dropping injected packet of ", size, " bytes, which does not fit in a basestation message")
+        return;
+    }
+
+    BasestationMessage message;
+    message.payloadSize = static_cast<int>(size);
+    std::memcpy(message.payloadBuffer, packet, size);
+
+    // Logs of real basestations reach the pipeline through the collection, so injected ones are pushed here
+    if (message.payloadSize > REM_PACKET_SIZE_REM_LOG && REM_Packet_get_header((REM_PacketPayload*) message.payloadBuffer) == REM_PACKET_TYPE_REM_LOG) {
+        std::span<const uint8_t> text(message.payloadBuffer + REM_PACKET_SIZE_REM_LOG, message.payloadSize - REM_PACKET_SIZE_REM_LOG);
+        this->logPipeline->push({.usbAddress = 0, .serialIdentifier = 0}, color, text);
+    }
+    this->handleIncomingMessage(message, color);
+}
+
 void BasestationManager::setFeedbackCallback(const std::function<void(const REM_RobotFeedback&, rtt::Team)>& callback) { this->feedbackCallbackFunction = callback; }
 
 void BasestationManager::setRobotStateInfoCallback(const std::function<void(const REM_RobotStateInfo&, rtt::Team)>& callback) { this->robotStateInfoCallbackFunction = callback; }
 
 void BasestationManager::setBasestationLogCallback(const std::function<void(const std::string&, rtt::Team)>& callback) { this->basestationLogCallback = callback; }
 
-void BasestationManager::listenForBasestationPlugs() {
-    while (this->shouldListenForBasestationPlugs) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+void BasestationManager::setIncomingPacketCallback(const std::function<void(const uint8_t*, std::size_t, rtt::Team)>& callback) { this->incomingPacketCallback = callback; }
+
+void BasestationManager::onUsbFileDescriptorAdded(int fileDescriptor, short events, void* manager) {
+    static_cast<BasestationManager*>(manager)->watchUsbFileDescriptor(fileDescriptor, events);
+}
+
+void BasestationManager::onUsbFileDescriptorRemoved(int fileDescriptor, void* manager) { static_cast<BasestationManager*>(manager)->unwatchUsbFileDescriptor(fileDescriptor); }
 
-        // Get a list of devices
-        libusb_device** device_list;
-        auto device_count = libusb_get_device_list(this->usbContext, &device_list);
+void BasestationManager::watchUsbFileDescriptor(int fileDescriptor, short events) {
+    std::scoped_lock<std::mutex> lock(this->usbFileDescriptorsMutex);
+    if (this->usbFileDescriptorSources.contains(fileDescriptor)) return;
 
-        std::vector<libusb_device*> basestationDevices = filterBasestationDevices(device_list, static_cast<int>(device_count));
+    uint32_t epollEvents = ((events & POLLIN) ? EPOLLIN : 0) | ((events & POLLOUT) ? EPOLLOUT : 0);
+    int sourceId = this->usbEventLoop->addFileDescriptor(fileDescriptor, epollEvents, [this] { this->handleUsbEvents(); });
+    if (sourceId >= 0) this->usbFileDescriptorSources[fileDescriptor] = sourceId;
+}
+
+void BasestationManager::unwatchUsbFileDescriptor(int fileDescriptor) {
+    int sourceId;
+    {
+        std::scoped_lock<std::mutex> lock(this->usbFileDescriptorsMutex);
+        auto iterator = this->usbFileDescriptorSources.find(fileDescriptor);
+        if (iterator == this->usbFileDescriptorSources.end()) return;
+        sourceId = iterator->second;
+        this->usbFileDescriptorSources.erase(iterator);
+    }
+    // Called by libusb while it holds its own locks, which a usb handler running on the loop may be waiting for
+    this->usbEventLoop->removeWithoutWaiting(sourceId);
+}
 
-        this->basestationCollection->updateBasestationCollection(basestationDevices);
+void BasestationManager::handleUsbEvents() {
+    // Only handle what is ready
+    if (libusb_try_lock_events(this->usbContext) == 0) {
+        timeval noWait = {.tv_sec = 0, .tv_usec = 0};
+        libusb_handle_events_locked(this->usbContext, &noWait);
+        libusb_unlock_events(this->usbContext);
+        return;
+    }
 
-        // Free the list of devices
-        libusb_free_device_list(device_list, true);
+    // Another thread is handling events, ours included. Until it did, the file descriptors stay ready, so returning right
+    // away would wake the loop again and again. Wait until it handled them instead, like libusb advises for event waiters
+    libusb_lock_event_waiters(this->usbContext);
+    if (libusb_event_handler_active(this->usbContext)) {
+        timeval maximumWait = {.tv_sec = 0, .tv_usec = MAX_USB_EVENT_HANDLER_WAIT.count()};
+        libusb_wait_for_event(this->usbContext, &maximumWait);
     }
+    libusb_unlock_event_waiters(this->usbContext);
+}
+
+void BasestationManager::checkForBasestationPlugs() {
+    // Get a list of devices
+    libusb_device** device_list;
+    auto device_count = libusb_get_device_list(this->usbContext, &device_list);
+
+    std::vector<libusb_device*> basestationDevices = filterBasestationDevices(device_list, static_cast<int>(device_count));
+
+    this->basestationCollection->updateBasestationCollection(basestationDevices);
+
+    // Free the list of devices
+    libusb_free_device_list(device_list, true);
 }
 
 BasestationManagerStatus BasestationManager::getStatus() const {
+    if (this->basestationCollection == nullptr) {
+        return {.basestationCollection = {.wantedBasestations = WantedBasestations::YELLOW_AND_BLUE, .hasYellowBasestation = true, .hasBlueBasestation = true, .amountOfBasestations = 2}};
+    }
+
     BasestationManagerStatus status = {.basestationCollection = this->basestationCollection->getStatus()};
 
     return status;
@@ -109,6 +220,10 @@ void BasestationManager::handleIncomingMessage(const BasestationMessage& message
     uint32_t payloadSize = REM_Packet_get_payloadSize(packetPayload);
     uint8_t packetType = REM_Packet_get_header(packetPayload);
 
+    if (this->incomingPacketCallback != nullptr) {
+        this->incomingPacketCallback(message.payloadBuffer, static_cast<std::size_t>(message.payloadSize), color);
+    }
+
     if(message.payloadSize != payloadSize) {
         RTT_ERROR("Payload size of message does not match the size specified in the packet header. Received size: ", message.payloadSize, ", indicated size: ", payloadSize);
         return;
@@ -136,34 +251,7 @@ void BasestationManager::handleIncomingMessage(const BasestationMessage& message
             break;
         }
         case REM_PACKET_TYPE_REM_LOG: {
-            REM_LogPayload payload;
-            std::memcpy(payload.payload, message.payloadBuffer, REM_PACKET_SIZE_REM_LOG);
-
-            REM_Log log;
-            decodeREM_Log(&log, &payload);
-            
-            uint32_t logLength = message.payloadSize - REM_PACKET_SIZE_REM_LOG;
-            
-            static constexpr int charsToSkip = 1; // We skip the last character of log messages, as its always a '\n'
-
-            // Convert the received log bytes into a string
-            std::ostringstream oss;
-            for (int i = REM_PACKET_SIZE_REM_LOG; i < message.payloadSize - charsToSkip; i++) {
-                oss << static_cast<char>(message.payloadBuffer[i]); // Convert uint32_t byte to char and store in stream
-            }
-            std::string logMessage = oss.str();
-
-            if (logMessage.length() == logLength - charsToSkip) {
-                // We correctly retrieved the log message
-                this->callBasestationLogCallback(logMessage, color);
-            } else if (logLength == 0) {
-                // We received an intended empty log message... But why?
-                RTT_WARNING("Received empty basestation log message")
-            } else {
-                // We ended up with a message shorter (or longer?) than what the length should have been
-                RTT_ERROR("BasestationLogMessage turned out wrongly sized (", logMessage.length(), " instead of ", logLength - charsToSkip, ")")
-            }
-
+            // Logs are handled by the logPipeline, which gets them before they reach this point
             break;
         }
         case REM_PACKET_TYPE_REM_ROBOT_PIDGAINS: {
@@ -189,6 +277,12 @@ void BasestationManager::callBasestationLogCallback(const std::string& basestati
     if (this->basestationLogCallback != nullptr) this->basestationLogCallback(basestationLog, color);
 }
 
+void BasestationManager::handleBasestationLog(const std::string& log, const BasestationIdentifier& basestation, std::optional<rtt::Team> color) const {
+    RTT_INFO("[BS ", basestation.toString(), "] ", log)
+    // Only logs of the selected basestations belong to a team
+    if (color.has_value()) this->callBasestationLogCallback(log, color.value());
+}
+
 FailedToInitializeLibUsb::FailedToInitializeLibUsb(const std::string& message) : message(message) {}
 const char* FailedToInitializeLibUsb::what() const noexcept { return this->message.c_str(); }
 
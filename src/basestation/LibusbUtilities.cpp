@@ -189,6 +189,26 @@ std::string usbutils_errorToString(int error) {
             return "Unknown error code " + std::to_string(error);
     }
 }
+std::string usbutils_transferStatusToString(int status) {
+    switch (status) {
+        case LIBUSB_TRANSFER_COMPLETED:
+            return "LIBUSB_TRANSFER_COMPLETED";
+        case LIBUSB_TRANSFER_ERROR:
+            return "LIBUSB_TRANSFER_ERROR";
+        case LIBUSB_TRANSFER_TIMED_OUT:
+            return "LIBUSB_TRANSFER_TIMED_OUT";
+        case LIBUSB_TRANSFER_CANCELLED:
+            return "LIBUSB_TRANSFER_CANCELLED";
+        case LIBUSB_TRANSFER_STALL:
+            return "LIBUSB_TRANSFER_STALL";
+        case LIBUSB_TRANSFER_NO_DEVICE:
+            return "LIBUSB_TRANSFER_NO_DEVICE";
+        case LIBUSB_TRANSFER_OVERFLOW:
+            return "LIBUSB_TRANSFER_OVERFLOW";
+        default:
+            return "Unknown transfer status " + std::to_string(status);
+    }
+}
 std::string usbutils_speedToString(int speed) {
     switch (speed) {
         case 0:
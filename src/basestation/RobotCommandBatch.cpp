@@ -0,0 +1,120 @@
+#include <REM_BaseTypes.h>
+
+#include <basestation/RobotCommandBatch.hpp>
+
+namespace rtt::robothub::basestation {
+
+REM_RobotCommand toREM_RobotCommand(const rtt::RobotCommand& robotCommand, rtt::Team color) {
+    REM_RobotCommand command = {};
+    command.header = REM_PACKET_TYPE_REM_ROBOT_COMMAND;
+    command.toRobotId = robotCommand.id;
+    command.toColor = color == rtt::Team::BLUE;
+    command.fromBS = true;
+    command.remVersion = REM_LOCAL_VERSION;
+    // command.messageId = 0; TODO implement incrementing message id
+    command.payloadSize = REM_PACKET_SIZE_REM_ROBOT_COMMAND;
+
+    command.kickAtAngle = robotCommand.kickAtAngle;
+    command.doKick = robotCommand.kickSpeed > 0.0 && robotCommand.kickType == KickType::KICK;
+    command.doChip = robotCommand.kickSpeed > 0.0 && robotCommand.kickType == KickType::CHIP;
+    command.doForce = !robotCommand.waitForBall;
+    command.kickChipPower = static_cast<float>(robotCommand.kickSpeed);
+    command.dribbler = static_cast<float>(robotCommand.dribblerSpeed);
+
+    command.rho = static_cast<float>(robotCommand.velocity.length());
+    command.theta = static_cast<float>(robotCommand.velocity.angle());
+
+    command.useAbsoluteAngle = !robotCommand.useAngularVelocity;
+    command.angle = static_cast<float>(robotCommand.targetAngle.getValue());
+    command.angularVelocity = static_cast<float>(robotCommand.targetAngularVelocity);
+
+    command.useCameraAngle = robotCommand.cameraAngleOfRobotIsSet;
+    command.cameraAngle = command.useCameraAngle ? static_cast<float>(robotCommand.cameraAngleOfRobot) : 0.0f;
+
+    command.feedback = robotCommand.ignorePacket;
+    return command;
+}
+
+void RobotCommandBatch::convert(std::span<const rtt::RobotCommand> commands, rtt::Team teamColor) {
+    this->color = teamColor;
+    this->resize(static_cast<int>(commands.size()));
+    this->gather(commands);
+    this->encode();
+}
+
+int RobotCommandBatch::size() const { return this->amount; }
+
+int RobotCommandBatch::getRobotId(int index) const { return this->robotId[index]; }
+
+const REM_RobotCommandPayload& RobotCommandBatch::getPayload(int index) const { return this->payloads[index]; }
+
+void RobotCommandBatch::resize(int newAmount) {
+    this->amount = newAmount;
+
+    // Vectors never shrink their capacity, so this only allocates when the batch is bigger than ever before
+    auto size = static_cast<std::size_t>(newAmount);
+    for (auto* floats : {&this->rho, &this->theta, &this->kickChipPower, &this->dribbler, &this->angle, &this->angularVelocity, &this->cameraAngle}) {
+        floats->resize(size);
+    }
+    for (auto* flags : {&this->kickAtAngle, &this->doKick, &this->doChip, &this->doForce, &this->useAbsoluteAngle, &this->useCameraAngle, &this->feedback}) {
+        flags->resize(size);
+    }
+    this->robotId.resize(size);
+    this->payloads.resize(size);
+}
+
+void RobotCommandBatch::gather(std::span<const rtt::RobotCommand> commands) {
+    for (int i = 0; i < this->amount; ++i) {
+        const auto& command = commands[i];
+        this->robotId[i] = command.id;
+        // REM truncates rho and theta, so these are computed exactly like toREM_RobotCommand does, or a packet could differ
+        this->rho[i] = static_cast<float>(command.velocity.length());
+        this->theta[i] = static_cast<float>(command.velocity.angle());
+        this->kickChipPower[i] = static_cast<float>(command.kickSpeed);
+        this->dribbler[i] = static_cast<float>(command.dribblerSpeed);
+        this->angle[i] = static_cast<float>(command.targetAngle.getValue());
+        this->angularVelocity[i] = static_cast<float>(command.targetAngularVelocity);
+        this->cameraAngle[i] = command.cameraAngleOfRobotIsSet ? static_cast<float>(command.cameraAngleOfRobot) : 0.0f;
+
+        bool kicks = command.kickSpeed > 0.0;
+        this->kickAtAngle[i] = command.kickAtAngle;
+        this->doKick[i] = kicks && command.kickType == KickType::KICK;
+        this->doChip[i] = kicks && command.kickType == KickType::CHIP;
+        this->doForce[i] = !command.waitForBall;
+        this->useAbsoluteAngle[i] = !command.useAngularVelocity;
+        this->useCameraAngle[i] = command.cameraAngleOfRobotIsSet;
+        this->feedback[i] = command.ignorePacket;
+    }
+}
+
+void RobotCommandBatch::encode() {
+    REM_RobotCommand command = {};
+    command.header = REM_PACKET_TYPE_REM_ROBOT_COMMAND;
+    command.toColor = this->color == rtt::Team::BLUE;
+    command.fromBS = true;
+    command.remVersion = REM_LOCAL_VERSION;
+    command.payloadSize = REM_PACKET_SIZE_REM_ROBOT_COMMAND;
+
+    // Only the fields that differ per robot are set in this loop
+    for (int i = 0; i < this->amount; ++i) {
+        command.toRobotId = this->robotId[i];
+        command.kickAtAngle = this->kickAtAngle[i];
+        command.doKick = this->doKick[i];
+        command.doChip = this->doChip[i];
+        command.doForce = this->doForce[i];
+        command.kickChipPower = this->kickChipPower[i];
+        command.dribbler = this->dribbler[i];
+        command.rho = this->rho[i];
+        command.theta = this->theta[i];
+        command.useAbsoluteAngle = this->useAbsoluteAngle[i];
+        command.angle = this->angle[i];
+        command.angularVelocity = this->angularVelocity[i];
+        command.useCameraAngle = this->useCameraAngle[i];
+        command.cameraAngle = this->cameraAngle[i];
+        command.feedback = this->feedback[i];
+
+        encodeREM_RobotCommand(&this->payloads[i], &command);
+    }
+}
+
+}  // namespace rtt::robothub::basestation
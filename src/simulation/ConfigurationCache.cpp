@@ -0,0 +1,85 @@
+#include <simulation/ConfigurationCache.hpp>
+
+namespace rtt::robothub::simulation {
+
+ConfigurationCache::ConfigurationCache(std::chrono::milliseconds coalesceWindow) : coalesceWindow(coalesceWindow) {}
+
+void ConfigurationCache::stageBallLocation(const BallLocation& location) {
+    std::scoped_lock<std::mutex> lock(this->cacheMutex);
+    this->stagedBallLocation = location;
+}
+
+void ConfigurationCache::stageRobotLocation(int id, rtt::Team color, const RobotLocation& location) {
+    std::scoped_lock<std::mutex> lock(this->cacheMutex);
+    this->stagedRobotLocations[{color, id}] = location;
+}
+
+void ConfigurationCache::stageRobotProperties(int id, rtt::Team color, const RobotProperties& properties) {
+    std::scoped_lock<std::mutex> lock(this->cacheMutex);
+    RobotKey key = {color, id};
+
+    auto applied = this->appliedRobotProperties.find(key);
+    if (applied != this->appliedRobotProperties.end() && applied->second == properties) {
+        this->stagedRobotProperties.erase(key);
+    } else {
+        this->stagedRobotProperties[key] = properties;
+    }
+}
+
+bool ConfigurationCache::takeDueChanges(ConfigurationCommand& command) {
+    std::scoped_lock<std::mutex> lock(this->cacheMutex);
+
+    auto now = std::chrono::steady_clock::now();
+    if (!this->hasStagedChanges() || now - this->lastTake < this->coalesceWindow) return false;
+
+    if (this->stagedBallLocation.has_value()) {
+        const auto& ball = this->stagedBallLocation.value();
+        command.setBallLocation(ball.x, ball.y, ball.z, ball.xVelocity, ball.yVelocity, ball.zVelocity, ball.velocityInRolling, ball.teleportSafely, ball.byForce);
+    }
+
+    for (const auto& [key, robot] : this->stagedRobotLocations) {
+        command.addRobotLocation(key.second, key.first, robot.x, robot.y, robot.xVelocity, robot.yVelocity, robot.angularVelocity, robot.orientation,
+                                 robot.shouldBePresentOnField, robot.byForce);
+    }
+
+    for (auto& [key, properties] : this->stagedRobotProperties) {
+        command.addRobotSpecs(key.second, key.first, properties);
+        this->takenRobotProperties.insert_or_assign(key, properties);
+    }
+
+    this->stagedBallLocation.reset();
+    this->stagedRobotLocations.clear();
+    this->stagedRobotProperties.clear();
+    this->lastTake = now;
+
+    return true;
+}
+
+void ConfigurationCache::confirmTakenChanges(bool isSent) {
+    std::scoped_lock<std::mutex> lock(this->cacheMutex);
+
+    for (auto& [key, properties] : this->takenRobotProperties) {
+        if (isSent) {
+            this->appliedRobotProperties.insert_or_assign(key, properties);
+        } else {
+            // Properties that were staged in the meantime are newer, so keep those
+            this->stagedRobotProperties.try_emplace(key, properties);
+        }
+    }
+    this->takenRobotProperties.clear();
+}
+
+void ConfigurationCache::forgetAppliedRobotProperties() {
+    std::scoped_lock<std::mutex> lock(this->cacheMutex);
+
+    for (auto& [key, properties] : this->appliedRobotProperties) {
+        this->stagedRobotProperties.try_emplace(key, properties);
+    }
+    this->appliedRobotProperties.clear();
+}
+
+bool ConfigurationCache::hasStagedChanges() const {
+    return this->stagedBallLocation.has_value() || !this->stagedRobotLocations.empty() || !this->stagedRobotProperties.empty();
+}
+
+}  // namespace rtt::robothub::simulation
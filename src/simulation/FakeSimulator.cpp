@@ -0,0 +1,126 @@
+#include <simulation/FakeSimulator.hpp>
+
+namespace rtt::robothub::simulation {
+
+constexpr int DEFAULT_AMOUNT_OF_LISTEN_THREADS = 1;
+constexpr const char* FAKE_ERROR_CODE = "FAKE_SIMULATOR_ERROR";
+
+static void bindSocket(QUdpSocket& socket, int port) {
+    if (!socket.bind(QHostAddress::AnyIPv4, port)) {
+        throw FailedToBindPortException("Fake simulator failed to bind to port(" + std::to_string(port) + "). Is it bound by another program?");
+    }
+}
+
+FakeSimulator::FakeSimulator(const FakeSimulatorConfiguration& config, std::shared_ptr<SimulatorIOPool> pool)
+    : configuration(config),
+      blueRandomGenerator(config.seed),
+      yellowRandomGenerator(config.seed + 1),
+      configurationRandomGenerator(config.seed + 2),
+      robotControlPackets(0), configurationPackets(0), errorsSent(0) {
+    this->ioPool = pool != nullptr ? pool : std::make_shared<SimulatorIOPool>(DEFAULT_AMOUNT_OF_LISTEN_THREADS);
+
+    bindSocket(this->blueControlSocket, config.blueControlPort);
+    bindSocket(this->yellowControlSocket, config.yellowControlPort);
+    bindSocket(this->configurationSocket, config.configurationPort);
+
+    this->listenToSocket(this->blueControlSocket, this->blueResponseLink, config.seed,
+                         [this] { this->answerRobotControls(this->blueControlSocket, this->blueResponseLink.get(), this->blueRandomGenerator); });
+    this->listenToSocket(this->yellowControlSocket, this->yellowResponseLink, config.seed + 1,
+                         [this] { this->answerRobotControls(this->yellowControlSocket, this->yellowResponseLink.get(), this->yellowRandomGenerator); });
+    this->listenToSocket(this->configurationSocket, this->configurationResponseLink, config.seed + 2, [this] { this->answerConfigurations(); });
+}
+
+FakeSimulator::~FakeSimulator() {
+    for (int taskId : this->listenTasks) {
+        this->ioPool->removeTask(taskId);
+    }
+    // The links send delayed responses using our sockets
+    this->blueResponseLink = nullptr;
+    this->yellowResponseLink = nullptr;
+    this->configurationResponseLink = nullptr;
+}
+
+void FakeSimulator::listenToSocket(QUdpSocket& socket, std::unique_ptr<ImpairedLink>& responseLink, uint64_t seed, const std::function<void()>& listener) {
+    auto& loop = this->ioPool->getLeastBusyLoop();
+    if (this->configuration.responseDelay.count() > 0) {
+        responseLink = std::make_unique<ImpairedLink>(LinkImpairmentSettings{.latency = this->configuration.responseDelay}, seed, loop);
+    }
+    this->listenTasks.push_back(this->ioPool->addSocketTask(loop, static_cast<int>(socket.socketDescriptor()), listener));
+}
+
+FakeSimulatorStatistics FakeSimulator::getStatistics() const {
+    return {.robotControlPackets = this->robotControlPackets.load(),
+            .configurationPackets = this->configurationPackets.load(),
+            .errorsSent = this->errorsSent.load()};
+}
+
+bool FakeSimulator::answerRobotControls(QUdpSocket& socket, ImpairedLink* responseLink, std::mt19937_64& randomGenerator) {
+    bool answered = false;
+    while (socket.hasPendingDatagrams()) {
+        QNetworkDatagram datagram = socket.receiveDatagram();
+        if (!datagram.isValid()) continue;
+        answered = true;
+        this->robotControlPackets++;
+
+        proto::simulation::RobotControl control;
+        control.ParseFromArray(datagram.data().data(), datagram.data().size());
+
+        proto::simulation::RobotControlResponse response;
+        for (const auto& command : control.robot_commands()) {
+            auto feedback = response.add_feedback();
+            feedback->set_id(command.id());
+            feedback->set_dribbler_ball_contact(isRandomlyTrue(this->configuration.ballContactProbability, randomGenerator));
+        }
+        this->addRandomError(*response.mutable_errors(), randomGenerator);
+
+        this->sendResponse(socket, responseLink, datagram, response);
+    }
+    return answered;
+}
+
+bool FakeSimulator::answerConfigurations() {
+    bool answered = false;
+    while (this->configurationSocket.hasPendingDatagrams()) {
+        QNetworkDatagram datagram = this->configurationSocket.receiveDatagram();
+        if (!datagram.isValid()) continue;
+        answered = true;
+        this->configurationPackets++;
+
+        // The content of the configuration does not matter, as nothing is simulated
+        proto::simulation::SimulatorResponse response;
+        this->addRandomError(*response.mutable_errors(), this->configurationRandomGenerator);
+
+        this->sendResponse(this->configurationSocket, this->configurationResponseLink.get(), datagram, response);
+    }
+    return answered;
+}
+
+void FakeSimulator::addRandomError(google::protobuf::RepeatedPtrField<proto::simulation::SimulatorError>& errors, std::mt19937_64& randomGenerator) {
+    if (!isRandomlyTrue(this->configuration.errorProbability, randomGenerator)) return;
+
+    auto error = errors.Add();
+    error->set_code(FAKE_ERROR_CODE);
+    error->set_message("Error made up by the fake simulator");
+    this->errorsSent++;
+}
+
+bool FakeSimulator::isRandomlyTrue(double probability, std::mt19937_64& randomGenerator) {
+    if (probability <= 0.0) return false;
+    if (probability >= 1.0) return true;
+    return std::uniform_real_distribution<double>(0.0, 1.0)(randomGenerator) < probability;
+}
+
+void FakeSimulator::sendResponse(QUdpSocket& socket, ImpairedLink* responseLink, const QNetworkDatagram& request, const google::protobuf::Message& response) {
+    QByteArray bytes;
+    bytes.resize(static_cast<int>(response.ByteSizeLong()));
+    response.SerializeToArray(bytes.data(), bytes.size());
+    QNetworkDatagram reply = request.makeReply(bytes);
+
+    if (responseLink == nullptr) {
+        socket.writeDatagram(reply);
+    } else {
+        responseLink->submit(bytes.size(), [&socket, reply] { socket.writeDatagram(reply); });
+    }
+}
+
+}  // namespace rtt::robothub::simulation
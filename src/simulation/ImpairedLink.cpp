@@ -0,0 +1,98 @@
+#include <simulation/ImpairedLink.hpp>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace rtt::robothub::simulation {
+
+constexpr std::size_t MAX_SCHEDULED_PACKETS = 4096;  // Like a real queue, a full link drops packets
+
+bool ImpairedLink::ScheduledPacket::operator>(const ScheduledPacket& other) const {
+    if (this->deliveryTime == other.deliveryTime) return this->sequenceNumber > other.sequenceNumber;
+    return this->deliveryTime > other.deliveryTime;
+}
+
+ImpairedLink::ImpairedLink(const LinkImpairmentSettings& settings, uint64_t seed, EventLoop& loop) : settings(settings), loop(loop), randomGenerator(seed) {
+    this->linkBusyUntil = std::chrono::steady_clock::now();
+    this->nextSequenceNumber = 0;
+
+    // The steady clock is the monotonic clock, so delivery times can be used as expirations of the timer
+    this->timerDescriptor = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (this->timerDescriptor < 0) throw FailedToCreateEventLoopException("Failed to create delivery timer: " + std::string(std::strerror(errno)));
+
+    this->deliverySourceId = this->loop.addFileDescriptor(this->timerDescriptor, EPOLLIN, [this] { this->deliverDuePackets(); });
+    if (this->deliverySourceId < 0) {
+        close(this->timerDescriptor);
+        throw FailedToCreateEventLoopException("Failed to watch the delivery timer");
+    }
+}
+
+ImpairedLink::~ImpairedLink() {
+    // Once removed, the loop does not deliver anymore, so the timer can be closed
+    this->loop.remove(this->deliverySourceId);
+    close(this->timerDescriptor);
+}
+
+bool ImpairedLink::submit(std::size_t packetSize, std::function<void()> delivery) {
+    std::scoped_lock<std::mutex> lock(this->packetsMutex);
+    auto now = std::chrono::steady_clock::now();
+
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    if (chance(this->randomGenerator) < this->settings.lossProbability || this->scheduledPackets.size() >= MAX_SCHEDULED_PACKETS) return false;
+
+    // A bandwidth limited link first has to send everything that is queued before it, and then this packet itself
+    TimePoint sentTime = now;
+    if (this->settings.bandwidthBytesPerSecond > 0) {
+        auto transmissionTime = std::chrono::nanoseconds(packetSize * 1000000000 / this->settings.bandwidthBytesPerSecond);
+        sentTime = std::max(now, this->linkBusyUntil) + std::chrono::duration_cast<std::chrono::steady_clock::duration>(transmissionTime);
+        this->linkBusyUntil = sentTime;
+    }
+
+    std::chrono::microseconds delay(0);
+    if (chance(this->randomGenerator) >= this->settings.reorderProbability) {
+        std::uniform_int_distribution<int64_t> jitter(-this->settings.jitter.count(), this->settings.jitter.count());
+        delay = std::max(std::chrono::microseconds(0), this->settings.latency + std::chrono::microseconds(jitter(this->randomGenerator)));
+    }
+
+    TimePoint deliveryTime = sentTime + delay;
+    this->scheduledPackets.push({.deliveryTime = deliveryTime, .sequenceNumber = this->nextSequenceNumber++, .delivery = std::move(delivery)});
+    this->armTimer(deliveryTime);
+    return true;
+}
+
+void ImpairedLink::armTimer(TimePoint expiration) {
+    if (this->timerExpiration.has_value() && this->timerExpiration.value() <= expiration) return;
+    this->timerExpiration = expiration;
+
+    // An expiration in the past fires right away, but a zero expiration would disarm the timer
+    auto nanoseconds = std::max<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(expiration.time_since_epoch()).count(), 1);
+    itimerspec specification = {.it_interval = {0, 0}, .it_value = {.tv_sec = nanoseconds / 1000000000, .tv_nsec = nanoseconds % 1000000000}};
+    timerfd_settime(this->timerDescriptor, TFD_TIMER_ABSTIME, &specification, nullptr);
+}
+
+void ImpairedLink::deliverDuePackets() {
+    uint64_t expirations;
+    if (read(this->timerDescriptor, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN) return;
+
+    std::vector<std::function<void()>> duePackets;
+    {
+        std::scoped_lock<std::mutex> lock(this->packetsMutex);
+        auto now = std::chrono::steady_clock::now();
+        while (!this->scheduledPackets.empty() && this->scheduledPackets.top().deliveryTime <= now) {
+            duePackets.push_back(this->scheduledPackets.top().delivery);
+            this->scheduledPackets.pop();
+        }
+
+        this->timerExpiration.reset();
+        if (!this->scheduledPackets.empty()) this->armTimer(this->scheduledPackets.top().deliveryTime);
+    }
+
+    // Do not hold the lock while delivering, so new packets can be submitted meanwhile
+    for (const auto& delivery : duePackets) delivery();
+}
+
+}  // namespace rtt::robothub::simulation
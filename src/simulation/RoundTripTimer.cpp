@@ -0,0 +1,101 @@
+#include <simulation/RoundTripTimer.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace rtt::robothub::simulation {
+
+constexpr std::chrono::milliseconds RESPONSE_TIMEOUT(250);  // After this time, we assume no response will come
+constexpr std::size_t MAX_OUTSTANDING_PACKETS = 1024;        // Bounds the memory if the simulator does not respond at all
+constexpr std::size_t MAX_SAMPLES_PER_INTERVAL = 100000;
+
+RoundTripTimer::RoundTripTimer() = default;
+
+void RoundTripTimer::onPacketSent(rtt::Team color) {
+    auto now = std::chrono::steady_clock::now();
+    std::scoped_lock<std::mutex> lock(this->timesMutex);
+    auto& times = this->getTeamTimes(color);
+
+    this->forgetTimedOutPackets(times, now);
+    if (times.outstandingPackets.size() >= MAX_OUTSTANDING_PACKETS) {
+        times.outstandingPackets.pop_front();
+        times.lostPackets++;
+    }
+    times.outstandingPackets.push_back(now);
+}
+
+void RoundTripTimer::onPacketSendFailed(rtt::Team color) {
+    std::scoped_lock<std::mutex> lock(this->timesMutex);
+    auto& times = this->getTeamTimes(color);
+
+    if (!times.outstandingPackets.empty()) times.outstandingPackets.pop_back();
+}
+
+void RoundTripTimer::onPacketLost(rtt::Team color) {
+    std::scoped_lock<std::mutex> lock(this->timesMutex);
+    auto& times = this->getTeamTimes(color);
+
+    if (times.outstandingPackets.empty()) return;
+    times.outstandingPackets.pop_back();
+    times.lostPackets++;
+}
+
+void RoundTripTimer::onResponseReceived(rtt::Team color) {
+    auto now = std::chrono::steady_clock::now();
+    std::scoped_lock<std::mutex> lock(this->timesMutex);
+    auto& times = this->getTeamTimes(color);
+
+    this->forgetTimedOutPackets(times, now);
+    if (times.outstandingPackets.empty()) return;  // A response we did not ask for
+
+    auto sentAt = times.outstandingPackets.front();
+    times.outstandingPackets.pop_front();
+
+    if (times.roundTripTimesUs.size() < MAX_SAMPLES_PER_INTERVAL) {
+        times.roundTripTimesUs.push_back(std::chrono::duration<double, std::micro>(now - sentAt).count());
+    }
+}
+
+void RoundTripTimer::onResponseLost(rtt::Team color) {
+    std::scoped_lock<std::mutex> lock(this->timesMutex);
+    auto& times = this->getTeamTimes(color);
+
+    if (times.outstandingPackets.empty()) return;
+    times.outstandingPackets.pop_front();
+    times.lostPackets++;
+}
+
+RoundTripStatistics RoundTripTimer::takeStatistics(rtt::Team color) {
+    std::vector<double> samples;
+    RoundTripStatistics statistics;
+    {
+        std::scoped_lock<std::mutex> lock(this->timesMutex);
+        auto& times = this->getTeamTimes(color);
+        samples.swap(times.roundTripTimesUs);
+        statistics.lost = times.lostPackets;
+        times.lostPackets = 0;
+    }
+
+    statistics.samples = static_cast<int>(samples.size());
+    if (samples.empty()) return statistics;
+
+    std::sort(samples.begin(), samples.end());
+    const auto percentile = [&](double p) { return samples[static_cast<std::size_t>(std::ceil(p * static_cast<double>(samples.size()))) - 1]; };
+
+    statistics.minUs = samples.front();
+    statistics.p50Us = percentile(0.50);
+    statistics.p99Us = percentile(0.99);
+    statistics.maxUs = samples.back();
+    return statistics;
+}
+
+RoundTripTimer::TeamTimes& RoundTripTimer::getTeamTimes(rtt::Team color) { return color == rtt::Team::YELLOW ? this->yellowTimes : this->blueTimes; }
+
+void RoundTripTimer::forgetTimedOutPackets(TeamTimes& times, std::chrono::time_point<std::chrono::steady_clock> now) {
+    while (!times.outstandingPackets.empty() && now - times.outstandingPackets.front() > RESPONSE_TIMEOUT) {
+        times.outstandingPackets.pop_front();
+        times.lostPackets++;
+    }
+}
+
+}  // namespace rtt::robothub::simulation
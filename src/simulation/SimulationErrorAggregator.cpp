@@ -0,0 +1,78 @@
+#include <simulation/SimulationErrorAggregator.hpp>
+
+namespace rtt::robothub::simulation {
+
+SimulationErrorAggregator::SimulationErrorAggregator(std::chrono::milliseconds reportInterval, const std::function<void(const std::string&)>& report)
+    : reportInterval(reportInterval), report(report) {}
+
+SimulationErrorAggregator::~SimulationErrorAggregator() {
+    std::scoped_lock<std::mutex> lock(this->countersMutex);
+
+    auto now = std::chrono::steady_clock::now();
+    for (auto& [key, counter] : this->counters) {
+        this->reportPendingOccurrences(counter, now);
+    }
+}
+
+void SimulationErrorAggregator::addError(const SimulationError& error) {
+    std::scoped_lock<std::mutex> lock(this->countersMutex);
+
+    auto now = std::chrono::steady_clock::now();
+    auto [iterator, isNewError] = this->counters.try_emplace({error.code, error.message});
+    ErrorCounter& counter = iterator->second;
+
+    counter.occurrencesSinceReport++;
+    counter.lastOccurrence = now;
+
+    // Report new errors immediately, and known errors only if the interval has passed
+    if (isNewError) {
+        counter.description = errorToString(error);
+        counter.lastReport = now;
+        counter.occurrencesSinceReport = 0;
+        this->report(counter.description);
+    } else if (now - counter.lastReport >= this->reportInterval) {
+        this->reportPendingOccurrences(counter, now);
+    }
+}
+
+void SimulationErrorAggregator::evictQuietErrors() {
+    std::scoped_lock<std::mutex> lock(this->countersMutex);
+
+    auto now = std::chrono::steady_clock::now();
+    for (auto iterator = this->counters.begin(); iterator != this->counters.end();) {
+        if (now - iterator->second.lastOccurrence < this->reportInterval) {
+            ++iterator;
+            continue;
+        }
+        this->reportPendingOccurrences(iterator->second, now);
+        iterator = this->counters.erase(iterator);
+    }
+}
+
+std::size_t SimulationErrorAggregator::getDistinctErrors() const {
+    std::scoped_lock<std::mutex> lock(this->countersMutex);
+    return this->counters.size();
+}
+
+void SimulationErrorAggregator::reportPendingOccurrences(ErrorCounter& counter, std::chrono::time_point<std::chrono::steady_clock> now) {
+    if (counter.occurrencesSinceReport == 0) return;
+
+    auto secondsSinceReport = std::chrono::duration_cast<std::chrono::seconds>(now - counter.lastReport).count();
+    this->report(counter.description + " (" + std::to_string(counter.occurrencesSinceReport) + " times in the last " + std::to_string(secondsSinceReport) + "s)");
+
+    counter.occurrencesSinceReport = 0;
+    counter.lastReport = now;
+}
+
+std::string SimulationErrorAggregator::errorToString(const SimulationError& error) {
+    if (error.code.has_value() && error.message.has_value())
+        return "Received Simulation error " + error.code.value() + ": " + error.message.value();
+    else if (error.code.has_value())
+        return "Received Simulation error with code: " + error.code.value();
+    else if (error.message.has_value())
+        return "Received Simulation error: " + error.message.value();
+    else
+        return "Received unknown Simulation error";
+}
+
+}  // namespace rtt::robothub::simulation
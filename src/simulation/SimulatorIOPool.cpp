@@ -0,0 +1,59 @@
+#include <simulation/SimulatorIOPool.hpp>
+#include <sys/epoll.h>
+
+#include <algorithm>
+
+namespace rtt::robothub::simulation {
+
+SimulatorIOPool::SimulatorIOPool(int amountOfThreads) : nextTaskId(0) {
+    int threads = std::max(1, amountOfThreads);
+    for (int i = 0; i < threads; ++i) {
+        this->loops.push_back(std::make_unique<EventLoop>("robothub-sim-" + std::to_string(i), ThreadRole::SIMULATOR));
+    }
+}
+
+int SimulatorIOPool::addSocketTask(int socketDescriptor, const std::function<void()>& task) {
+    std::scoped_lock<std::mutex> lock(this->tasksMutex);
+    auto& loop = this->getLeastBusyLoop();
+    return this->rememberTask(loop, loop.addFileDescriptor(socketDescriptor, EPOLLIN, task));
+}
+
+int SimulatorIOPool::addSocketTask(EventLoop& loop, int socketDescriptor, const std::function<void()>& task) {
+    std::scoped_lock<std::mutex> lock(this->tasksMutex);
+    return this->rememberTask(loop, loop.addFileDescriptor(socketDescriptor, EPOLLIN, task));
+}
+
+int SimulatorIOPool::addTimerTask(std::chrono::nanoseconds interval, const std::function<void()>& task) {
+    std::scoped_lock<std::mutex> lock(this->tasksMutex);
+    auto& loop = this->getLeastBusyLoop();
+    return this->rememberTask(loop, loop.addTimer(interval, task));
+}
+
+void SimulatorIOPool::removeTask(int taskId) {
+    TaskLocation location = {};
+    {
+        std::scoped_lock<std::mutex> lock(this->tasksMutex);
+        auto iterator = this->tasks.find(taskId);
+        if (iterator == this->tasks.end()) return;
+        location = iterator->second;
+        this->tasks.erase(iterator);
+    }
+
+    // The loop waits for the task to finish if it is running
+    location.loop->remove(location.sourceId);
+}
+
+int SimulatorIOPool::getAmountOfThreads() const { return static_cast<int>(this->loops.size()); }
+
+EventLoop& SimulatorIOPool::getLeastBusyLoop() {
+    auto leastBusyLoop = std::min_element(this->loops.begin(), this->loops.end(), [](const auto& a, const auto& b) { return a->getAmountOfSources() < b->getAmountOfSources(); });
+    return **leastBusyLoop;
+}
+
+int SimulatorIOPool::rememberTask(EventLoop& loop, int sourceId) {
+    int taskId = this->nextTaskId++;
+    this->tasks[taskId] = {.loop = &loop, .sourceId = sourceId};
+    return taskId;
+}
+
+}  // namespace rtt::robothub::simulation
@@ -4,10 +4,12 @@
 
 namespace rtt::robothub::simulation {
 
-constexpr int LISTEN_THREAD_COOLDOWN_MS = 10;  // Small cooldown in thread between checking for new messsages
+constexpr int DEFAULT_AMOUNT_OF_LISTEN_THREADS = 1;  // The sockets are only read when they have data, so one thread keeps up
+constexpr std::chrono::seconds SIMULATOR_SILENCE_TIMEOUT(1);  // A simulator that was silent for this long may have restarted
 
-SimulatorManager::SimulatorManager(SimulatorNetworkConfiguration config) {
+SimulatorManager::SimulatorManager(SimulatorNetworkConfiguration config, std::shared_ptr<SimulatorIOPool> pool) {
     this->networkConfiguration = config;
+    this->ioPool = pool != nullptr ? pool : std::make_shared<SimulatorIOPool>(DEFAULT_AMOUNT_OF_LISTEN_THREADS);
 
     // Bind sockets so we receive feedback
     if (!this->blueControlSocket.bind(QHostAddress::AnyIPv4, config.blueFeedbackPort, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint))
@@ -17,8 +19,6 @@ SimulatorManager::SimulatorManager(SimulatorNetworkConfiguration config) {
     if (!this->configurationSocket.bind(QHostAddress::AnyIPv4, config.configurationFeedbackPort, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint))
         throw FailedToBindPortException("Failed to bind to control feedback port(" + std::to_string(config.configurationFeedbackPort) + "). Is it bound by another program?");
 
-    this->shouldStopListeningToFeedback = false;
-
     RTT_INFO(
         "\n"
         "SimulationManager bound on:",
@@ -26,24 +26,52 @@ SimulatorManager::SimulatorManager(SimulatorNetworkConfiguration config) {
         " - Yellow Control Port: ", config.yellowControlPort, "\n", " - Yellow Feedback Port: ", config.yellowFeedbackPort, "\n",
         " - Simulation Control Port: ", config.configurationPort, "\n", " - Simulation Feedback Port: ", config.configurationFeedbackPort)
 
-    // Spawn listening threads that handle incoming feedback
-    this->blueFeedbackListenThread = std::thread([this] { listenForRobotControlFeedback(rtt::Team::BLUE); });
-    this->yellowFeedbackListenThread = std::thread([this] { listenForRobotControlFeedback(rtt::Team::YELLOW); });
-    this->configurationFeedbackListenThread = std::thread([this] { listenForConfigurationFeedback(); });
+    // Impaired packets are delivered on the loop that reads the socket of their team, instead of on threads of their own
+    EventLoop* blueLoop = nullptr;
+    EventLoop* yellowLoop = nullptr;
+    if (config.linkImpairment.has_value()) {
+        const auto& impairment = config.linkImpairment.value();
+        blueLoop = &this->ioPool->getLeastBusyLoop();
+        this->blueCommandLink = std::make_unique<ImpairedLink>(impairment.blue, impairment.seed, *blueLoop);
+        this->blueFeedbackLink = std::make_unique<ImpairedLink>(impairment.blue, impairment.seed + 2, *blueLoop);
+        yellowLoop = &this->ioPool->getLeastBusyLoop();
+        this->yellowCommandLink = std::make_unique<ImpairedLink>(impairment.yellow, impairment.seed + 1, *yellowLoop);
+        this->yellowFeedbackLink = std::make_unique<ImpairedLink>(impairment.yellow, impairment.seed + 3, *yellowLoop);
+        RTT_WARNING("SimulationManager impairs the link with the simulator (seed ", impairment.seed, ")")
+    }
+
+    // Add listening tasks that handle incoming feedback
+    auto blueSocket = static_cast<int>(this->blueControlSocket.socketDescriptor());
+    auto listenToBlue = [this] { this->listenForRobotControlFeedback(rtt::Team::BLUE); };
+    this->feedbackListenTasks.push_back(blueLoop != nullptr ? this->ioPool->addSocketTask(*blueLoop, blueSocket, listenToBlue) : this->ioPool->addSocketTask(blueSocket, listenToBlue));
+    auto yellowSocket = static_cast<int>(this->yellowControlSocket.socketDescriptor());
+    auto listenToYellow = [this] { this->listenForRobotControlFeedback(rtt::Team::YELLOW); };
+    this->feedbackListenTasks.push_back(yellowLoop != nullptr ? this->ioPool->addSocketTask(*yellowLoop, yellowSocket, listenToYellow)
+                                                              : this->ioPool->addSocketTask(yellowSocket, listenToYellow));
+    this->feedbackListenTasks.push_back(
+        this->ioPool->addSocketTask(static_cast<int>(this->configurationSocket.socketDescriptor()), [this] { this->listenForConfigurationFeedback(); }));
 }
 
-SimulatorManager::~SimulatorManager() { this->stopFeedbackListeningThreads(); }
+SimulatorManager::~SimulatorManager() {
+    this->stopFeedbackListeningTasks();
+
+    // The links deliver packets using our sockets and callbacks, so stop them first
+    this->blueCommandLink = nullptr;
+    this->yellowCommandLink = nullptr;
+    this->blueFeedbackLink = nullptr;
+    this->yellowFeedbackLink = nullptr;
+}
 
 std::size_t SimulatorManager::sendRobotControlCommand(RobotControlCommand& robotControlCommand, rtt::Team color) {
     std::size_t bytesSent;
 
     switch (color) {
         case rtt::Team::YELLOW: {
-            bytesSent = this->sendPacket(robotControlCommand.getPacket(), this->yellowControlSocket, this->networkConfiguration.yellowControlPort);
+            bytesSent = this->sendRobotControlPacket(robotControlCommand.getPacket(), this->yellowControlSocket, this->networkConfiguration.yellowControlPort, color);
             break;
         }
         case rtt::Team::BLUE: {
-            bytesSent = this->sendPacket(robotControlCommand.getPacket(), this->blueControlSocket, this->networkConfiguration.blueControlPort);
+            bytesSent = this->sendRobotControlPacket(robotControlCommand.getPacket(), this->blueControlSocket, this->networkConfiguration.blueControlPort, color);
             break;
         }
         default: {
@@ -61,12 +89,43 @@ std::size_t SimulatorManager::sendConfigurationCommand(ConfigurationCommand& con
 
 void SimulatorManager::setRobotControlFeedbackCallback(std::function<void(RobotControlFeedback&)> callback) { this->robotControlFeedbackCallback = callback; }
 void SimulatorManager::setConfigurationFeedbackCallback(std::function<void(ConfigurationFeedback&)> callback) { this->configurationFeedbackCallback = callback; }
+void SimulatorManager::setLinkEstablishedCallback(std::function<void()> callback) { this->linkEstablishedCallback = callback; }
+
+RoundTripStatistics SimulatorManager::takeRoundTripStatistics(rtt::Team color) { return this->roundTripTimer.takeStatistics(color); }
+
+std::size_t SimulatorManager::sendRobotControlPacket(google::protobuf::Message& packet, QUdpSocket& socket, int port, rtt::Team color) {
+    ImpairedLink* commandLink = color == rtt::Team::YELLOW ? this->yellowCommandLink.get() : this->blueCommandLink.get();
+
+    // Mark the packet before sending, as its response could otherwise arrive before we know about the packet
+    this->roundTripTimer.onPacketSent(color);
+
+    if (commandLink == nullptr) {
+        auto bytesSent = this->sendPacket(packet, socket, port);
+        if (bytesSent == 0) this->roundTripTimer.onPacketSendFailed(color);
+        return bytesSent;
+    }
+
+    QByteArray datagram = serializePacket(packet);
+    bool isDelivered = commandLink->submit(datagram.size(), [this, datagram, &socket, port] { this->sendDatagram(datagram, socket, port); });
+
+    // Like with our radio, we do not notice that the packet got lost, so we still report the bytes as sent
+    if (!isDelivered) this->roundTripTimer.onPacketLost(color);
+    return static_cast<std::size_t>(datagram.size());
+}
 
 std::size_t SimulatorManager::sendPacket(google::protobuf::Message& packet, QUdpSocket& socket, int port) {
+    return this->sendDatagram(serializePacket(packet), socket, port);
+}
+
+QByteArray SimulatorManager::serializePacket(google::protobuf::Message& packet) {
     // Create a byteArray where the packet can be serialized into
     QByteArray datagram;
     datagram.resize(packet.ByteSizeLong());
     packet.SerializeToArray(datagram.data(), datagram.size());
+    return datagram;
+}
+
+std::size_t SimulatorManager::sendDatagram(const QByteArray& datagram, QUdpSocket& socket, int port) {
     // Send contents of byteArray to simulator
     auto bytesSent = socket.writeDatagram(datagram, this->networkConfiguration.simIpAddress, port);
 
@@ -84,38 +143,60 @@ void SimulatorManager::callRobotControlFeedbackCallback(RobotControlFeedback& fe
     if (this->robotControlFeedbackCallback != nullptr) this->robotControlFeedbackCallback(feedback);
 }
 
+void SimulatorManager::onDatagramReceived() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+    auto previous = this->lastReceiveTicks.exchange(now);
+
+    bool wasSilent = previous == 0 || std::chrono::steady_clock::duration(now - previous) >= SIMULATOR_SILENCE_TIMEOUT;
+    if (wasSilent && this->linkEstablishedCallback != nullptr) this->linkEstablishedCallback();
+}
+
 void SimulatorManager::callConfigurationFeedbackCallback(ConfigurationFeedback& feedback) {
     // Only call if the callback function has been set
     if (this->configurationFeedbackCallback != nullptr) this->configurationFeedbackCallback(feedback);
 }
 
-void SimulatorManager::listenForRobotControlFeedback(rtt::Team color) {
+bool SimulatorManager::listenForRobotControlFeedback(rtt::Team color) {
     // Select the socket that is used by the team
     QUdpSocket& teamSocket = (color == rtt::Team::YELLOW) ? this->yellowControlSocket : this->blueControlSocket;
 
-    while (!this->shouldStopListeningToFeedback) {
-        while (teamSocket.hasPendingDatagrams()) {
-            QNetworkDatagram datagram = teamSocket.receiveDatagram();
-            if (datagram.isValid()) {
-                RobotControlFeedback f = this->getControlFeedbackFromDatagram(datagram, color);
-                this->callRobotControlFeedbackCallback(f);
-            }
+    ImpairedLink* feedbackLink = (color == rtt::Team::YELLOW) ? this->yellowFeedbackLink.get() : this->blueFeedbackLink.get();
+
+    bool receivedFeedback = false;
+    while (teamSocket.hasPendingDatagrams()) {
+        QNetworkDatagram datagram = teamSocket.receiveDatagram();
+        if (!datagram.isValid()) continue;
+        receivedFeedback = true;
+        this->onDatagramReceived();
+
+        if (feedbackLink == nullptr) {
+            this->handleRobotControlDatagram(datagram, color);
+        } else {
+            bool isDelivered = feedbackLink->submit(datagram.data().size(), [this, datagram, color]() mutable { this->handleRobotControlDatagram(datagram, color); });
+            if (!isDelivered) this->roundTripTimer.onResponseLost(color);
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(LISTEN_THREAD_COOLDOWN_MS));
     }
+    return receivedFeedback;
 }
 
-void SimulatorManager::listenForConfigurationFeedback() {
-    while (!this->shouldStopListeningToFeedback) {
-        while (this->configurationSocket.hasPendingDatagrams()) {
-            QNetworkDatagram datagram = this->configurationSocket.receiveDatagram();
-            if (datagram.isValid()) {
-                ConfigurationFeedback f = this->getConfigurationFeedbackFromDatagram(datagram);
-                this->callConfigurationFeedbackCallback(f);
-            }
+void SimulatorManager::handleRobotControlDatagram(QNetworkDatagram& datagram, rtt::Team color) {
+    this->roundTripTimer.onResponseReceived(color);
+    RobotControlFeedback f = this->getControlFeedbackFromDatagram(datagram, color);
+    this->callRobotControlFeedbackCallback(f);
+}
+
+bool SimulatorManager::listenForConfigurationFeedback() {
+    bool receivedFeedback = false;
+    while (this->configurationSocket.hasPendingDatagrams()) {
+        QNetworkDatagram datagram = this->configurationSocket.receiveDatagram();
+        if (datagram.isValid()) {
+            this->onDatagramReceived();
+            ConfigurationFeedback f = this->getConfigurationFeedbackFromDatagram(datagram);
+            this->callConfigurationFeedbackCallback(f);
+            receivedFeedback = true;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(LISTEN_THREAD_COOLDOWN_MS));
     }
+    return receivedFeedback;
 }
 
 RobotControlFeedback SimulatorManager::getControlFeedbackFromDatagram(QNetworkDatagram& datagram, rtt::Team color) {
@@ -159,16 +240,11 @@ ConfigurationFeedback SimulatorManager::getConfigurationFeedbackFromDatagram(QNe
     return feedback;
 }
 
-void SimulatorManager::stopFeedbackListeningThreads() {
-    this->shouldStopListeningToFeedback = true;
-
-    if (this->blueFeedbackListenThread.joinable()) this->blueFeedbackListenThread.join();
-
-    if (this->yellowFeedbackListenThread.joinable()) this->yellowFeedbackListenThread.join();
-
-    if (this->configurationFeedbackListenThread.joinable()) this->configurationFeedbackListenThread.join();
-
-    this->shouldStopListeningToFeedback = false;
+void SimulatorManager::stopFeedbackListeningTasks() {
+    for (int taskId : this->feedbackListenTasks) {
+        this->ioPool->removeTask(taskId);
+    }
+    this->feedbackListenTasks.clear();
 }
 
 FailedToBindPortException::FailedToBindPortException(const std::string message) { this->message = message; }
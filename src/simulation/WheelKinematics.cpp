@@ -0,0 +1,86 @@
+#include <simulation/WheelKinematics.hpp>
+
+#include <cmath>
+
+namespace rtt::robothub::simulation {
+
+constexpr float DEGREES_TO_RADIANS = static_cast<float>(M_PI / 180.0);
+
+WheelKinematics::WheelKinematics() {
+    RobotProperties defaultProperties;
+    for (int id = 0; id < MAX_ROBOTS_PER_TEAM; ++id) {
+        this->setRobotProperties(id, rtt::Team::BLUE, defaultProperties);
+        this->setRobotProperties(id, rtt::Team::YELLOW, defaultProperties);
+    }
+}
+
+void WheelKinematics::setRobotProperties(int id, rtt::Team color, const RobotProperties& properties) {
+    if (id < 0 || id >= MAX_ROBOTS_PER_TEAM) return;
+
+    std::scoped_lock<std::mutex> lock(this->geometryMutex);
+    TeamGeometry& geometry = color == rtt::Team::YELLOW ? this->yellowGeometry : this->blueGeometry;
+
+    // The angles of RobotProperties are the positions of the wheels in degrees, counter-clockwise from the dribbler. These
+    // are not the clockwise radians of the RobotWheelAngles in the simulator protocol, so only convert the unit here
+    geometry.frontRightSin[id] = std::sin(properties.frontRightWheelAngle * DEGREES_TO_RADIANS);
+    geometry.frontRightCos[id] = std::cos(properties.frontRightWheelAngle * DEGREES_TO_RADIANS);
+    geometry.backRightSin[id] = std::sin(properties.backRightWheelAngle * DEGREES_TO_RADIANS);
+    geometry.backRightCos[id] = std::cos(properties.backRightWheelAngle * DEGREES_TO_RADIANS);
+    geometry.backLeftSin[id] = std::sin(properties.backLeftWheelAngle * DEGREES_TO_RADIANS);
+    geometry.backLeftCos[id] = std::cos(properties.backLeftWheelAngle * DEGREES_TO_RADIANS);
+    geometry.frontLeftSin[id] = std::sin(properties.frontLeftWheelAngle * DEGREES_TO_RADIANS);
+    geometry.frontLeftCos[id] = std::cos(properties.frontLeftWheelAngle * DEGREES_TO_RADIANS);
+    geometry.wheelDistance[id] = properties.radius;
+}
+
+void WheelKinematics::computeWheelVelocities(rtt::Team color, const TeamVelocities& velocities, TeamWheelVelocities& wheelVelocities) const {
+    // The loops below always cover all slots, so the compiler can fully vectorize them. Unused slots are zero
+    TeamGeometry batch = {};
+    alignas(32) std::array<float, MAX_ROBOTS_PER_TEAM> orientationSin = {};
+    alignas(32) std::array<float, MAX_ROBOTS_PER_TEAM> orientationCos = {};
+    alignas(32) std::array<float, MAX_ROBOTS_PER_TEAM> forwardVelocity = {};
+    alignas(32) std::array<float, MAX_ROBOTS_PER_TEAM> leftVelocity = {};
+
+    // Gather the geometry of the robots in the batch, so it lines up with their velocities
+    {
+        std::scoped_lock<std::mutex> lock(this->geometryMutex);
+        const TeamGeometry& geometry = color == rtt::Team::YELLOW ? this->yellowGeometry : this->blueGeometry;
+
+        for (int i = 0; i < velocities.amount; ++i) {
+            int id = velocities.robotId[i];
+            batch.frontRightSin[i] = geometry.frontRightSin[id];
+            batch.frontRightCos[i] = geometry.frontRightCos[id];
+            batch.backRightSin[i] = geometry.backRightSin[id];
+            batch.backRightCos[i] = geometry.backRightCos[id];
+            batch.backLeftSin[i] = geometry.backLeftSin[id];
+            batch.backLeftCos[i] = geometry.backLeftCos[id];
+            batch.frontLeftSin[i] = geometry.frontLeftSin[id];
+            batch.frontLeftCos[i] = geometry.frontLeftCos[id];
+            batch.wheelDistance[i] = geometry.wheelDistance[id];
+        }
+    }
+
+    for (int i = 0; i < velocities.amount; ++i) {
+        orientationSin[i] = std::sin(velocities.orientation[i]);
+        orientationCos[i] = std::cos(velocities.orientation[i]);
+    }
+
+    // Rotate the global velocities into the robot frame
+    for (int i = 0; i < MAX_ROBOTS_PER_TEAM; ++i) {
+        forwardVelocity[i] = orientationCos[i] * velocities.xVelocity[i] + orientationSin[i] * velocities.yVelocity[i];
+        leftVelocity[i] = orientationCos[i] * velocities.yVelocity[i] - orientationSin[i] * velocities.xVelocity[i];
+    }
+
+    // A wheel at angle a drives in direction (-sin a, cos a), and rotation adds the wheel distance times the angular velocity.
+    // So a positive wheel velocity turns the robot counter-clockwise, like a positive angular velocity does
+    for (int i = 0; i < MAX_ROBOTS_PER_TEAM; ++i) {
+        float rotation = batch.wheelDistance[i] * velocities.angularVelocity[i];
+        wheelVelocities.frontRight[i] = batch.frontRightCos[i] * leftVelocity[i] - batch.frontRightSin[i] * forwardVelocity[i] + rotation;
+        wheelVelocities.backRight[i] = batch.backRightCos[i] * leftVelocity[i] - batch.backRightSin[i] * forwardVelocity[i] + rotation;
+        wheelVelocities.backLeft[i] = batch.backLeftCos[i] * leftVelocity[i] - batch.backLeftSin[i] * forwardVelocity[i] + rotation;
+        wheelVelocities.frontLeft[i] = batch.frontLeftCos[i] * leftVelocity[i] - batch.frontLeftSin[i] * forwardVelocity[i] + rotation;
+    }
+    wheelVelocities.amount = velocities.amount;
+}
+
+}  // namespace rtt::robothub::simulation
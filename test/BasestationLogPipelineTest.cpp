@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <basestation/BasestationLogPipeline.hpp>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace rtt::robothub::basestation;
+
+namespace {
+
+typedef struct HandledLog {
+    std::string log;
+    BasestationIdentifier basestation;
+    std::optional<rtt::Team> team;
+} HandledLog;
+
+// Collects the logs the pipeline hands over, which happens on its writer thread
+class LogCollector {
+   public:
+    std::function<void(const std::string&, const BasestationIdentifier&, std::optional<rtt::Team>)> getHandler() {
+        return [this](const std::string& log, const BasestationIdentifier& basestation, std::optional<rtt::Team> team) {
+            std::scoped_lock<std::mutex> lock(this->logsMutex);
+            this->logs.push_back({log, basestation, team});
+        };
+    }
+
+    std::vector<HandledLog> getLogs() {
+        std::scoped_lock<std::mutex> lock(this->logsMutex);
+        return this->logs;
+    }
+
+   private:
+    std::mutex logsMutex;
+    std::vector<HandledLog> logs;
+};
+
+bool pushText(BasestationLogPipeline& pipeline, const BasestationIdentifier& basestation, std::optional<rtt::Team> team, const std::string& text) {
+    return pipeline.push(basestation, team, std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(text.data()), text.size()));
+}
+
+}  // namespace
+
+TEST(BasestationLogPipelineTest, handsLogsToTheHandlerWithoutTheirNewline) {
+    LogCollector collector;
+    {
+        BasestationLogPipeline pipeline(collector.getHandler());
+        EXPECT_TRUE(pushText(pipeline, {.usbAddress = 4, .serialIdentifier = 7}, rtt::Team::BLUE, "Battery low\r\n"));
+        EXPECT_TRUE(pushText(pipeline, {.usbAddress = 5, .serialIdentifier = 8}, std::nullopt, "Booted\n"));
+    }
+
+    auto logs = collector.getLogs();
+    ASSERT_EQ(logs.size(), 2);
+    EXPECT_EQ(logs[0].log, "Battery low");
+    EXPECT_EQ(logs[0].basestation.usbAddress, 4);
+    EXPECT_EQ(logs[0].basestation.serialIdentifier, 7);
+    EXPECT_EQ(logs[0].team, rtt::Team::BLUE);
+    EXPECT_EQ(logs[1].log, "Booted");
+    EXPECT_FALSE(logs[1].team.has_value());
+}
+
+TEST(BasestationLogPipelineTest, cutsOffLongLogs) {
+    LogCollector collector;
+    {
+        BasestationLogPipeline pipeline(collector.getHandler());
+        EXPECT_TRUE(pushText(pipeline, {.usbAddress = 1, .serialIdentifier = 1}, rtt::Team::YELLOW, std::string(MAX_BASESTATION_LOG_LENGTH + 100, 'x')));
+    }
+
+    auto logs = collector.getLogs();
+    ASSERT_EQ(logs.size(), 1);
+    EXPECT_EQ(logs[0].log, std::string(MAX_BASESTATION_LOG_LENGTH, 'x'));
+}
+
+TEST(BasestationLogPipelineTest, limitsEveryBasestationBySerialAcrossReplugs) {
+    constexpr int MAX_LOGS_PER_SECOND = 5;
+
+    LogCollector collector;
+    uint64_t droppedLogs;
+    {
+        BasestationLogPipeline pipeline(collector.getHandler(), MAX_LOGS_PER_SECOND);
+        // A basestation that is replugged gets a new usb address every time, but keeps its limit
+        int passed = 0;
+        for (uint8_t usbAddress = 0; usbAddress < 20; ++usbAddress) {
+            for (int i = 0; i < 3; ++i) passed += pushText(pipeline, {.usbAddress = usbAddress, .serialIdentifier = 3}, std::nullopt, "Noisy\n");
+        }
+        EXPECT_EQ(passed, MAX_LOGS_PER_SECOND);
+
+        // Other basestations are not limited by the noisy one
+        EXPECT_TRUE(pushText(pipeline, {.usbAddress = 30, .serialIdentifier = 4}, std::nullopt, "Quiet\n"));
+        droppedLogs = pipeline.getDroppedLogs();
+    }
+
+    EXPECT_EQ(droppedLogs, 20 * 3 - MAX_LOGS_PER_SECOND);
+    EXPECT_EQ(collector.getLogs().size(), MAX_LOGS_PER_SECOND + 1);
+}
+
+TEST(BasestationLogPipelineTest, dropsLogsWhileTheWriterFellBehind) {
+    constexpr std::size_t CAPACITY = 4;
+
+    std::atomic<bool> isHandling = false;
+    std::atomic<bool> mayHandle = false;
+    std::atomic<int> handledLogs = 0;
+    auto handler = [&](const std::string&, const BasestationIdentifier&, std::optional<rtt::Team>) {
+        isHandling = true;
+        while (!mayHandle) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        handledLogs++;
+    };
+
+    uint64_t droppedLogs;
+    {
+        BasestationLogPipeline pipeline(handler, 1000, CAPACITY);
+        BasestationIdentifier basestation = {.usbAddress = 1, .serialIdentifier = 1};
+
+        // Keep the writer busy with the first log, which is out of the ring by then
+        ASSERT_TRUE(pushText(pipeline, basestation, std::nullopt, "First\n"));
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!isHandling && std::chrono::steady_clock::now() < deadline) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ASSERT_TRUE(isHandling);
+
+        for (std::size_t i = 0; i < CAPACITY; ++i) EXPECT_TRUE(pushText(pipeline, basestation, std::nullopt, "Waiting\n"));
+        EXPECT_FALSE(pushText(pipeline, basestation, std::nullopt, "Dropped\n"));
+        droppedLogs = pipeline.getDroppedLogs();
+        mayHandle = true;
+    }
+
+    EXPECT_EQ(droppedLogs, 1);
+    EXPECT_EQ(handledLogs, 1 + CAPACITY);
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <BoundedRing.hpp>
+#include <thread>
+#include <vector>
+
+using namespace rtt::robothub;
+
+TEST(BoundedRingTest, roundsTheCapacityUpToAPowerOfTwo) {
+    EXPECT_EQ(BoundedRing<int>(0).getCapacity(), 2);
+    EXPECT_EQ(BoundedRing<int>(5).getCapacity(), 8);
+    EXPECT_EQ(BoundedRing<int>(64).getCapacity(), 64);
+}
+
+TEST(BoundedRingTest, popsEntriesInTheOrderTheyWerePushed) {
+    BoundedRing<int> ring(4);
+    int popped = -1;
+    EXPECT_FALSE(ring.tryPop([&](const int& entry) { popped = entry; }));
+
+    // Push and pop more than the capacity, so the positions wrap around the ring many times
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(ring.tryPush([&](int& entry) { entry = i; }));
+        ASSERT_TRUE(ring.tryPush([&](int& entry) { entry = -i; }));
+        ASSERT_TRUE(ring.tryPop([&](const int& entry) { popped = entry; }));
+        EXPECT_EQ(popped, i);
+        ASSERT_TRUE(ring.tryPop([&](const int& entry) { popped = entry; }));
+        EXPECT_EQ(popped, -i);
+    }
+    EXPECT_FALSE(ring.tryPop([&](const int& entry) { popped = entry; }));
+}
+
+TEST(BoundedRingTest, refusesPushesWhileFull) {
+    BoundedRing<int> ring(4);
+    for (int i = 0; i < 4; ++i) ASSERT_TRUE(ring.tryPush([&](int& entry) { entry = i; }));
+
+    bool isFilled = false;
+    EXPECT_FALSE(ring.tryPush([&](int&) { isFilled = true; }));
+    EXPECT_FALSE(isFilled) << "A push to a full ring must not touch an entry";
+
+    // Popping frees a slot for the next push
+    int popped = -1;
+    ASSERT_TRUE(ring.tryPop([&](const int& entry) { popped = entry; }));
+    EXPECT_EQ(popped, 0);
+    EXPECT_TRUE(ring.tryPush([&](int& entry) { entry = 4; }));
+    EXPECT_FALSE(ring.tryPush([&](int& entry) { entry = 5; }));
+}
+
+TEST(BoundedRingTest, deliversEveryEntryOfManyProducersOnceAndInOrder) {
+    constexpr int PRODUCERS = 8;
+    constexpr int ENTRIES_PER_PRODUCER = 100000;
+
+    typedef struct Entry {
+        int producer;
+        int index;
+    } Entry;
+    // A small ring, so producers often find it full and contend on the same slots
+    BoundedRing<Entry> ring(16);
+
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < PRODUCERS; ++producer) {
+        producers.emplace_back([&, producer] {
+            for (int i = 0; i < ENTRIES_PER_PRODUCER; ++i) {
+                while (!ring.tryPush([&](Entry& entry) { entry = {producer, i}; })) std::this_thread::yield();
+            }
+        });
+    }
+
+    // The entries of one producer are claimed in order, so they must arrive in order
+    std::vector<int> nextIndex(PRODUCERS, 0);
+    int popped = 0;
+    while (popped < PRODUCERS * ENTRIES_PER_PRODUCER) {
+        Entry entry{};
+        if (!ring.tryPop([&](const Entry& filled) { entry = filled; })) {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_GE(entry.producer, 0);
+        ASSERT_LT(entry.producer, PRODUCERS);
+        ASSERT_EQ(entry.index, nextIndex[entry.producer]) << "Entry of producer " << entry.producer << " was lost, duplicated or reordered";
+        nextIndex[entry.producer]++;
+        popped++;
+    }
+    for (auto& producer : producers) producer.join();
+
+    EXPECT_FALSE(ring.tryPop([](const Entry&) {}));
+}
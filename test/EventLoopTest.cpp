@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <EventLoop.hpp>
+#include <atomic>
+#include <thread>
+
+using namespace rtt::robothub;
+
+namespace {
+
+// Returns whether the condition became true before the timeout, as the loop runs handlers on its own thread
+template <typename Condition>
+bool waitUntil(Condition condition, std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST(EventLoopTest, runsTimersUntilTheyAreRemoved) {
+    EventLoop loop("test");
+    std::atomic<int> runs = 0;
+    int timer = loop.addTimer(std::chrono::milliseconds(2), [&] { runs++; });
+
+    ASSERT_TRUE(waitUntil([&] { return runs >= 3; }));
+    loop.remove(timer);
+    int runsAtRemoval = runs;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(runs, runsAtRemoval);
+    EXPECT_EQ(loop.getAmountOfSources(), 0);
+}
+
+TEST(EventLoopTest, runsTimeoutsOnceAndForgetsThem) {
+    EventLoop loop("test");
+    std::atomic<int> runs = 0;
+    int timeout = loop.addTimeout(std::chrono::milliseconds(5), [&] { runs++; });
+
+    ASSERT_TRUE(waitUntil([&] { return runs == 1; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(runs, 1);
+    ASSERT_TRUE(waitUntil([&] { return loop.getAmountOfSources() == 0; }));
+
+    // Removing a timeout that ran is allowed
+    loop.remove(timeout);
+}
+
+TEST(EventLoopTest, doesNotRunTimeoutsThatAreRemovedBeforeTheyExpire) {
+    EventLoop loop("test");
+    std::atomic<int> runs = 0;
+    int timeout = loop.addTimeout(std::chrono::milliseconds(20), [&] { runs++; });
+    loop.remove(timeout);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(runs, 0);
+}
+
+TEST(EventLoopTest, ignoresIdsOfUnknownSources) {
+    EventLoop loop("test");
+    loop.remove(-1);
+    loop.remove(12345);
+    loop.removeWithoutWaiting(-1);
+    loop.removeWithoutWaiting(12345);
+    EXPECT_EQ(loop.getAmountOfSources(), 0);
+}
+
+TEST(EventLoopTest, runsFileDescriptorHandlersWhenTheyAreReady) {
+    EventLoop loop("test");
+    int event = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ASSERT_GE(event, 0);
+
+    std::atomic<uint64_t> received = 0;
+    std::atomic<bool> ranInLoopThread = true;
+    int source = loop.addFileDescriptor(event, EPOLLIN, [&] {
+        ranInLoopThread = ranInLoopThread && loop.isInLoopThread();
+        uint64_t value;
+        while (read(event, &value, sizeof(value)) == sizeof(value)) received += value;
+    });
+
+    for (uint64_t value = 1; value <= 3; ++value) {
+        ASSERT_EQ(write(event, &value, sizeof(value)), sizeof(value));
+        ASSERT_TRUE(waitUntil([&] { return received == value * (value + 1) / 2; })) << "Write " << value << " was not handled";
+    }
+    EXPECT_TRUE(ranInLoopThread);
+    EXPECT_FALSE(loop.isInLoopThread());
+
+    loop.remove(source);
+    close(event);
+}
+
+TEST(EventLoopTest, removeWaitsUntilTheHandlerIsDone) {
+    EventLoop loop("test");
+    std::atomic<bool> isRunning = false;
+    std::atomic<int> runs = 0;
+    int timer = loop.addTimer(std::chrono::milliseconds(1), [&] {
+        isRunning = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        runs++;
+        isRunning = false;
+    });
+
+    ASSERT_TRUE(waitUntil([&] { return isRunning.load(); }));
+    loop.remove(timer);
+    EXPECT_FALSE(isRunning);
+
+    int runsAtRemoval = runs;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(runs, runsAtRemoval);
+}
+
+TEST(EventLoopTest, removeWithoutWaitingReturnsWhileTheHandlerRuns) {
+    EventLoop loop("test");
+    std::atomic<bool> isRunning = false;
+    std::atomic<bool> mayFinish = false;
+    std::atomic<int> runs = 0;
+    int timer = loop.addTimer(std::chrono::milliseconds(1), [&] {
+        isRunning = true;
+        while (!mayFinish) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        runs++;
+        isRunning = false;
+    });
+
+    ASSERT_TRUE(waitUntil([&] { return isRunning.load(); }));
+    // Would never return if it waited for the handler
+    loop.removeWithoutWaiting(timer);
+    EXPECT_TRUE(isRunning);
+    EXPECT_EQ(loop.getAmountOfSources(), 0);
+
+    mayFinish = true;
+    ASSERT_TRUE(waitUntil([&] { return !isRunning; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(runs, 1);
+}
+
+TEST(EventLoopTest, handlersCanRemoveTheirOwnSource) {
+    EventLoop loop("test");
+    std::atomic<int> runs = 0;
+    std::atomic<int> timer = -1;
+    timer = loop.addTimer(std::chrono::milliseconds(1), [&] {
+        runs++;
+        loop.remove(timer);
+    });
+
+    ASSERT_TRUE(waitUntil([&] { return runs >= 1; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(runs, 1);
+    EXPECT_EQ(loop.getAmountOfSources(), 0);
+}
+
+TEST(EventLoopTest, destructionWaitsForTheRunningHandler) {
+    std::atomic<bool> isRunning = false;
+    std::atomic<bool> isDone = false;
+    {
+        EventLoop loop("test");
+        loop.addTimeout(std::chrono::milliseconds(1), [&] {
+            isRunning = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(30));
+            isDone = true;
+        });
+        ASSERT_TRUE(waitUntil([&] { return isRunning.load(); }));
+    }
+    EXPECT_TRUE(isDone);
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <HubCapture.hpp>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using namespace rtt::robothub;
+
+namespace {
+
+// Every test captures into its own directory, so tests can run in parallel
+class HubCaptureTest : public ::testing::Test {
+   protected:
+    std::filesystem::path directory;
+    std::string path;
+
+    void SetUp() override {
+        std::string pattern = (std::filesystem::temp_directory_path() / "hub_capture_test_XXXXXX").string();
+        ASSERT_NE(mkdtemp(pattern.data()), nullptr);
+        this->directory = pattern;
+        this->path = (this->directory / "capture.rhcap").string();
+    }
+
+    void TearDown() override { std::filesystem::remove_all(this->directory); }
+};
+
+rtt::RobotCommands makeCommands(int amount) {
+    rtt::RobotCommands commands;
+    for (int i = 0; i < amount; ++i) {
+        rtt::RobotCommand command;
+        command.id = i;
+        command.velocity = rtt::Vector2(1.5 * i, -0.25 - i);
+        command.targetAngularVelocity = 0.125 * i;
+        command.cameraAngleOfRobot = -0.5 * i;
+        command.kickSpeed = 6.5 - i;
+        command.dribblerSpeed = 0.75;
+        command.useAngularVelocity = i % 2 == 0;
+        command.cameraAngleOfRobotIsSet = i % 2 == 1;
+        command.waitForBall = i % 3 == 0;
+        command.kickType = i % 2 == 0 ? rtt::KickType::CHIP : rtt::KickType::KICK;
+        command.kickAtAngle = i % 3 == 1;
+        command.ignorePacket = i % 3 == 2;
+        commands.push_back(command);
+    }
+    return commands;
+}
+
+void expectSameCommand(const rtt::RobotCommand& actual, const rtt::RobotCommand& expected) {
+    EXPECT_EQ(actual.id, expected.id);
+    EXPECT_EQ(actual.velocity.x, expected.velocity.x);
+    EXPECT_EQ(actual.velocity.y, expected.velocity.y);
+    EXPECT_EQ(actual.targetAngularVelocity, expected.targetAngularVelocity);
+    EXPECT_EQ(actual.cameraAngleOfRobot, expected.cameraAngleOfRobot);
+    EXPECT_EQ(actual.kickSpeed, expected.kickSpeed);
+    EXPECT_EQ(actual.dribblerSpeed, expected.dribblerSpeed);
+    EXPECT_EQ(actual.useAngularVelocity, expected.useAngularVelocity);
+    EXPECT_EQ(actual.cameraAngleOfRobotIsSet, expected.cameraAngleOfRobotIsSet);
+    EXPECT_EQ(actual.waitForBall, expected.waitForBall);
+    EXPECT_EQ(actual.kickType, expected.kickType);
+    EXPECT_EQ(actual.kickAtAngle, expected.kickAtAngle);
+    EXPECT_EQ(actual.ignorePacket, expected.ignorePacket);
+}
+
+}  // namespace
+
+TEST_F(HubCaptureTest, readsBackWhatWasWritten) {
+    auto commands = makeCommands(4);
+    std::vector<uint8_t> packet = {3, 1, 4, 1, 5, 9, 2, 6};
+    proto::Setting settings;
+    settings.set_serialmode(true);
+    {
+        HubCaptureWriter writer(this->path);
+        writer.captureRobotCommands(commands, rtt::Team::BLUE);
+        writer.captureBasestationPacket(packet.data(), packet.size(), rtt::Team::YELLOW);
+        writer.captureSettings(settings);
+        writer.captureRobotCommands({}, rtt::Team::YELLOW);
+    }
+
+    HubCaptureReader reader(this->path);
+    CapturedInput input;
+
+    ASSERT_TRUE(reader.readNext(input));
+    EXPECT_EQ(input.type, CaptureInputType::ROBOT_COMMANDS);
+    EXPECT_EQ(input.team, rtt::Team::BLUE);
+    auto readCommands = deserializeRobotCommands(input.payload);
+    ASSERT_EQ(readCommands.size(), commands.size());
+    for (std::size_t i = 0; i < commands.size(); ++i) expectSameCommand(readCommands[i], commands[i]);
+    auto firstSinceStart = input.sinceStart;
+
+    ASSERT_TRUE(reader.readNext(input));
+    EXPECT_EQ(input.type, CaptureInputType::BASESTATION_PACKET);
+    EXPECT_EQ(input.team, rtt::Team::YELLOW);
+    EXPECT_EQ(std::vector<uint8_t>(input.payload.begin(), input.payload.end()), packet);
+    EXPECT_GE(input.sinceStart, firstSinceStart) << "Inputs should be read in the order they were captured";
+
+    ASSERT_TRUE(reader.readNext(input));
+    EXPECT_EQ(input.type, CaptureInputType::SETTINGS);
+    proto::Setting readSettings;
+    ASSERT_TRUE(readSettings.ParseFromString(input.payload));
+    EXPECT_TRUE(readSettings.serialmode());
+
+    ASSERT_TRUE(reader.readNext(input));
+    EXPECT_EQ(input.type, CaptureInputType::ROBOT_COMMANDS);
+    EXPECT_TRUE(deserializeRobotCommands(input.payload).empty());
+
+    EXPECT_FALSE(reader.readNext(input)) << "The capture should end after the last input";
+}
+
+TEST_F(HubCaptureTest, stopsAtAnInputThatWasCutOff) {
+    auto commands = makeCommands(2);
+    {
+        HubCaptureWriter writer(this->path);
+        writer.captureRobotCommands(commands, rtt::Team::BLUE);
+        writer.captureRobotCommands(commands, rtt::Team::YELLOW);
+    }
+    // Like a capture of a RobotHub that crashed while writing
+    std::filesystem::resize_file(this->path, std::filesystem::file_size(this->path) - 10);
+
+    HubCaptureReader reader(this->path);
+    CapturedInput input;
+    EXPECT_TRUE(reader.readNext(input));
+    EXPECT_FALSE(reader.readNext(input));
+}
+
+TEST_F(HubCaptureTest, refusesFilesThatAreNotACapture) {
+    std::ofstream(this->path) << "this is not a capture, but it is long enough to have a header";
+    EXPECT_THROW(HubCaptureReader reader(this->path), FailedToOpenCaptureException);
+    EXPECT_THROW(HubCaptureReader reader((this->directory / "missing.rhcap").string()), FailedToOpenCaptureException);
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <EventLoop.hpp>
+#include <chrono>
+#include <mutex>
+#include <simulation/ImpairedLink.hpp>
+#include <thread>
+#include <vector>
+
+using namespace rtt::robothub;
+using namespace rtt::robothub::simulation;
+
+namespace {
+constexpr int PACKETS = 200;
+constexpr std::size_t PACKET_SIZE = 64;
+
+// Packets that are not reordered are delayed far longer than submitting all packets takes, so the delivery order
+// only depends on which packets were dropped and which were reordered
+const LinkImpairmentSettings SETTINGS = {.lossProbability = 0.3, .latency = std::chrono::milliseconds(50), .reorderProbability = 0.2};
+
+typedef struct LinkOutcome {
+    std::vector<bool> isDelivered;  // What submit returned for every packet
+    std::vector<int> deliveryOrder;
+} LinkOutcome;
+
+LinkOutcome runLink(uint64_t seed) {
+    EventLoop loop("impaired link");
+    LinkOutcome outcome;
+    std::mutex deliveredMutex;
+    std::vector<int> delivered;
+    int expectedDeliveries = 0;
+    {
+        ImpairedLink link(SETTINGS, seed, loop);
+        for (int i = 0; i < PACKETS; ++i) {
+            bool isDelivered = link.submit(PACKET_SIZE, [&, i] {
+                std::scoped_lock<std::mutex> lock(deliveredMutex);
+                delivered.push_back(i);
+            });
+            outcome.isDelivered.push_back(isDelivered);
+            if (isDelivered) expectedDeliveries++;
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (std::chrono::steady_clock::now() < deadline) {
+            {
+                std::scoped_lock<std::mutex> lock(deliveredMutex);
+                if (static_cast<int>(delivered.size()) == expectedDeliveries) break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    outcome.deliveryOrder = delivered;
+    return outcome;
+}
+}  // namespace
+
+TEST(ImpairedLinkTest, sameSeedGivesTheSameImpairment) {
+    auto first = runLink(42);
+    auto second = runLink(42);
+
+    EXPECT_EQ(first.isDelivered, second.isDelivered) << "The same packets should be dropped";
+    EXPECT_EQ(first.deliveryOrder, second.deliveryOrder) << "The same packets should be reordered";
+}
+
+TEST(ImpairedLinkTest, deliversEveryPacketThatIsNotDropped) {
+    auto outcome = runLink(7);
+
+    int accepted = 0;
+    for (bool isDelivered : outcome.isDelivered) accepted += isDelivered ? 1 : 0;
+    EXPECT_EQ(static_cast<int>(outcome.deliveryOrder.size()), accepted);
+
+    // With these probabilities, dropping none or all of the packets means the settings were ignored
+    EXPECT_GT(accepted, 0);
+    EXPECT_LT(accepted, PACKETS);
+}
+
+TEST(ImpairedLinkTest, reorderedPacketsOvertakeDelayedOnes) {
+    auto outcome = runLink(3);
+    ASSERT_FALSE(outcome.deliveryOrder.empty());
+
+    // Reordered packets skip the latency, so at least one packet arrives before an earlier one
+    bool isReordered = false;
+    for (std::size_t i = 1; i < outcome.deliveryOrder.size(); ++i) {
+        if (outcome.deliveryOrder[i] < outcome.deliveryOrder[i - 1]) isReordered = true;
+    }
+    EXPECT_TRUE(isReordered);
+}
+
+TEST(ImpairedLinkTest, differentSeedsGiveDifferentImpairments) {
+    EXPECT_NE(runLink(1).isDelivered, runLink(2).isDelivered);
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <LatencyHistogram.hpp>
+#include <thread>
+#include <vector>
+
+using namespace rtt::robothub;
+
+TEST(LatencyHistogramTest, bucketsReportAtMostOneSixteenthTooMuch) {
+    for (uint64_t nanoseconds = 0; nanoseconds < (uint64_t(1) << 33); nanoseconds = nanoseconds * 17 / 16 + 1) {
+        int bucket = LatencyHistogram::toBucket(nanoseconds);
+        ASSERT_GE(bucket, 0);
+        ASSERT_LT(bucket, LATENCY_BUCKETS);
+
+        uint64_t upperBound = LatencyHistogram::getBucketUpperBound(bucket);
+        ASSERT_GE(upperBound, nanoseconds) << "Bucket " << bucket << " is below " << nanoseconds << " ns";
+        ASSERT_LE(static_cast<double>(upperBound), static_cast<double>(nanoseconds) * 1.0625) << "Bucket " << bucket << " is too wide for " << nanoseconds << " ns";
+        ASSERT_EQ(LatencyHistogram::toBucket(upperBound), bucket) << "The upper bound of bucket " << bucket << " is in another bucket";
+    }
+}
+
+TEST(LatencyHistogramTest, longLatenciesEndUpInTheLastBucket) {
+    EXPECT_EQ(LatencyHistogram::toBucket(UINT64_MAX), LATENCY_BUCKETS - 1);
+    EXPECT_EQ(LatencyHistogram::toBucket(uint64_t(1) << 40), LATENCY_BUCKETS - 1);
+}
+
+TEST(LatencyHistogramTest, summarizesPercentilesOfTheInterval) {
+    LatencyHistogram histogram;
+    for (int i = 0; i < 990; ++i) histogram.record(std::chrono::microseconds(10));
+    for (int i = 0; i < 9; ++i) histogram.record(std::chrono::microseconds(500));
+    histogram.record(std::chrono::milliseconds(20));
+
+    LatencySummary summary = histogram.takeSummary();
+    EXPECT_EQ(summary.samples, 1000);
+    EXPECT_NEAR(summary.p50Us, 10, 10 * 0.0625);
+    EXPECT_NEAR(summary.p99Us, 10, 10 * 0.0625);
+    EXPECT_NEAR(summary.p999Us, 500, 500 * 0.0625);
+    EXPECT_NEAR(summary.maxUs, 20000, 20000 * 0.0625);
+}
+
+TEST(LatencyHistogramTest, startsANewIntervalAfterEverySummary) {
+    LatencyHistogram histogram;
+    histogram.record(std::chrono::milliseconds(5));
+    EXPECT_EQ(histogram.takeSummary().samples, 1);
+
+    LatencySummary empty = histogram.takeSummary();
+    EXPECT_EQ(empty.samples, 0);
+    EXPECT_EQ(empty.maxUs, 0);
+
+    // Only the latencies of the new interval count, not the long one before
+    histogram.record(std::chrono::microseconds(1));
+    LatencySummary summary = histogram.takeSummary();
+    EXPECT_EQ(summary.samples, 1);
+    EXPECT_LT(summary.maxUs, 2);
+}
+
+TEST(LatencyHistogramTest, recordsNegativeLatenciesAsZero) {
+    LatencyHistogram histogram;
+    auto now = std::chrono::steady_clock::now();
+    histogram.record(now, now - std::chrono::milliseconds(1));
+
+    LatencySummary summary = histogram.takeSummary();
+    EXPECT_EQ(summary.samples, 1);
+    EXPECT_EQ(summary.maxUs, 0);
+}
+
+TEST(LatencyHistogramTest, countsTheSamplesOfManyThreads) {
+    constexpr int THREADS = 8;
+    constexpr int SAMPLES = 50000;
+
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < THREADS; ++i) {
+        threads.emplace_back([&, i] {
+            for (int j = 0; j < SAMPLES; ++j) histogram.record(std::chrono::microseconds(1 + i));
+        });
+    }
+    // Summaries taken while recording must not lose samples of the next interval
+    uint64_t samples = 0;
+    for (int i = 0; i < 10; ++i) samples += histogram.takeSummary().samples;
+    for (auto& thread : threads) thread.join();
+
+    LatencySummary summary = histogram.takeSummary();
+    samples += summary.samples;
+    EXPECT_EQ(samples, static_cast<uint64_t>(THREADS) * SAMPLES);
+}
+
+TEST(LatencyHistogramTest, reportsTheObservedMaximumInsteadOfItsBucket) {
+    LatencyHistogram histogram;
+    histogram.record(std::chrono::nanoseconds(1000));
+    histogram.record(std::chrono::nanoseconds(1001));
+
+    // 1001 ns falls in a bucket that reaches up to 1023 ns
+    LatencySummary summary = histogram.takeSummary();
+    EXPECT_DOUBLE_EQ(summary.maxUs, 1.001);
+    EXPECT_LE(summary.p50Us, summary.maxUs) << "No percentile may be above the maximum";
+    EXPECT_LE(summary.p999Us, summary.maxUs) << "No percentile may be above the maximum";
+
+    // The maximum starts over with the interval
+    histogram.record(std::chrono::nanoseconds(200));
+    EXPECT_DOUBLE_EQ(histogram.takeSummary().maxUs, 0.2);
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+
+#include <RembinReader.hpp>
+#include <RobotHubLogger.hpp>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using namespace rtt::robothub;
+
+namespace {
+
+constexpr uint64_t FIRST_TIMESTAMP_US = 1700000000000000;
+
+typedef struct ExpectedRecord {
+    uint64_t timestampUs;
+    rtt::Team team;
+    std::vector<uint8_t> packet;
+} ExpectedRecord;
+
+// Every test logs into its own directory, as file names only differ per second
+class RembinTest : public ::testing::Test {
+   protected:
+    std::filesystem::path directory;
+
+    void SetUp() override {
+        std::string pattern = (std::filesystem::temp_directory_path() / "rembin_test_XXXXXX").string();
+        ASSERT_NE(mkdtemp(pattern.data()), nullptr);
+        this->directory = pattern;
+    }
+
+    void TearDown() override { std::filesystem::remove_all(this->directory); }
+
+    // Logs the records and closes the logger, so the file is complete. Returns the path of the file
+    std::string logRecords(const std::vector<ExpectedRecord>& records) {
+        RobotHubLoggerConfiguration configuration;
+        configuration.directory = this->directory.string();
+        configuration.ringCapacity = records.size();
+        {
+            RobotHubLogger logger(configuration);
+            for (const auto& record : records) EXPECT_TRUE(logger.logREM(record.packet.data(), record.packet.size(), record.team, record.timestampUs));
+            EXPECT_EQ(logger.getDroppedPackets(), 0);
+        }
+
+        std::vector<std::string> files;
+        for (const auto& entry : std::filesystem::directory_iterator(this->directory)) files.push_back(entry.path().string());
+        EXPECT_EQ(files.size(), 1);
+        return files.empty() ? "" : files.front();
+    }
+};
+
+std::vector<ExpectedRecord> makeRecords(int amount) {
+    std::vector<ExpectedRecord> records;
+    for (int i = 0; i < amount; ++i) {
+        ExpectedRecord record{.timestampUs = FIRST_TIMESTAMP_US + static_cast<uint64_t>(i) * 1000, .team = i % 3 == 0 ? rtt::Team::BLUE : rtt::Team::YELLOW, .packet = {}};
+        // Sizes from 1 up to the biggest packet that can be logged
+        record.packet.resize(1 + (i * 37) % MAX_LOGGED_PACKET_SIZE);
+        for (std::size_t j = 0; j < record.packet.size(); ++j) record.packet[j] = static_cast<uint8_t>(i * 7 + j);
+        records.push_back(record);
+    }
+    return records;
+}
+
+void expectRecord(const RembinRecord& record, const ExpectedRecord& expected) {
+    EXPECT_EQ(record.timestampUs, expected.timestampUs);
+    EXPECT_EQ(record.team, expected.team);
+    ASSERT_EQ(record.size, expected.packet.size());
+    EXPECT_TRUE(std::equal(record.packet, record.packet + record.size, expected.packet.begin())) << "Packet of " << expected.timestampUs << " differs";
+}
+
+}  // namespace
+
+TEST_F(RembinTest, readsBackEveryLoggedRecordInOrder) {
+    auto expected = makeRecords(5000);
+    RembinReader reader(this->logRecords(expected));
+
+    EXPECT_TRUE(reader.hasIndex());
+    EXPECT_GT(reader.getBlocks().size(), 1) << "The records should not fit in a single block";
+
+    std::size_t index = 0;
+    reader.forEachRecord({}, [&](const RembinRecord& record) {
+        ASSERT_LT(index, expected.size());
+        expectRecord(record, expected[index]);
+        index++;
+    });
+    EXPECT_EQ(index, expected.size());
+}
+
+TEST_F(RembinTest, onlyReadsBlocksThatCanMatchTheQuery) {
+    auto expected = makeRecords(5000);
+    RembinReader reader(this->logRecords(expected));
+
+    RembinQuery query;
+    query.fromTimestampUs = expected[2000].timestampUs;
+    query.toTimestampUs = expected[2100].timestampUs;
+    query.team = rtt::Team::BLUE;
+    EXPECT_LT(reader.findBlocks(query).size(), reader.getBlocks().size());
+
+    std::vector<ExpectedRecord> matching;
+    for (std::size_t i = 2000; i <= 2100; ++i) {
+        if (expected[i].team == rtt::Team::BLUE) matching.push_back(expected[i]);
+    }
+
+    std::size_t index = 0;
+    reader.forEachRecord(query, [&](const RembinRecord& record) {
+        ASSERT_LT(index, matching.size());
+        expectRecord(record, matching[index]);
+        index++;
+    });
+    EXPECT_EQ(index, matching.size());
+}
+
+TEST_F(RembinTest, rebuildsTheIndexOfAFileThatWasNotClosed) {
+    auto expected = makeRecords(5000);
+    std::string path = this->logRecords(expected);
+
+    // Cut off the index and trailer, like after a crash
+    std::vector<uint64_t> blockOffsets;
+    {
+        RembinReader reader(path);
+        for (const auto& block : reader.getBlocks()) blockOffsets.push_back(block.offset);
+    }
+    std::ifstream file(path, std::ios::binary);
+    file.seekg(-static_cast<std::streamoff>(REMBIN_TRAILER_SIZE), std::ios::end);
+    uint8_t trailer[REMBIN_TRAILER_SIZE];
+    file.read(reinterpret_cast<char*>(trailer), REMBIN_TRAILER_SIZE);
+    file.close();
+    std::filesystem::resize_file(path, readLittleEndian(trailer, 8));
+
+    RembinReader reader(path);
+    EXPECT_FALSE(reader.hasIndex());
+    ASSERT_EQ(reader.getBlocks().size(), blockOffsets.size());
+    for (std::size_t i = 0; i < blockOffsets.size(); ++i) EXPECT_EQ(reader.getBlocks()[i].offset, blockOffsets[i]);
+
+    std::size_t index = 0;
+    reader.forEachRecord({}, [&](const RembinRecord& record) {
+        ASSERT_LT(index, expected.size());
+        expectRecord(record, expected[index]);
+        index++;
+    });
+    EXPECT_EQ(index, expected.size());
+}
+
+TEST_F(RembinTest, dropsPacketsThatAreTooBigToLog) {
+    RobotHubLoggerConfiguration configuration;
+    configuration.directory = this->directory.string();
+    RobotHubLogger logger(configuration);
+
+    std::vector<uint8_t> packet(MAX_LOGGED_PACKET_SIZE + 1);
+    EXPECT_FALSE(logger.logREM(packet.data(), packet.size(), rtt::Team::BLUE));
+    EXPECT_EQ(logger.getDroppedPackets(), 1);
+    EXPECT_EQ(logger.getLoggedPackets(), 0);
+}
+
+TEST_F(RembinTest, refusesFilesThatAreNotRembin) {
+    std::string path = (this->directory / "other.rembin").string();
+    std::ofstream(path) << "This is not a log file, but it is long enough to be one";
+
+    EXPECT_THROW(RembinReader reader(path), FailedToReadRembinException);
+    EXPECT_THROW(RembinReader reader((this->directory / "missing.rembin").string()), FailedToReadRembinException);
+}
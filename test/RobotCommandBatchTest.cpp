@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <basestation/RobotCommandBatch.hpp>
+#include <cmath>
+#include <cstring>
+#include <roboteam_utils/RobotCommands.hpp>
+
+using namespace rtt::robothub::basestation;
+
+namespace {
+// Varies every field, and takes velocities in all directions, so theta is taken in every quadrant
+rtt::RobotCommands createCommands(int amount) {
+    rtt::RobotCommands commands;
+    for (int i = 0; i < amount; ++i) {
+        double direction = 2 * M_PI * i / amount;
+        double speed = 0.01 * (i % 37) + 0.0001 * i;
+
+        rtt::RobotCommand command;
+        command.id = i % 16;
+        command.velocity = rtt::Vector2(speed * std::cos(direction), speed * std::sin(direction));
+        command.targetAngle = rtt::Angle(0.01 * i);
+        command.targetAngularVelocity = 0.03 * i - 3;
+        command.useAngularVelocity = i % 2 == 0;
+        command.cameraAngleOfRobot = 0.02 * i - 1;
+        command.cameraAngleOfRobotIsSet = i % 3 != 0;
+        command.kickSpeed = i % 5 == 0 ? 0.0 : 0.1 * (i % 65);
+        command.kickType = i % 4 == 0 ? rtt::KickType::CHIP : rtt::KickType::KICK;
+        command.kickAtAngle = i % 7 == 0;
+        command.waitForBall = i % 11 == 0;
+        command.dribblerSpeed = (i % 10) / 10.0;
+        command.ignorePacket = i % 13 == 0;
+        commands.push_back(command);
+    }
+    return commands;
+}
+
+// The way RobotHub converted commands before the batch, one command at a time
+REM_RobotCommandPayload encodeScalar(const rtt::RobotCommand& robotCommand, rtt::Team color) {
+    REM_RobotCommandPayload payload = {};
+    REM_RobotCommand command = toREM_RobotCommand(robotCommand, color);
+    encodeREM_RobotCommand(&payload, &command);
+    return payload;
+}
+}  // namespace
+
+TEST(RobotCommandBatchTest, encodesTheSameBytesAsTheScalarConversion) {
+    constexpr int AMOUNT = 1000;
+    auto commands = createCommands(AMOUNT);
+
+    for (auto color : {rtt::Team::YELLOW, rtt::Team::BLUE}) {
+        RobotCommandBatch batch;
+        batch.convert(commands, color);
+        ASSERT_EQ(batch.size(), AMOUNT);
+
+        for (int i = 0; i < AMOUNT; ++i) {
+            auto expected = encodeScalar(commands[i], color);
+            EXPECT_EQ(batch.getRobotId(i), commands[i].id);
+            ASSERT_EQ(std::memcmp(&batch.getPayload(i), &expected, sizeof(expected)), 0) << "Packet " << i << " differs from the scalar conversion";
+        }
+    }
+}
+
+TEST(RobotCommandBatchTest, reusesTheBatchForTeamsOfOtherSizes) {
+    auto commands = createCommands(16);
+    RobotCommandBatch batch;
+    batch.convert(commands, rtt::Team::BLUE);
+
+    // A smaller team after a bigger one only uses the first packets of the buffers
+    std::span<const rtt::RobotCommand> fewerCommands(commands.data() + 5, 3);
+    batch.convert(fewerCommands, rtt::Team::YELLOW);
+    ASSERT_EQ(batch.size(), 3);
+    for (int i = 0; i < batch.size(); ++i) {
+        auto expected = encodeScalar(fewerCommands[i], rtt::Team::YELLOW);
+        EXPECT_EQ(std::memcmp(&batch.getPayload(i), &expected, sizeof(expected)), 0) << "Packet " << i << " differs from the scalar conversion";
+    }
+
+    batch.convert({}, rtt::Team::BLUE);
+    EXPECT_EQ(batch.size(), 0);
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <simulation/RoundTripTimer.hpp>
+#include <thread>
+
+using namespace rtt::robothub::simulation;
+
+namespace {
+constexpr std::chrono::milliseconds GAP(20);
+constexpr std::chrono::milliseconds BEYOND_TIMEOUT(300);  // The timer gives up on a response after 250 ms
+constexpr double GAP_US = 20000;
+}  // namespace
+
+TEST(RoundTripTimerTest, matchesResponsesToTheOldestOutstandingPacket) {
+    RoundTripTimer timer;
+    timer.onPacketSent(rtt::Team::BLUE);
+    std::this_thread::sleep_for(GAP);
+    timer.onPacketSent(rtt::Team::BLUE);
+
+    // The first response belongs to the first packet, so it took at least the gap
+    timer.onResponseReceived(rtt::Team::BLUE);
+    timer.onResponseReceived(rtt::Team::BLUE);
+
+    auto statistics = timer.takeStatistics(rtt::Team::BLUE);
+    EXPECT_EQ(statistics.samples, 2);
+    EXPECT_EQ(statistics.lost, 0);
+    EXPECT_GE(statistics.maxUs, GAP_US);
+    EXPECT_LT(statistics.minUs, GAP_US) << "The second response should be matched to the second packet";
+}
+
+TEST(RoundTripTimerTest, matchesTheTeamsSeparately) {
+    RoundTripTimer timer;
+    timer.onPacketSent(rtt::Team::YELLOW);
+    timer.onResponseReceived(rtt::Team::BLUE);  // A response we did not ask for
+
+    EXPECT_EQ(timer.takeStatistics(rtt::Team::BLUE).samples, 0);
+
+    timer.onResponseReceived(rtt::Team::YELLOW);
+    EXPECT_EQ(timer.takeStatistics(rtt::Team::YELLOW).samples, 1);
+}
+
+TEST(RoundTripTimerTest, countsPacketsWithoutResponseWithinTheTimeoutAsLost) {
+    RoundTripTimer timer;
+    timer.onPacketSent(rtt::Team::BLUE);
+    std::this_thread::sleep_for(BEYOND_TIMEOUT);
+
+    // The late response is not matched to the timed out packet, but to the one sent after it
+    timer.onPacketSent(rtt::Team::BLUE);
+    timer.onResponseReceived(rtt::Team::BLUE);
+
+    auto statistics = timer.takeStatistics(rtt::Team::BLUE);
+    EXPECT_EQ(statistics.lost, 1);
+    ASSERT_EQ(statistics.samples, 1);
+    EXPECT_LT(statistics.maxUs, GAP_US);
+}
+
+TEST(RoundTripTimerTest, forgetsPacketsThatFailedToSend) {
+    RoundTripTimer timer;
+    timer.onPacketSent(rtt::Team::BLUE);
+    timer.onPacketSendFailed(rtt::Team::BLUE);
+    timer.onResponseReceived(rtt::Team::BLUE);
+
+    auto statistics = timer.takeStatistics(rtt::Team::BLUE);
+    EXPECT_EQ(statistics.samples, 0);
+    EXPECT_EQ(statistics.lost, 0) << "A packet that was never sent is not lost";
+}
+
+TEST(RoundTripTimerTest, startsANewIntervalAfterEveryTake) {
+    RoundTripTimer timer;
+    timer.onPacketSent(rtt::Team::BLUE);
+    timer.onResponseLost(rtt::Team::BLUE);
+    EXPECT_EQ(timer.takeStatistics(rtt::Team::BLUE).lost, 1);
+
+    auto statistics = timer.takeStatistics(rtt::Team::BLUE);
+    EXPECT_EQ(statistics.lost, 0);
+    EXPECT_EQ(statistics.samples, 0);
+}
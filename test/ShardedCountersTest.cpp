@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include <ShardedCounters.hpp>
+#include <thread>
+#include <vector>
+
+using namespace rtt::robothub;
+
+TEST(ShardedCountersTest, countsEveryIncrementOfManyThreads) {
+    constexpr int THREADS = MAX_COUNTER_SHARDS + 8;  // Some threads have to use the overflow shard
+    constexpr int INCREMENTS = 100000;
+
+    ShardedCounters<2> counters;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < THREADS; ++i) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < INCREMENTS; ++j) {
+                counters.increment(0);
+                counters.add(1, 2);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    auto totals = counters.read();
+    EXPECT_EQ(totals[0], static_cast<uint64_t>(THREADS) * INCREMENTS);
+    EXPECT_EQ(totals[1], static_cast<uint64_t>(THREADS) * INCREMENTS * 2);
+}
+
+TEST(ShardedCountersTest, reusesTheShardsOfThreadsThatExited) {
+    ShardedCounters<1> counters;
+
+    // Many more threads than shards come and go, like the readers of basestations that are replugged
+    for (int i = 0; i < MAX_COUNTER_SHARDS * 4; ++i) {
+        int shardIndex = -1;
+        std::thread([&] {
+            counters.increment(0);
+            shardIndex = getCounterShardIndex();
+        }).join();
+        ASSERT_LT(shardIndex, MAX_COUNTER_SHARDS) << "Thread " << i << " fell into the overflow shard";
+    }
+
+    EXPECT_EQ(counters.read()[0], static_cast<uint64_t>(MAX_COUNTER_SHARDS) * 4);
+}
+
+TEST(ShardedCountersTest, keepsCountingWhileThreadsComeAndGo) {
+    constexpr int WAVES = 20;
+    constexpr int THREADS_PER_WAVE = 8;
+    constexpr int INCREMENTS = 10000;
+
+    ShardedCounters<1> counters;
+    for (int wave = 0; wave < WAVES; ++wave) {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < THREADS_PER_WAVE; ++i) {
+            threads.emplace_back([&] {
+                for (int j = 0; j < INCREMENTS; ++j) counters.increment(0);
+            });
+        }
+        for (auto& thread : threads) thread.join();
+    }
+
+    EXPECT_EQ(counters.read()[0], static_cast<uint64_t>(WAVES) * THREADS_PER_WAVE * INCREMENTS);
+}
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <SharedCommandRing.hpp>
+#include <memory>
+#include <thread>
+
+using namespace rtt::robothub;
+
+namespace {
+
+// Every test uses its own segment, so tests running at the same time do not share one
+std::string makeSegmentName(const std::string& test) { return "/robothub_test_commands_" + test + "_" + std::to_string(getpid()); }
+
+SharedRobotCommands makeBatch(int32_t id, std::chrono::nanoseconds age = std::chrono::nanoseconds(0)) {
+    auto now = std::chrono::steady_clock::now() - age;
+    SharedRobotCommands batch{};
+    batch.timestampNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count());
+    batch.amountOfCommands = 1;
+    batch.commands[0].id = id;
+    return batch;
+}
+
+}  // namespace
+
+TEST(SharedCommandRingTest, readsBatchesInTheOrderTheyAreWritten) {
+    SharedCommandRingReader reader(makeSegmentName("order"), 8);
+    SharedCommandRingWriter writer(makeSegmentName("order"));
+
+    SharedRobotCommands batch{};
+    EXPECT_FALSE(reader.readNext(batch));
+
+    // Write more than the capacity in total, so the ring wraps around
+    for (int round = 0; round < 3; ++round) {
+        for (int32_t id = 0; id < 8; ++id) ASSERT_TRUE(writer.write(makeBatch(round * 8 + id)));
+        for (int32_t id = 0; id < 8; ++id) {
+            ASSERT_TRUE(reader.readNext(batch));
+            EXPECT_EQ(batch.commands[0].id, round * 8 + id);
+        }
+    }
+    EXPECT_FALSE(reader.readNext(batch));
+    EXPECT_EQ(reader.getDroppedBatches(), 0);
+}
+
+TEST(SharedCommandRingTest, dropsBatchesThatDoNotFit) {
+    SharedCommandRingReader reader(makeSegmentName("full"), 4);
+    SharedCommandRingWriter writer(makeSegmentName("full"));
+
+    for (int32_t id = 0; id < 4; ++id) EXPECT_TRUE(writer.write(makeBatch(id)));
+    EXPECT_FALSE(writer.write(makeBatch(4)));
+    EXPECT_EQ(reader.getDroppedBatches(), 1);
+
+    // Reading frees a slot again
+    SharedRobotCommands batch{};
+    ASSERT_TRUE(reader.readNext(batch));
+    EXPECT_EQ(batch.commands[0].id, 0);
+    EXPECT_TRUE(writer.write(makeBatch(5)));
+}
+
+TEST(SharedCommandRingTest, dropsBatchesThatWaitedTooLong) {
+    SharedCommandRingReader reader(makeSegmentName("stale"), 8, std::chrono::milliseconds(100));
+    SharedCommandRingWriter writer(makeSegmentName("stale"));
+
+    ASSERT_TRUE(writer.write(makeBatch(1, std::chrono::seconds(1))));
+    ASSERT_TRUE(writer.write(makeBatch(2, std::chrono::seconds(1))));
+    ASSERT_TRUE(writer.write(makeBatch(3)));
+
+    SharedRobotCommands batch{};
+    ASSERT_TRUE(reader.readNext(batch));
+    EXPECT_EQ(batch.commands[0].id, 3);
+    EXPECT_EQ(reader.getDroppedBatches(), 2);
+    EXPECT_FALSE(reader.readNext(batch));
+}
+
+TEST(SharedCommandRingTest, waitingWakesUpOnAWriteOfAnotherThread) {
+    SharedCommandRingReader reader(makeSegmentName("wake"), 8);
+    SharedCommandRingWriter writer(makeSegmentName("wake"));
+
+    EXPECT_FALSE(reader.waitForCommands(std::chrono::milliseconds(10)));
+
+    std::thread writerThread([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        writer.write(makeBatch(1));
+    });
+    auto start = std::chrono::steady_clock::now();
+    bool hasCommands = reader.waitForCommands(std::chrono::seconds(10));
+    auto waited = std::chrono::steady_clock::now() - start;
+    writerThread.join();
+
+    EXPECT_TRUE(hasCommands);
+    EXPECT_LT(waited, std::chrono::seconds(5)) << "The reader slept until its timeout instead of being woken";
+
+    SharedRobotCommands batch{};
+    ASSERT_TRUE(reader.readNext(batch));
+    EXPECT_EQ(batch.commands[0].id, 1);
+}
+
+TEST(SharedCommandRingTest, deliversEveryBatchOfAConcurrentWriter) {
+    constexpr int32_t BATCHES = 100000;
+
+    SharedCommandRingReader reader(makeSegmentName("concurrent"), 16, std::chrono::seconds(60));
+    SharedCommandRingWriter writer(makeSegmentName("concurrent"));
+
+    std::thread writerThread([&] {
+        for (int32_t id = 0; id < BATCHES; ++id) {
+            // Retry when the ring is full, so nothing is lost
+            while (!writer.write(makeBatch(id))) std::this_thread::yield();
+        }
+    });
+
+    SharedRobotCommands batch{};
+    int32_t expectedId = 0;
+    while (expectedId < BATCHES) {
+        if (!reader.readNext(batch)) {
+            reader.waitForCommands(std::chrono::milliseconds(100));
+            continue;
+        }
+        ASSERT_EQ(batch.commands[0].id, expectedId);
+        expectedId++;
+    }
+    writerThread.join();
+    EXPECT_FALSE(reader.readNext(batch));
+}
+
+TEST(SharedCommandRingTest, writerMovesToTheRingOfARestartedHub) {
+    std::string name = makeSegmentName("restart");
+    auto reader = std::make_unique<SharedCommandRingReader>(name, 8);
+    SharedCommandRingWriter writer(name);
+    ASSERT_TRUE(writer.write(makeBatch(1)));
+
+    // Without a ring to move to, batches are dropped
+    reader = nullptr;
+    EXPECT_FALSE(writer.write(makeBatch(2)));
+
+    reader = std::make_unique<SharedCommandRingReader>(name, 8);
+    EXPECT_TRUE(writer.write(makeBatch(3)));
+
+    SharedRobotCommands batch{};
+    ASSERT_TRUE(reader->readNext(batch));
+    EXPECT_EQ(batch.commands[0].id, 3);
+}
+
+TEST(SharedCommandRingTest, writerMovesOnFromTheFullRingOfACrashedHub) {
+    std::string name = makeSegmentName("crash");
+    // The old reader stays, but never reads again, like a hub that crashed
+    SharedCommandRingReader crashedReader(name, 4);
+    SharedCommandRingWriter writer(name);
+    for (int32_t id = 0; id < 4; ++id) ASSERT_TRUE(writer.write(makeBatch(id)));
+
+    SharedCommandRingReader reader(name, 4);
+    EXPECT_TRUE(writer.write(makeBatch(4)));
+
+    SharedRobotCommands batch{};
+    ASSERT_TRUE(reader.readNext(batch));
+    EXPECT_EQ(batch.commands[0].id, 4);
+}
+
+TEST(SharedCommandRingTest, refusesToWriteWithoutARing) { EXPECT_THROW(SharedCommandRingWriter writer(makeSegmentName("missing")), FailedToOpenSharedMemoryException); }
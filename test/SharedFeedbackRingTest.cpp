@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <SharedFeedbackRing.hpp>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+using namespace rtt::robothub;
+
+namespace {
+
+// Every test uses its own segment, so tests running at the same time do not share one
+std::string makeSegmentName(const std::string& test) { return "/robothub_test_" + test + "_" + std::to_string(getpid()); }
+
+// A record of which every field can be checked against its id, so a torn copy is noticed
+SharedRobotFeedback makeRecord(int32_t id) {
+    SharedRobotFeedback record{};
+    record.timestampNs = static_cast<uint64_t>(id) * 3;
+    record.id = id;
+    record.velocityX = static_cast<float>(id % 1000);
+    record.velocityY = -static_cast<float>(id % 1000);
+    record.wheelLocked = id;
+    record.wheelBraking = -id;
+    record.signalStrength = id ^ 0x5555;
+    return record;
+}
+
+bool isIntact(const SharedRobotFeedback& record) {
+    SharedRobotFeedback expected = makeRecord(record.id);
+    return record.timestampNs == expected.timestampNs && record.velocityX == expected.velocityX && record.velocityY == expected.velocityY &&
+           record.wheelLocked == expected.wheelLocked && record.wheelBraking == expected.wheelBraking && record.signalStrength == expected.signalStrength;
+}
+
+}  // namespace
+
+TEST(SharedFeedbackRingTest, readsRecordsInTheOrderTheyArePublished) {
+    SharedFeedbackWriter writer(makeSegmentName("order"), 16);
+    SharedFeedbackReader reader(makeSegmentName("order"));
+
+    SharedRobotFeedback record{};
+    EXPECT_FALSE(reader.readNext(record));
+
+    for (int32_t id = 0; id < 10; ++id) writer.publish(makeRecord(id));
+    for (int32_t id = 0; id < 10; ++id) {
+        ASSERT_TRUE(reader.readNext(record));
+        EXPECT_EQ(record.id, id);
+        EXPECT_TRUE(isIntact(record));
+    }
+    EXPECT_FALSE(reader.readNext(record));
+    EXPECT_EQ(reader.getMissedRecords(), 0);
+}
+
+TEST(SharedFeedbackRingTest, startsAtFeedbackPublishedAfterOpening) {
+    SharedFeedbackWriter writer(makeSegmentName("start"), 16);
+    writer.publish(makeRecord(1));
+
+    SharedFeedbackReader reader(makeSegmentName("start"));
+    writer.publish(makeRecord(2));
+
+    SharedRobotFeedback record{};
+    ASSERT_TRUE(reader.readNext(record));
+    EXPECT_EQ(record.id, 2);
+    EXPECT_FALSE(reader.readNext(record));
+}
+
+TEST(SharedFeedbackRingTest, countsRecordsThatWereOverwrittenBeforeReading) {
+    constexpr int32_t CAPACITY = 8;
+    constexpr int32_t PUBLISHED = 3 * CAPACITY + 5;
+
+    SharedFeedbackWriter writer(makeSegmentName("lapped"), CAPACITY);
+    SharedFeedbackReader reader(makeSegmentName("lapped"));
+    for (int32_t id = 0; id < PUBLISHED; ++id) writer.publish(makeRecord(id));
+
+    // Only the newest records that fit in the ring are left
+    SharedRobotFeedback record{};
+    for (int32_t id = PUBLISHED - CAPACITY; id < PUBLISHED; ++id) {
+        ASSERT_TRUE(reader.readNext(record));
+        EXPECT_EQ(record.id, id);
+    }
+    EXPECT_FALSE(reader.readNext(record));
+    EXPECT_EQ(reader.getMissedRecords(), PUBLISHED - CAPACITY);
+}
+
+TEST(SharedFeedbackRingTest, noticesThatTheRingWasCreatedAgain) {
+    std::string name = makeSegmentName("replaced");
+    auto writer = std::make_unique<SharedFeedbackWriter>(name, 8);
+    SharedFeedbackReader reader(name);
+    EXPECT_FALSE(reader.isReplaced());
+
+    // A hub that stopped without a new one is not a replacement yet
+    writer = nullptr;
+    EXPECT_FALSE(reader.isReplaced());
+
+    writer = std::make_unique<SharedFeedbackWriter>(name, 8);
+    EXPECT_TRUE(reader.isReplaced());
+    EXPECT_FALSE(SharedFeedbackReader(name).isReplaced());
+}
+
+TEST(SharedFeedbackRingTest, refusesToOpenARingThatDoesNotExist) { EXPECT_THROW(SharedFeedbackReader reader(makeSegmentName("missing")), FailedToOpenSharedMemoryException); }
+
+TEST(SharedFeedbackRingTest, neverReadsATornRecordWhileWritersPublish) {
+    constexpr int WRITERS = 4;
+    constexpr int32_t RECORDS_PER_WRITER = 200000;
+
+    std::string name = makeSegmentName("torn");
+    // A small ring, so the writers lap the reader all the time
+    SharedFeedbackWriter writer(name, 4);
+    SharedFeedbackReader reader(name);
+
+    std::atomic<int> finishedWriters = 0;
+    std::vector<std::thread> writers;
+    for (int i = 0; i < WRITERS; ++i) {
+        writers.emplace_back([&, i] {
+            for (int32_t j = 0; j < RECORDS_PER_WRITER; ++j) writer.publish(makeRecord(i * RECORDS_PER_WRITER + j));
+            finishedWriters++;
+        });
+    }
+
+    uint64_t readRecords = 0;
+    auto readAll = [&] {
+        SharedRobotFeedback record{};
+        while (reader.readNext(record)) {
+            ASSERT_TRUE(isIntact(record)) << "Record " << record.id << " was torn";
+            readRecords++;
+        }
+    };
+    while (finishedWriters < WRITERS) readAll();
+    for (auto& thread : writers) thread.join();
+    readAll();
+
+    EXPECT_GT(readRecords, 0);
+    EXPECT_EQ(readRecords + reader.getMissedRecords(), static_cast<uint64_t>(WRITERS) * RECORDS_PER_WRITER);
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <simulation/SimulationErrorAggregator.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace rtt::robothub::simulation;
+
+namespace {
+constexpr std::chrono::milliseconds REPORT_INTERVAL(50);
+
+SimulationError makeError(const std::string& code, const std::string& message) { return {.code = code, .message = message}; }
+}  // namespace
+
+TEST(SimulationErrorAggregatorTest, reportsARepeatingErrorOncePerInterval) {
+    std::vector<std::string> reports;
+    SimulationErrorAggregator aggregator(REPORT_INTERVAL, [&](const std::string& report) { reports.push_back(report); });
+
+    for (int i = 0; i < 100; ++i) aggregator.addError(makeError("UNSUPPORTED", "wheel velocities"));
+    ASSERT_EQ(reports.size(), 1) << "A new error should be reported immediately, and its repetitions not within the interval";
+    EXPECT_EQ(reports[0], "Received Simulation error UNSUPPORTED: wheel velocities");
+
+    // After the interval, the next occurrence reports how often it occurred since
+    std::this_thread::sleep_for(REPORT_INTERVAL);
+    aggregator.addError(makeError("UNSUPPORTED", "wheel velocities"));
+    ASSERT_EQ(reports.size(), 2);
+    EXPECT_NE(reports[1].find("(100 times"), std::string::npos) << reports[1];
+}
+
+TEST(SimulationErrorAggregatorTest, countsDistinctErrorsSeparately) {
+    std::vector<std::string> reports;
+    SimulationErrorAggregator aggregator(REPORT_INTERVAL, [&](const std::string& report) { reports.push_back(report); });
+
+    aggregator.addError(makeError("A", "first"));
+    aggregator.addError(makeError("A", "second"));
+    aggregator.addError(makeError("B", "first"));
+    aggregator.addError(makeError("A", "first"));
+
+    EXPECT_EQ(aggregator.getDistinctErrors(), 3);
+    EXPECT_EQ(reports.size(), 3);
+}
+
+TEST(SimulationErrorAggregatorTest, evictsErrorsThatStoppedOccurring) {
+    std::vector<std::string> reports;
+    SimulationErrorAggregator aggregator(REPORT_INTERVAL, [&](const std::string& report) { reports.push_back(report); });
+
+    for (int i = 0; i < 4; ++i) aggregator.addError(makeError("QUIET", "soon"));
+    aggregator.evictQuietErrors();
+    EXPECT_EQ(aggregator.getDistinctErrors(), 1) << "An error that just occurred should not be evicted";
+
+    std::this_thread::sleep_for(REPORT_INTERVAL);
+    aggregator.addError(makeError("LOUD", "still"));
+    aggregator.evictQuietErrors();
+    EXPECT_EQ(aggregator.getDistinctErrors(), 1) << "Only the error that is still occurring should be kept";
+
+    // The occurrences that were not reported yet are reported when evicting
+    ASSERT_EQ(reports.size(), 3);
+    EXPECT_EQ(reports[0], "Received Simulation error QUIET: soon");
+    EXPECT_EQ(reports[1], "Received Simulation error LOUD: still");
+    EXPECT_NE(reports[2].find("QUIET: soon (3 times"), std::string::npos) << reports[2];
+}
+
+TEST(SimulationErrorAggregatorTest, reportsPendingOccurrencesWhenDestroyed) {
+    std::vector<std::string> reports;
+    {
+        SimulationErrorAggregator aggregator(REPORT_INTERVAL, [&](const std::string& report) { reports.push_back(report); });
+        aggregator.addError(makeError("A", "x"));
+        aggregator.addError(makeError("A", "x"));
+    }
+
+    ASSERT_EQ(reports.size(), 2);
+    EXPECT_NE(reports[1].find("(1 times"), std::string::npos) << reports[1];
+}
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <StatisticsHistory.hpp>
+#include <chrono>
+
+using namespace rtt::robothub;
+
+namespace {
+void addDrops(StatisticsHistory& history, int drops) {
+    RobotHubStatistics statistics;
+    statistics.yellowTeamPacketsDropped = drops;
+    history.add(statistics);
+}
+}  // namespace
+
+TEST(StatisticsHistoryTest, summarizesNothingBeforeTheFirstSample) {
+    StatisticsHistory history(8);
+
+    auto summary = history.summarize(&StatisticsSample::yellowTeamPacketsDropped, std::chrono::seconds(60));
+    EXPECT_EQ(summary.samples, 0);
+    EXPECT_EQ(summary.max, 0);
+    EXPECT_EQ(summary.mean, 0);
+}
+
+TEST(StatisticsHistoryTest, summarizesNothingInAnEmptyWindow) {
+    StatisticsHistory history(8);
+    addDrops(history, 3);
+    addDrops(history, 5);
+
+    auto summary = history.summarize(&StatisticsSample::yellowTeamPacketsDropped, std::chrono::seconds(0));
+    EXPECT_EQ(summary.samples, 0) << "A window of 0 seconds spans no samples";
+    EXPECT_EQ(summary.min, 0);
+    EXPECT_EQ(summary.max, 0);
+    EXPECT_EQ(summary.mean, 0);
+}
+
+TEST(StatisticsHistoryTest, summarizesTheSamplesInTheWindow) {
+    StatisticsHistory history(8);
+    addDrops(history, 1);
+    addDrops(history, 2);
+    addDrops(history, 6);
+
+    // The samples are added right after each other, so all of them fall in the window
+    auto summary = history.summarize(&StatisticsSample::yellowTeamPacketsDropped, std::chrono::seconds(60));
+    EXPECT_EQ(summary.samples, 3);
+    EXPECT_EQ(summary.min, 1);
+    EXPECT_EQ(summary.max, 6);
+    EXPECT_EQ(summary.mean, 3);
+    EXPECT_EQ(summary.p50, 2);
+}
+
+TEST(StatisticsHistoryTest, overwritesTheOldestSampleWhenFull) {
+    StatisticsHistory history(2);
+    addDrops(history, 100);
+    addDrops(history, 1);
+    addDrops(history, 2);
+
+    auto summary = history.summarize(&StatisticsSample::yellowTeamPacketsDropped, std::chrono::seconds(60));
+    EXPECT_EQ(history.size(), 2);
+    EXPECT_EQ(summary.samples, 2);
+    EXPECT_EQ(summary.max, 2) << "The oldest sample should have been overwritten";
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <simulation/WheelKinematics.hpp>
+
+using namespace rtt::robothub::simulation;
+
+namespace {
+constexpr float TOLERANCE = 1e-5f;
+constexpr float SIN_60 = 0.8660254f;
+
+// Computes the wheel velocities of a single robot with the default properties
+TeamWheelVelocities computeSingleRobot(float xVelocity, float yVelocity, float angularVelocity, float orientation) {
+    TeamVelocities velocities;
+    velocities.amount = 1;
+    velocities.robotId[0] = 3;
+    velocities.xVelocity[0] = xVelocity;
+    velocities.yVelocity[0] = yVelocity;
+    velocities.angularVelocity[0] = angularVelocity;
+    velocities.orientation[0] = orientation;
+
+    WheelKinematics kinematics;
+    TeamWheelVelocities wheelVelocities;
+    kinematics.computeWheelVelocities(rtt::Team::BLUE, velocities, wheelVelocities);
+    return wheelVelocities;
+}
+}  // namespace
+
+// The default wheels are at 300, 210, 150 and 60 degrees counter-clockwise from the dribbler
+
+TEST(WheelKinematicsTest, drivingForwardTurnsTheLeftAndRightWheelsOppositely) {
+    auto wheels = computeSingleRobot(1, 0, 0, 0);
+
+    ASSERT_EQ(wheels.amount, 1);
+    EXPECT_NEAR(wheels.frontRight[0], SIN_60, TOLERANCE);
+    EXPECT_NEAR(wheels.backRight[0], 0.5f, TOLERANCE);
+    EXPECT_NEAR(wheels.backLeft[0], -0.5f, TOLERANCE);
+    EXPECT_NEAR(wheels.frontLeft[0], -SIN_60, TOLERANCE);
+}
+
+TEST(WheelKinematicsTest, drivingSidewaysTurnsTheFrontAndBackWheelsOppositely) {
+    auto wheels = computeSingleRobot(0, 1, 0, 0);
+
+    EXPECT_NEAR(wheels.frontRight[0], 0.5f, TOLERANCE);
+    EXPECT_NEAR(wheels.backRight[0], -SIN_60, TOLERANCE);
+    EXPECT_NEAR(wheels.backLeft[0], -SIN_60, TOLERANCE);
+    EXPECT_NEAR(wheels.frontLeft[0], 0.5f, TOLERANCE);
+}
+
+TEST(WheelKinematicsTest, rotatingTurnsAllWheelsEqually) {
+    RobotProperties properties;
+    auto wheels = computeSingleRobot(0, 0, 2, 0);
+
+    float expected = properties.radius * 2;
+    EXPECT_NEAR(wheels.frontRight[0], expected, TOLERANCE);
+    EXPECT_NEAR(wheels.backRight[0], expected, TOLERANCE);
+    EXPECT_NEAR(wheels.backLeft[0], expected, TOLERANCE);
+    EXPECT_NEAR(wheels.frontLeft[0], expected, TOLERANCE);
+}
+
+TEST(WheelKinematicsTest, rotatesGlobalVelocitiesIntoTheRobotFrame) {
+    // A robot that faces the positive y axis drives forward when it moves along that axis
+    auto wheels = computeSingleRobot(0, 1, 0, static_cast<float>(M_PI / 2));
+
+    EXPECT_NEAR(wheels.frontRight[0], SIN_60, TOLERANCE);
+    EXPECT_NEAR(wheels.backRight[0], 0.5f, TOLERANCE);
+    EXPECT_NEAR(wheels.backLeft[0], -0.5f, TOLERANCE);
+    EXPECT_NEAR(wheels.frontLeft[0], -SIN_60, TOLERANCE);
+}